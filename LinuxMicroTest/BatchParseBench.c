@@ -0,0 +1,193 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	Tag parsing throughput of a full NUR_CMD_GETMETABUF response: per tag callback (pFetchTagsFunction,
+	as in NurApiFetchTags) against struct-of-arrays columns (NurApiParseIdBufferBatch), each followed by
+	the same aggregation: tags per antenna, RSSI sum and tags above an RSSI threshold.
+	Also times the aggregation alone over parsed columns, the cost of each further pass.
+
+	Usage: BatchParseBench [rounds]
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "NurApiConfig.h"
+#include "NurMicroApi.h"
+
+#ifndef CONFIG_TAG_BATCH
+#error "BatchParseBench.c needs the API built with CONFIG_TAG_BATCH (NurApiConfig.h or -DCONFIG_TAG_BATCH)"
+#endif
+
+#define EPC_BYTES	12
+#define RSSI_LIMIT	-60
+
+// Callback path of NurApiFetchTags(), in NurMicroApi.c
+int NURAPICONV ParseIdBuffer(struct NUR_API_HANDLE *hNurApi, pFetchTagsFunction tagFunc, uint8_t *buffer, uint32_t bufferLen, int32_t includeMeta, int32_t includeIrData);
+
+struct AGGREGATE
+{
+	uint32_t perAntenna[256];
+	int32_t rssiSum;
+	uint32_t strong;
+	uint32_t epcXor;
+};
+
+static struct AGGREGATE gAgg;
+static uint8_t gBuffer[NUR_MAX_RCV_SZ];
+
+static double secs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Response data as the module sends it: tag blocks with metadata until the packet is full
+static uint32_t make_response(uint8_t *buf, uint32_t size, int *tags)
+{
+	uint32_t pos = 0, seed = 1;
+	int n = 0, i;
+
+	while (pos + 1 + 12 + EPC_BYTES <= size)
+	{
+		uint8_t *b = &buf[pos];
+		seed = seed * 1103515245 + 12345;
+
+		b[0] = 12 + EPC_BYTES;
+		b[1] = (uint8_t)(int8_t)(-40 - (int)((seed >> 16) % 40));	// rssi
+		b[2] = 50;						// scaled rssi
+		b[3] = (uint8_t)n;				// timestamp
+		b[4] = (uint8_t)(n >> 8);
+		b[5] = 0x44; b[6] = 0x35; b[7] = 0x0D; b[8] = 0x00;	// freq 865700
+		b[9] = 0x00; b[10] = 0x30;		// pc
+		b[11] = (uint8_t)((seed >> 8) % 10);	// channel
+		b[12] = (uint8_t)((seed >> 24) & 3);	// antenna id
+		b[13] = 0x30;
+		for (i = 1; i < EPC_BYTES; i++)
+			b[13 + i] = (uint8_t)(seed >> (i % 4 * 8)) ^ (uint8_t)n;
+		pos += 1 + b[0];
+		n++;
+	}
+	*tags = n;
+	return pos;
+}
+
+static int aggregate_tag(struct NUR_API_HANDLE *hApi, struct NUR_IDBUFFER_ENTRY *tag)
+{
+	(void)hApi;
+	gAgg.perAntenna[tag->antennaId]++;
+	gAgg.rssiSum += tag->rssi;
+	gAgg.strong += tag->rssi > RSSI_LIMIT;
+	gAgg.epcXor ^= tag->epcData[tag->epcLen - 1];
+	return 0;
+}
+
+static void aggregate_batch(const struct NUR_TAG_BATCH *batch)
+{
+	uint32_t n, count = batch->Count;
+	int32_t rssiSum = 0;
+	uint32_t strong = 0, epcXor = 0;
+
+	// Separate loops over columns; the RSSI ones vectorize
+	for (n = 0; n < count; n++)
+		rssiSum += batch->Rssi[n];
+	for (n = 0; n < count; n++)
+		strong += batch->Rssi[n] > RSSI_LIMIT;
+	for (n = 0; n < count; n++)
+		gAgg.perAntenna[batch->AntennaId[n]]++;
+	for (n = 0; n < count; n++)
+		epcXor ^= batch->Buffer[batch->EpcOffset[n] + batch->EpcLen[n] - 1];
+
+	gAgg.rssiSum += rssiSum;
+	gAgg.strong += strong;
+	gAgg.epcXor ^= epcXor;
+}
+
+static void print_result(const char *what, int tags, double t)
+{
+	printf("  %-30s %7.1f M tags/s  (%.1f ns/tag)  rssi sum %d, strong %u, antenna 0 %u\n", what,
+		tags / t / 1e6, t * 1e9 / tags, gAgg.rssiSum, gAgg.strong, gAgg.perAntenna[0]);
+}
+
+int main(int argc, char *argv[])
+{
+	static int8_t rssi[NUR_MAX_RCV_SZ / 16];
+	static uint8_t scaledRssi[NUR_MAX_RCV_SZ / 16], channel[NUR_MAX_RCV_SZ / 16], antennaId[NUR_MAX_RCV_SZ / 16];
+	static uint8_t epcLen[NUR_MAX_RCV_SZ / 16], dataLen[NUR_MAX_RCV_SZ / 16];
+	static uint16_t timestamp[NUR_MAX_RCV_SZ / 16], pc[NUR_MAX_RCV_SZ / 16], epcOffset[NUR_MAX_RCV_SZ / 16];
+	static uint32_t freq[NUR_MAX_RCV_SZ / 16];
+	struct NUR_API_HANDLE api;
+	struct NUR_TAG_BATCH batch;
+	int rounds = (argc > 1) ? atoi(argv[1]) : 20000;
+	int tags, r;
+	uint32_t len;
+	double t;
+
+	memset(&api, 0, sizeof(api));
+	len = make_response(gBuffer, NUR_MAX_RCV_SZ - 4, &tags);
+	printf("%d tags (%d byte EPC) per response, %u bytes, %d rounds\n", tags, EPC_BYTES, len, rounds);
+
+	memset(&gAgg, 0, sizeof(gAgg));
+	t = secs();
+	for (r = 0; r < rounds; r++)
+		ParseIdBuffer(&api, aggregate_tag, gBuffer, len, TRUE, FALSE);
+	print_result("callback", tags * rounds, secs() - t);
+
+	// Only the columns the aggregation needs
+	memset(&batch, 0, sizeof(batch));
+	batch.Capacity = NUR_MAX_RCV_SZ / 16;
+	batch.Rssi = rssi;
+	batch.AntennaId = antennaId;
+	batch.EpcOffset = epcOffset;
+	batch.EpcLen = epcLen;
+
+	memset(&gAgg, 0, sizeof(gAgg));
+	t = secs();
+	for (r = 0; r < rounds; r++) {
+		NurApiParseIdBufferBatch(&batch, gBuffer, len, TRUE, FALSE);
+		aggregate_batch(&batch);
+	}
+	print_result("batch, 4 columns", tags * rounds, secs() - t);
+
+	// Further passes over parsed columns, e.g. second filter or aggregation
+	memset(&gAgg, 0, sizeof(gAgg));
+	t = secs();
+	for (r = 0; r < rounds; r++)
+		aggregate_batch(&batch);
+	print_result("columns only, no parse", tags * rounds, secs() - t);
+
+	// All columns
+	batch.ScaledRssi = scaledRssi;
+	batch.Timestamp = timestamp;
+	batch.Freq = freq;
+	batch.Pc = pc;
+	batch.Channel = channel;
+	batch.DataLen = dataLen;
+
+	memset(&gAgg, 0, sizeof(gAgg));
+	t = secs();
+	for (r = 0; r < rounds; r++) {
+		NurApiParseIdBufferBatch(&batch, gBuffer, len, TRUE, FALSE);
+		aggregate_batch(&batch);
+	}
+	print_result("batch, all columns", tags * rounds, secs() - t);
+
+	return 0;
+}
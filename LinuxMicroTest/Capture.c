@@ -0,0 +1,367 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	Record and replay transports.
+
+	capture_start() wraps the transport functions of an open handle and appends every
+	read and written chunk to a capture file with its timestamp (format in Capture.h).
+	open_replay() is a transport that plays the module side of a capture back, so that
+	command handling and tag parsing can be rerun and timed without hardware.
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Transport.h"
+#include "Capture.h"
+
+#define TR(hApi)	((struct NUR_TRANSPORT *)(hApi)->UserData)
+
+struct CAPTURE
+{
+	FILE *f;
+	uint64_t lastUs;
+	pTransportReadDataFunction read;
+	pTransportWriteDataFunction write;
+	pTransportWriteVecFunction writev;
+};
+
+struct REPLAY
+{
+	uint8_t *buf;
+	uint32_t len;
+	uint32_t pos;					// Next record
+	struct NUR_CAPTURE_RECORD cur;	// Current record
+	uint32_t curOff;				// Bytes used from current record
+	int mismatches;
+};
+
+static uint64_t now_us(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int put_varint(uint8_t *p, uint32_t v)
+{
+	int n = 0;
+	while (v >= 0x80) {
+		p[n++] = (uint8_t)(v | 0x80);
+		v >>= 7;
+	}
+	p[n++] = (uint8_t)v;
+	return n;
+}
+
+static int get_varint(const uint8_t *buf, uint32_t len, uint32_t *pos, uint32_t *v)
+{
+	uint32_t shift = 0;
+	*v = 0;
+	while (*pos < len && shift < 35) {
+		uint8_t b = buf[(*pos)++];
+		*v |= (uint32_t)(b & 0x7F) << shift;
+		if (!(b & 0x80))
+			return TRUE;
+		shift += 7;
+	}
+	return FALSE;
+}
+
+int capture_load(const char *path, uint8_t **buf, uint32_t *len)
+{
+	FILE *f = fopen(path, "rb");
+	long size;
+
+	*buf = NULL;
+	*len = 0;
+	if (!f)
+		return NUR_ERROR_FILE_NOT_FOUND;
+
+	if (fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < CAPTURE_MAGIC_LEN || fseek(f, 0, SEEK_SET) != 0) {
+		fclose(f);
+		return NUR_ERROR_FILE_INVALID;
+	}
+
+	*buf = (uint8_t *)malloc((size_t)size);
+	if (!*buf || fread(*buf, 1, (size_t)size, f) != (size_t)size || memcmp(*buf, CAPTURE_MAGIC, CAPTURE_MAGIC_LEN) != 0) {
+		free(*buf);
+		*buf = NULL;
+		fclose(f);
+		return NUR_ERROR_FILE_INVALID;
+	}
+	fclose(f);
+
+	*len = (uint32_t)size;
+	return NUR_SUCCESS;
+}
+
+int capture_next(const uint8_t *buf, uint32_t len, uint32_t *pos, struct NUR_CAPTURE_RECORD *rec)
+{
+	uint32_t p = *pos;
+
+	if (p >= len)
+		return FALSE;
+	rec->type = buf[p++];
+	if (!get_varint(buf, len, &p, &rec->deltaUs) || !get_varint(buf, len, &p, &rec->len))
+		return FALSE;
+	if (rec->len > len - p)
+		return FALSE;
+	rec->data = &buf[p];
+
+	*pos = p + rec->len;
+	return TRUE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Recording
+
+static void record_header(struct CAPTURE *cap, uint8_t type, uint32_t len)
+{
+	uint8_t hdr[11];
+	uint64_t now = now_us();
+	int n = 0;
+
+	hdr[n++] = type;
+	n += put_varint(&hdr[n], (uint32_t)(now - cap->lastUs));
+	n += put_varint(&hdr[n], len);
+	cap->lastUs = now;
+
+	fwrite(hdr, 1, n, cap->f);
+}
+
+static int capture_read(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesRead)
+{
+	struct CAPTURE *cap = (struct CAPTURE *)TR(hNurApi)->capture;
+	int error = cap->read(hNurApi, buffer, bufferLen, bytesRead);
+
+	if (error == NUR_SUCCESS && *bytesRead > 0) {
+		record_header(cap, CAPTURE_READ, *bytesRead);
+		fwrite(buffer, 1, *bytesRead, cap->f);
+	}
+	return error;
+}
+
+static int capture_write(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesWritten)
+{
+	struct CAPTURE *cap = (struct CAPTURE *)TR(hNurApi)->capture;
+	int error = cap->write(hNurApi, buffer, bufferLen, bytesWritten);
+
+	if (error == NUR_SUCCESS && *bytesWritten > 0) {
+		record_header(cap, CAPTURE_WRITE, *bytesWritten);
+		fwrite(buffer, 1, *bytesWritten, cap->f);
+	}
+	return error;
+}
+
+// Gathered bytes that were actually written are one record
+static int capture_writev(struct NUR_API_HANDLE *hNurApi, const struct NUR_IOVEC *iov, int iovCnt, uint32_t *bytesWritten)
+{
+	struct CAPTURE *cap = (struct CAPTURE *)TR(hNurApi)->capture;
+	int error = cap->writev(hNurApi, iov, iovCnt, bytesWritten);
+
+	if (error == NUR_SUCCESS && *bytesWritten > 0)
+	{
+		uint32_t left = *bytesWritten;
+		int i;
+
+		record_header(cap, CAPTURE_WRITE, left);
+		for (i = 0; i < iovCnt && left > 0; i++) {
+			uint32_t n = (iov[i].len < left) ? iov[i].len : left;
+			fwrite(iov[i].data, 1, n, cap->f);
+			left -= n;
+		}
+	}
+	return error;
+}
+
+int capture_start(struct NUR_API_HANDLE *hApi, const char *path)
+{
+	struct NUR_TRANSPORT *tr = TR(hApi);
+	struct CAPTURE *cap;
+
+	if (!tr || tr->capture)
+		return NUR_ERROR_INVALID_PARAMETER;
+
+	cap = (struct CAPTURE *)calloc(1, sizeof(*cap));
+	if (!cap)
+		return NUR_ERROR_GENERAL;
+
+	cap->f = fopen(path, "wb");
+	if (!cap->f) {
+		free(cap);
+		return NUR_ERROR_FILE_NOT_FOUND;
+	}
+	fwrite(CAPTURE_MAGIC, 1, CAPTURE_MAGIC_LEN, cap->f);
+	cap->lastUs = now_us();
+
+	cap->read = hApi->TransportReadDataFunction;
+	cap->write = hApi->TransportWriteDataFunction;
+	cap->writev = hApi->TransportWriteVecFunction;
+	tr->capture = cap;
+
+	hApi->TransportReadDataFunction = capture_read;
+	hApi->TransportWriteDataFunction = capture_write;
+	if (cap->writev)
+		hApi->TransportWriteVecFunction = capture_writev;
+
+	return NUR_SUCCESS;
+}
+
+void capture_stop(struct NUR_API_HANDLE *hApi)
+{
+	struct NUR_TRANSPORT *tr = TR(hApi);
+	struct CAPTURE *cap;
+
+	if (!tr || !tr->capture)
+		return;
+	cap = (struct CAPTURE *)tr->capture;
+
+	hApi->TransportReadDataFunction = cap->read;
+	hApi->TransportWriteDataFunction = cap->write;
+	hApi->TransportWriteVecFunction = cap->writev;
+
+	fclose(cap->f);
+	free(cap);
+	tr->capture = NULL;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Replay
+
+// Current record with bytes left, NULL at end of capture
+static struct NUR_CAPTURE_RECORD *replay_current(struct REPLAY *rp)
+{
+	while (rp->curOff == rp->cur.len)
+	{
+		if (!capture_next(rp->buf, rp->len, &rp->pos, &rp->cur)) {
+			rp->cur.len = 0;
+			rp->curOff = 0;
+			return NULL;
+		}
+		rp->curOff = 0;
+	}
+	return &rp->cur;
+}
+
+static int replay_read(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesRead)
+{
+	struct REPLAY *rp = (struct REPLAY *)TR(hNurApi)->priv;
+	struct NUR_CAPTURE_RECORD *rec = replay_current(rp);
+	uint32_t n;
+
+	if (!rec)
+		return NUR_ERROR_TR_NOT_CONNECTED;
+	if (rec->type != CAPTURE_READ)
+		return NUR_ERROR_TR_TIMEOUT;	// Module sent nothing more before next write
+
+	n = rec->len - rp->curOff;
+	if (n > bufferLen)
+		n = bufferLen;
+	memcpy(buffer, rec->data + rp->curOff, n);
+	rp->curOff += n;
+
+	*bytesRead = n;
+	return NUR_SUCCESS;
+}
+
+static int replay_write(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesWritten)
+{
+	struct REPLAY *rp = (struct REPLAY *)TR(hNurApi)->priv;
+	uint32_t done = 0;
+
+	// Consume recorded writes; recorded chunking may differ from ours
+	while (done < bufferLen)
+	{
+		struct NUR_CAPTURE_RECORD *rec = replay_current(rp);
+		uint32_t n;
+
+		if (!rec || rec->type != CAPTURE_WRITE) {
+			rp->mismatches++;
+			break;
+		}
+		n = rec->len - rp->curOff;
+		if (n > bufferLen - done)
+			n = bufferLen - done;
+		if (memcmp(rec->data + rp->curOff, buffer + done, n) != 0)
+			rp->mismatches++;
+		rp->curOff += n;
+		done += n;
+	}
+
+	*bytesWritten = bufferLen;
+	return NUR_SUCCESS;
+}
+
+int open_replay(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, const char *path)
+{
+	struct REPLAY *rp = (struct REPLAY *)calloc(1, sizeof(*rp));
+	int error;
+
+	if (!rp)
+		return NUR_ERROR_GENERAL;
+
+	error = capture_load(path, &rp->buf, &rp->len);
+	if (error != NUR_SUCCESS) {
+		free(rp);
+		return error;
+	}
+	rp->pos = CAPTURE_MAGIC_LEN;
+
+	tr->fd = -1;
+	tr->priv = rp;
+	tr->capture = NULL;
+	tr->trace = NULL;
+
+	hApi->UserData = tr;
+	hApi->TransportReadDataFunction = replay_read;
+	hApi->TransportWriteDataFunction = replay_write;
+	hApi->TransportWriteVecFunction = NULL;
+
+	return NUR_SUCCESS;
+}
+
+void close_replay(struct NUR_API_HANDLE *hApi)
+{
+	struct NUR_TRANSPORT *tr = TR(hApi);
+	struct REPLAY *rp;
+
+	if (!tr || !tr->priv)
+		return;
+	rp = (struct REPLAY *)tr->priv;
+
+	free(rp->buf);
+	free(rp);
+	tr->priv = NULL;
+}
+
+void replay_rewind(struct NUR_API_HANDLE *hApi)
+{
+	struct REPLAY *rp = (struct REPLAY *)TR(hApi)->priv;
+
+	rp->pos = CAPTURE_MAGIC_LEN;
+	rp->cur.len = 0;
+	rp->curOff = 0;
+	rp->mismatches = 0;
+}
+
+int replay_mismatches(struct NUR_API_HANDLE *hApi)
+{
+	return ((struct REPLAY *)TR(hApi)->priv)->mismatches;
+}
@@ -0,0 +1,59 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	Capture file format for the record / replay transports (Capture.c).
+
+	File starts with CAPTURE_MAGIC (8 bytes). Records follow back to back:
+		type		1 byte, CAPTURE_READ or CAPTURE_WRITE
+		deltaUs		varint, microseconds since previous record (first: since capture start)
+		len			varint, number of data bytes
+		data		len bytes, as returned by read / accepted by write
+	Varints are LEB128: 7 bits per byte, least significant first, high bit set when more follow.
+*/
+
+#ifndef _NURCAPTURE_H_
+#define _NURCAPTURE_H_	1
+
+#include <stdint.h>
+
+#define CAPTURE_MAGIC		"NURCAP1"
+#define CAPTURE_MAGIC_LEN	8
+
+#define CAPTURE_READ		'R'		/**< Bytes received from module */
+#define CAPTURE_WRITE		'W'		/**< Bytes sent to module */
+
+struct NUR_CAPTURE_RECORD
+{
+	uint8_t type;
+	uint32_t deltaUs;
+	uint32_t len;
+	const uint8_t *data;	/**< Points into capture buffer */
+};
+
+/**
+ * Load whole capture file to memory and check magic.
+ * @param buf	Receives malloc'd buffer, free() when done.
+ * @return	NUR_SUCCESS, NUR_ERROR_FILE_NOT_FOUND or NUR_ERROR_FILE_INVALID.
+ */
+int capture_load(const char *path, uint8_t **buf, uint32_t *len);
+
+/**
+ * Decode record at *pos and advance *pos. Start with *pos = CAPTURE_MAGIC_LEN.
+ * @return	TRUE if record was decoded, FALSE at end or on truncated record.
+ */
+int capture_next(const uint8_t *buf, uint32_t len, uint32_t *pos, struct NUR_CAPTURE_RECORD *rec);
+
+#endif
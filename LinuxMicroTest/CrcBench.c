@@ -0,0 +1,139 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	CRC-16 throughput (bytes/s) of the NurMicroApi.c variant selected at build time,
+	on 2 kB and 8 kB buffers, checked against a bitwise reference.
+	NurCRC16 is static, so NurMicroApi.c is compiled in here. Build once per variant:
+
+		(none)                                                   bitwise
+		-DHAVE_CRC16_LOOKUP                                      table, 1 byte per step
+		-DHAVE_CRC16_LOOKUP -DCRC16_LOOKUP_SLICES=4              slice-by-4
+		-DHAVE_CRC16_LOOKUP -DCRC16_LOOKUP_SLICES=8              slice-by-8
+		-DHAVE_CRC16_LOOKUP -DCRC16_LOOKUP_SLICES=8 -DHAVE_CRC16_PCLMUL
+		                                                         PCLMUL, slice-by-8 below 64 bytes
+
+	Usage: CrcBench
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "NurMicroApi.c"
+
+#ifndef HAVE_CRC16_LOOKUP
+#define CRC16_VARIANT	"bitwise"
+#elif defined(CRC16_PCLMUL_MIN_LEN)
+#define CRC16_VARIANT	"pclmul"
+#elif CRC16_LOOKUP_SLICES == 8
+#define CRC16_VARIANT	"slice-by-8"
+#elif CRC16_LOOKUP_SLICES == 4
+#define CRC16_VARIANT	"slice-by-4"
+#else
+#define CRC16_VARIANT	"table"
+#endif
+
+static uint8_t gData[8192 + 64];
+
+static double secs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint16_t crc16_ref(uint16_t crc, const uint8_t *buf, uint32_t len)
+{
+	int bit;
+	while (len--) {
+		crc ^= (uint16_t)(*buf++) << 8;
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ MSG_CCITT_CRC_POLY) : (uint16_t)(crc << 1);
+	}
+	return crc;
+}
+
+// Every length to 300 bytes at every alignment, 2 kB and 8 kB, and a CRC carried over a split
+static int check(void)
+{
+	uint32_t len, offset, split;
+	int errors = 0;
+
+	for (offset = 0; offset < 16; offset++) {
+		for (len = 0; len <= 300; len++) {
+			if (NurCRC16(CRC16_START, &gData[offset], len) != crc16_ref(CRC16_START, &gData[offset], len))
+				errors++;
+		}
+	}
+	for (len = 2048; len <= 8192; len *= 4) {
+		for (offset = 0; offset < 64; offset += 7) {
+			if (NurCRC16(CRC16_START, &gData[offset], len) != crc16_ref(CRC16_START, &gData[offset], len))
+				errors++;
+			split = 1 + offset * 13;
+			if (NurCRC16(NurCRC16(CRC16_START, gData, split), &gData[split], len - split) != crc16_ref(CRC16_START, gData, len))
+				errors++;
+		}
+	}
+	return errors;
+}
+
+static void bench(uint32_t len)
+{
+	volatile uint16_t sink = 0;
+	double t, elapsed;
+	long n, rounds = 0;
+
+	// Run for about 0.3 s
+	t = secs();
+	do {
+		for (n = 0; n < 1000; n++)
+			sink ^= NurCRC16(CRC16_START, &gData[n & 7], len);
+		rounds += n;
+		elapsed = secs() - t;
+	} while (elapsed < 0.3);
+
+	printf("%-11s  %5u  %8.1f MB/s  %6.2f ns/B\n", CRC16_VARIANT, len,
+		(double)rounds * len / elapsed / 1e6, elapsed * 1e9 / ((double)rounds * len));
+	(void)sink;
+}
+
+int main(void)
+{
+	uint32_t i, x = 12345;
+	int errors;
+
+	for (i = 0; i < sizeof(gData); i++) {
+		x = x * 1103515245 + 12345;
+		gData[i] = (uint8_t)(x >> 16);
+	}
+
+#ifdef CRC16_PCLMUL_MIN_LEN
+	if (!Crc16HavePclmul())
+		printf("No PCLMUL on this CPU, lookup is used\n");
+#endif
+
+	errors = check();
+	if (errors) {
+		printf("%s: %d mismatches against bitwise reference\n", CRC16_VARIANT, errors);
+		return 1;
+	}
+
+	bench(2048);
+	bench(8192);
+	return 0;
+}
@@ -0,0 +1,203 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	Receive path under link corruption. The virtual link (open_virtual_link()) flips bits in,
+	drops and inserts bytes from the virtual module while tag buffer responses (NUR_CMD_GETIDBUF,
+	a few hundred bytes each) are exchanged with NUR_XCH_WINDOW commands in flight.
+	Every accepted response is compared to the same response over a clean link.
+	Checks, for copy and zero-copy receive:
+	  - CRC rejection: no corrupted response is accepted
+	  - resync: one corrupted byte costs at most one response, so responses after it are received;
+	    discarded bytes reach IgnoredByteHandler
+	and reports responses lost per 10^6 corrupted bytes (10^6 when every fault costs exactly one response).
+
+	Usage: FaultTest [ppm] [exchanges]
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "NurApiConfig.h"
+#include "Transport.h"
+#include "VirtualModule.h"
+
+#define FAULT_TAGS		20
+#define XCH_TIMEOUT		50
+
+enum FAULT
+{
+	FAULT_FLIP = 0,
+	FAULT_DROP,
+	FAULT_INSERT,
+	FAULT_MIXED,
+	FAULT_COUNT
+};
+
+static const char *gFaultName[FAULT_COUNT] = { "bit flips", "dropped", "inserted", "mixed" };
+
+static uint8_t gRxBuffer[NUR_MAX_RCV_SZ];
+static uint8_t gTxBuffer[NUR_MAX_SEND_SZ];
+
+// Tag buffer response over a clean link
+static uint8_t gRef[NUR_MAX_RCV_SZ];
+static uint32_t gRefLen;
+
+static int gOk, gLost, gWrong;
+static uint32_t gIgnored;
+
+static void ignored_byte(struct NUR_API_HANDLE *hApi)
+{
+	(void)hApi;
+	gIgnored++;
+}
+
+static void fetch_complete(struct NUR_API_HANDLE *hApi, uint8_t cmd, int error)
+{
+	(void)cmd;
+	if (error != NUR_SUCCESS)
+		gLost++;
+	else if (hApi->respLen != gRefLen || memcmp(hApi->resp->rawdata, gRef, gRefLen) != 0)
+		gWrong++;
+	else
+		gOk++;
+}
+
+static int open_link(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, const struct VLINK_CONFIG *link, int zeroCopy)
+{
+	struct VMODULE_CONFIG cfg;
+	int error, tries;
+
+	memset(hApi, 0, sizeof(*hApi));
+	hApi->RxBuffer = gRxBuffer;
+	hApi->RxBufferLen = sizeof(gRxBuffer);
+	hApi->TxBuffer = gTxBuffer;
+	hApi->TxBufferLen = sizeof(gTxBuffer);
+	hApi->GetTickCountFunction = transport_ticks;
+	hApi->IgnoredByteHandler = ignored_byte;
+	if (zeroCopy)
+		hApi->Flags |= NUR_HANDLE_FLAG_ZEROCOPY_RX;
+
+	vmodule_default_config(&cfg);
+	cfg.numTags = FAULT_TAGS;
+
+	error = open_virtual_link(hApi, tr, &cfg, link);
+	if (error != NUR_SUCCESS)
+		return error;
+
+	// Fill the module tag buffer; the response may be lost on a faulty link
+	for (tries = 0; tries < 20; tries++) {
+		error = NurApiXchPacket(hApi, NUR_CMD_INVENTORY, 0, XCH_TIMEOUT);
+		if (error == NUR_SUCCESS)
+			break;
+	}
+	if (error != NUR_SUCCESS)
+		close_virtual(hApi);
+	return error;
+}
+
+static int get_reference(void)
+{
+	struct NUR_API_HANDLE api;
+	struct NUR_TRANSPORT tr;
+	int error;
+
+	error = open_link(&api, &tr, NULL, 0);
+	if (error == NUR_SUCCESS)
+	{
+		error = NurApiXchPacket(&api, NUR_CMD_GETIDBUF, 0, DEF_TIMEOUT);
+		if (error == NUR_SUCCESS) {
+			gRefLen = api.respLen;
+			memcpy(gRef, api.resp->rawdata, gRefLen);
+		}
+		close_virtual(&api);
+	}
+	return error;
+}
+
+// Returns TRUE when the run passed
+static int run(int fault, int zeroCopy, uint32_t ppm, int exchanges)
+{
+	struct NUR_API_HANDLE api;
+	struct NUR_TRANSPORT tr;
+	struct VLINK_CONFIG link;
+	uint32_t faults;
+	int sent = 0, error, pass;
+
+	memset(&link, 0, sizeof(link));
+	link.seed = (uint32_t)(fault * 2 + zeroCopy) * 7919 + 1;
+	if (fault == FAULT_FLIP || fault == FAULT_MIXED)
+		link.flipPpm = (fault == FAULT_MIXED) ? ppm / 3 : ppm;
+	if (fault == FAULT_DROP || fault == FAULT_MIXED)
+		link.dropPpm = (fault == FAULT_MIXED) ? ppm / 3 : ppm;
+	if (fault == FAULT_INSERT || fault == FAULT_MIXED)
+		link.insertPpm = (fault == FAULT_MIXED) ? ppm / 3 : ppm;
+
+	error = open_link(&api, &tr, &link, zeroCopy);
+	if (error != NUR_SUCCESS) {
+		printf("%-10s %-10s cannot start, error %d\n", gFaultName[fault], zeroCopy ? "zero-copy" : "copy", error);
+		return FALSE;
+	}
+
+	// Count from here on, after the inventory
+	faults = virtual_link_faults(&api);
+	gOk = gLost = gWrong = 0;
+	gIgnored = 0;
+
+	while (sent < exchanges || api.XchPending)
+	{
+		while (sent < exchanges && NurApiXchStart(&api, NUR_CMD_GETIDBUF, 0, XCH_TIMEOUT, fetch_complete) == NUR_SUCCESS)
+			sent++;
+		error = NurApiXchPoll(&api);
+		if (error != NUR_SUCCESS && error != NUR_ERROR_NOT_READY)
+			break;
+	}
+	faults = virtual_link_faults(&api) - faults;
+	close_virtual(&api);
+
+	pass = gWrong == 0 && gOk + gLost == exchanges && (uint32_t)gLost <= faults && (faults == 0 || gIgnored > 0);
+	printf("%-10s %-10s %-6d %-6u %-6d %-6d %-8u %10.0f  %s\n", gFaultName[fault], zeroCopy ? "zero-copy" : "copy",
+		gOk, faults, gLost, gWrong, gIgnored, faults ? gLost * 1e6 / faults : 0.0, pass ? "ok" : "FAILED");
+	return pass;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t ppm = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 300;
+	int exchanges = (argc > 2) ? atoi(argv[2]) : 1000;
+	int fault, zeroCopy, pass = 1;
+
+	if (ppm == 0 || ppm > 1000000 || exchanges < 1) {
+		printf("Usage: FaultTest [ppm] [exchanges]\n");
+		return 2;
+	}
+
+	if (get_reference() != NUR_SUCCESS || gRefLen == 0) {
+		printf("Cannot read tag buffer over a clean link\n");
+		return 1;
+	}
+
+	// Header, cmd, status and CRC around the data
+	printf("%u ppm, %d responses of %u bytes per run\n", ppm, exchanges, gRefLen + 10);
+	printf("fault      receive    ok     faults lost   wrong  ignored  lost/1e6 faulty bytes\n");
+	for (fault = 0; fault < FAULT_COUNT; fault++)
+		for (zeroCopy = 0; zeroCopy < 2; zeroCopy++)
+			pass &= run(fault, zeroCopy, ppm, exchanges);
+
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	return pass ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	Tag fetch throughput: fills the module tag buffer with one inventory, then fetches it
+	repeatedly with NurApiFetchTags (all at once), NurApiFetchTagAt (one per request) and
+	NurApiFetchTagsChunked (ranges sized to RxBuffer), and prints tags/s for each.
+
+	Usage: FetchBench [-z] [-r rxbuffer] [-n range] <device | tcp:host[:port] | virtual> [baudrate] [tags] [rounds]
+	  -z		Use zero-copy receive (NUR_HANDLE_FLAG_ZEROCOPY_RX)
+	  -r		Use only this many bytes of RxBuffer, e.g. 512 as on a small MCU
+	  -n		Virtual module answer to range requests: accept (default), reject, index (count ignored)
+			or ignore (payload ignored), as modules without range fetch may do
+	  virtual	Virtual module (VirtualModule.c) with [tags] tags and 1 ms service time, paced at baudrate
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "NurApiConfig.h"
+#include "Transport.h"
+#include "VirtualModule.h"
+
+static uint8_t gRxBuffer[NUR_MAX_RCV_SZ];
+static uint8_t gTxBuffer[NUR_MAX_SEND_SZ];
+
+static int gTags;
+static int gMaxEpcLen;
+static int gRangeFetch = VMODULE_RANGE_ACCEPT;
+
+static int count_tag(struct NUR_API_HANDLE *hApi, struct NUR_IDBUFFER_ENTRY *tag)
+{
+	(void)hApi;
+	gTags++;
+	if (tag->epcLen > gMaxEpcLen)
+		gMaxEpcLen = tag->epcLen;
+	return 0;
+}
+
+static uint32_t usecs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000);
+}
+
+static int open_device(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, const char *device, uint32_t baudrate, int tags)
+{
+	if (strcmp(device, "virtual") == 0)
+	{
+		struct VMODULE_CONFIG cfg;
+
+		vmodule_default_config(&cfg);
+		cfg.numTags = tags;
+		cfg.serviceTimeUs = 1000;
+		cfg.baudrate = baudrate;
+		cfg.rangeFetch = gRangeFetch;
+		return open_virtual(hApi, tr, &cfg);
+	}
+	if (strncmp(device, "tcp:", 4) == 0)
+	{
+		// tcp:host[:port]
+		char host[256];
+		char *colon;
+		int port = 4333;
+
+		snprintf(host, sizeof(host), "%s", device + 4);
+		colon = strrchr(host, ':');
+		if (colon) {
+			*colon = '\0';
+			port = atoi(colon + 1);
+		}
+		return open_tcp(hApi, tr, host, port, DEF_TIMEOUT);
+	}
+	return open_serial(hApi, tr, device, baudrate);
+}
+
+static void close_device(struct NUR_API_HANDLE *hApi, const char *device)
+{
+	if (strcmp(device, "virtual") == 0)
+		close_virtual(hApi);
+	else if (strncmp(device, "tcp:", 4) == 0)
+		close_tcp(hApi);
+	else
+		close_serial(hApi);
+}
+
+enum { FETCH_ALL, FETCH_AT, FETCH_CHUNKED };
+
+static int fetch_once(struct NUR_API_HANDLE *hApi, int mode, int tagCount)
+{
+	int i, n, error = NUR_SUCCESS;
+
+	switch (mode)
+	{
+	case FETCH_ALL:
+		return NurApiFetchTags(hApi, TRUE, FALSE, &n, count_tag);
+
+	case FETCH_AT:
+		for (i = 0; i < tagCount && error == NUR_SUCCESS; i++)
+			error = NurApiFetchTagAt(hApi, TRUE, i, count_tag);
+		return error;
+
+	default:
+		return NurApiFetchTagsChunked(hApi, TRUE, tagCount, gMaxEpcLen, 0, &n, count_tag);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	static const char *modeNames[] = { "FetchTags", "FetchTagAt", "FetchTagsChunked" };
+	static const char *rangeNames[] = { "accept", "reject", "index", "ignore" };
+	struct NUR_API_HANDLE api;
+	struct NUR_TRANSPORT tr;
+	const char *device;
+	uint32_t baudrate = 115200;
+	uint32_t rxLen = sizeof(gRxBuffer);
+	int tags = 500;
+	int rounds = 5;
+	int argi = 1;
+	int zeroCopy = 0;
+	int mode, r, tagCount, error;
+
+	while (argi < argc && argv[argi][0] == '-')
+	{
+		if (strcmp(argv[argi], "-z") == 0) {
+			zeroCopy = 1;
+			argi++;
+		}
+		else if (strcmp(argv[argi], "-r") == 0 && argi + 1 < argc) {
+			rxLen = (uint32_t)strtoul(argv[argi + 1], NULL, 10);
+			if (rxLen > sizeof(gRxBuffer))
+				rxLen = sizeof(gRxBuffer);
+			argi += 2;
+		}
+		else if (strcmp(argv[argi], "-n") == 0 && argi + 1 < argc) {
+			for (gRangeFetch = VMODULE_RANGE_IGNORE; gRangeFetch > VMODULE_RANGE_ACCEPT; gRangeFetch--)
+				if (strcmp(argv[argi + 1], rangeNames[gRangeFetch]) == 0)
+					break;
+			argi += 2;
+		}
+		else break;
+	}
+	if (argi >= argc) {
+		printf("Usage: %s [-z] [-r rxbuffer] [-n range] <device | tcp:host[:port] | virtual> [baudrate] [tags] [rounds]\n", argv[0]);
+		return 1;
+	}
+	device = argv[argi++];
+	if (argi < argc)
+		baudrate = (uint32_t)strtoul(argv[argi++], NULL, 10);
+	if (argi < argc)
+		tags = atoi(argv[argi++]);
+	if (argi < argc)
+		rounds = atoi(argv[argi++]);
+
+	memset(&api, 0, sizeof(api));
+	api.RxBuffer = gRxBuffer;
+	api.RxBufferLen = rxLen;
+	api.TxBuffer = gTxBuffer;
+	api.TxBufferLen = sizeof(gTxBuffer);
+	api.GetTickCountFunction = transport_ticks;
+	if (zeroCopy)
+		api.Flags |= NUR_HANDLE_FLAG_ZEROCOPY_RX;
+
+	error = open_device(&api, &tr, device, baudrate, tags);
+	if (error != NUR_SUCCESS) {
+		printf("Cannot open %s, error %d\n", device, error);
+		return 1;
+	}
+
+	error = NurApiClearTags(&api);
+	if (error == NUR_SUCCESS)
+		error = NurApiInventory(&api, NULL);
+	if (error != NUR_SUCCESS) {
+		printf("Inventory failed, error %d\n", error);
+		close_device(&api, device);
+		return 1;
+	}
+	tagCount = api.resp->inventory.numTagsMem;
+
+	// Longest EPC for chunk sizing, fetched one by one so that it works with any RxBuffer
+	fetch_once(&api, FETCH_AT, tagCount);
+	printf("%d tags in module, longest EPC %d bytes, RxBuffer %u bytes, baudrate %u\n", tagCount, gMaxEpcLen, rxLen, baudrate);
+
+	for (mode = FETCH_ALL; mode <= FETCH_CHUNKED; mode++)
+	{
+		uint32_t t0 = usecs(), us;
+
+		gTags = 0;
+		error = NUR_SUCCESS;
+		for (r = 0; r < rounds && error == NUR_SUCCESS; r++)
+			error = fetch_once(&api, mode, tagCount);
+		us = usecs() - t0;
+
+		if (error != NUR_SUCCESS)
+			printf("%-18s failed, error %d\n", modeNames[mode], error);
+		else
+			printf("%-18s %8.0f tags/s  (%d tags in %.1f ms)\n", modeNames[mode], us ? gTags * 1e6 / us : 0.0, gTags, us / 1000.0);
+	}
+
+	close_device(&api, device);
+	return 0;
+}
@@ -0,0 +1,163 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Runs inventory cycles the way a simple application does (ClearTags, Inventory,
+	FetchTagAt for every tag) with exchange tracing, and writes a Chrome trace event
+	file (open in chrome://tracing or ui.perfetto.dev) showing where wall time goes.
+
+	Usage: InventoryTrace [-z] <device | tcp:host[:port] | virtual> [baudrate] [cycles] [trace.json]
+	  -z		Use zero-copy receive (NUR_HANDLE_FLAG_ZEROCOPY_RX)
+	  virtual	Virtual module (VirtualModule.c) with 50 tags, paced at baudrate
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "NurApiConfig.h"
+#include "Transport.h"
+#include "VirtualModule.h"
+
+#define MAX_EVENTS	(1024 * 1024)
+
+static uint8_t gRxBuffer[NUR_MAX_RCV_SZ];
+static uint8_t gTxBuffer[NUR_MAX_SEND_SZ];
+
+static int gTags;
+
+static int count_tag(struct NUR_API_HANDLE *hApi, struct NUR_IDBUFFER_ENTRY *tag)
+{
+	(void)hApi;
+	(void)tag;
+	gTags++;
+	return 0;
+}
+
+static int open_device(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, const char *device, uint32_t baudrate)
+{
+	if (strcmp(device, "virtual") == 0)
+	{
+		struct VMODULE_CONFIG cfg;
+
+		vmodule_default_config(&cfg);
+		cfg.numTags = 50;
+		cfg.baudrate = baudrate;
+		return open_virtual(hApi, tr, &cfg);
+	}
+	if (strncmp(device, "tcp:", 4) == 0)
+	{
+		// tcp:host[:port]
+		char host[256];
+		char *colon;
+		int port = 4333;
+
+		snprintf(host, sizeof(host), "%s", device + 4);
+		colon = strrchr(host, ':');
+		if (colon) {
+			*colon = '\0';
+			port = atoi(colon + 1);
+		}
+		return open_tcp(hApi, tr, host, port, DEF_TIMEOUT);
+	}
+	return open_serial(hApi, tr, device, baudrate);
+}
+
+static void close_device(struct NUR_API_HANDLE *hApi, const char *device)
+{
+	if (strcmp(device, "virtual") == 0)
+		close_virtual(hApi);
+	else if (strncmp(device, "tcp:", 4) == 0)
+		close_tcp(hApi);
+	else
+		close_serial(hApi);
+}
+
+int main(int argc, char *argv[])
+{
+	struct NUR_API_HANDLE api;
+	struct NUR_TRANSPORT tr;
+	const char *device;
+	const char *outPath = "trace.json";
+	uint32_t baudrate = 115200;
+	int cycles = 10;
+	int argi = 1;
+	int zeroCopy = 0;
+	int c, i, found, error;
+
+	if (argi < argc && strcmp(argv[argi], "-z") == 0) {
+		zeroCopy = 1;
+		argi++;
+	}
+	if (argi >= argc) {
+		printf("Usage: %s [-z] <device | tcp:host[:port] | virtual> [baudrate] [cycles] [trace.json]\n", argv[0]);
+		return 1;
+	}
+	device = argv[argi++];
+	if (argi < argc)
+		baudrate = (uint32_t)strtoul(argv[argi++], NULL, 10);
+	if (argi < argc)
+		cycles = atoi(argv[argi++]);
+	if (argi < argc)
+		outPath = argv[argi++];
+
+	memset(&api, 0, sizeof(api));
+	api.RxBuffer = gRxBuffer;
+	api.RxBufferLen = sizeof(gRxBuffer);
+	api.TxBuffer = gTxBuffer;
+	api.TxBufferLen = sizeof(gTxBuffer);
+	api.GetTickCountFunction = transport_ticks;
+	if (zeroCopy)
+		api.Flags |= NUR_HANDLE_FLAG_ZEROCOPY_RX;
+
+	error = open_device(&api, &tr, device, baudrate);
+	if (error != NUR_SUCCESS) {
+		printf("Cannot open %s, error %d\n", device, error);
+		return 1;
+	}
+
+	error = trace_start(&api, MAX_EVENTS);
+	if (error != NUR_SUCCESS) {
+		printf("Cannot start trace, error %d\n", error);
+		close_device(&api, device);
+		return 1;
+	}
+
+	for (c = 0; c < cycles; c++)
+	{
+		error = NurApiClearTags(&api);
+		if (error == NUR_SUCCESS)
+			error = NurApiInventory(&api, NULL);
+		if (error != NUR_SUCCESS && error != NUR_ERROR_NO_TAG) {
+			printf("Cycle %d failed, error %d\n", c, error);
+			break;
+		}
+
+		found = (error == NUR_SUCCESS) ? api.resp->inventory.numTagsMem : 0;
+		for (i = 0; i < found; i++)
+			NurApiFetchTagAt(&api, 1, i, count_tag);
+	}
+
+	error = trace_write_chrome(&api, outPath);
+	trace_stop(&api);
+	close_device(&api, device);
+
+	if (error != NUR_SUCCESS) {
+		printf("Cannot write %s, error %d\n", outPath, error);
+		return 1;
+	}
+	printf("%d cycles, %d tags fetched, trace in %s\n", c, gTags, outPath);
+	return 0;
+}
@@ -0,0 +1,199 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Measures per-command round-trip time (NurApiPing) over a transport,
+	and command throughput with NUR_XCH_WINDOW pipelined pings.
+
+	Usage: LatencyTest [-z] [-a maxbaudrate] <device | tcp:host[:port]> [baudrate] [count]
+	  -z	Use zero-copy receive (NUR_HANDLE_FLAG_ZEROCOPY_RX)
+	  -a	Negotiate the fastest reliable baudrate up to maxbaudrate first (NurApiNegotiateBaudrate)
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "NurApiConfig.h"
+#include "Transport.h"
+
+static uint8_t gRxBuffer[NUR_MAX_RCV_SZ];
+static uint8_t gTxBuffer[NUR_MAX_SEND_SZ];
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+	return (x > y) - (x < y);
+}
+
+static int gDone;
+
+static void ping_complete(struct NUR_API_HANDLE *hApi, uint8_t cmd, int error)
+{
+	(void)hApi;
+	(void)cmd;
+	if (error == NUR_SUCCESS)
+		gDone++;
+}
+
+static void close_transport(struct NUR_API_HANDLE *hApi, int isTcp)
+{
+	if (isTcp)
+		close_tcp(hApi);
+	else
+		close_serial(hApi);
+}
+
+static uint32_t usecs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000);
+}
+
+int main(int argc, char *argv[])
+{
+	struct NUR_API_HANDLE api;
+	struct NUR_TRANSPORT tr;
+	const char *device;
+	uint32_t baudrate = 115200;
+	uint32_t *rtt;
+	uint64_t sum = 0;
+	int count = 1000;
+	int zeroCopy = 0;
+	uint32_t maxBaudrate = 0;
+	uint8_t setting;
+	int isTcp = 0;
+	int sent;
+	uint32_t t0;
+	int argi = 1;
+	int i, n = 0, error;
+
+	for (; argi < argc && argv[argi][0] == '-'; argi++)
+	{
+		if (strcmp(argv[argi], "-z") == 0)
+			zeroCopy = 1;
+		else if (strcmp(argv[argi], "-a") == 0 && argi + 1 < argc)
+			maxBaudrate = (uint32_t)strtoul(argv[++argi], NULL, 10);
+		else
+			break;
+	}
+	if (argi >= argc || argv[argi][0] == '-') {
+		printf("Usage: %s [-z] [-a maxbaudrate] <device> [baudrate] [count]\n", argv[0]);
+		return 1;
+	}
+	device = argv[argi++];
+	if (argi < argc)
+		baudrate = (uint32_t)strtoul(argv[argi++], NULL, 10);
+	if (argi < argc)
+		count = atoi(argv[argi++]);
+	if (count < 1)
+		count = 1;
+
+	memset(&api, 0, sizeof(api));
+	api.RxBuffer = gRxBuffer;
+	api.RxBufferLen = sizeof(gRxBuffer);
+	api.TxBuffer = gTxBuffer;
+	api.TxBufferLen = sizeof(gTxBuffer);
+	api.GetTickCountFunction = transport_ticks;
+	if (zeroCopy)
+		api.Flags |= NUR_HANDLE_FLAG_ZEROCOPY_RX;
+
+	if (strncmp(device, "tcp:", 4) == 0)
+	{
+		// tcp:host[:port]
+		char host[256];
+		char *colon;
+		int port = 4333;
+
+		snprintf(host, sizeof(host), "%s", device + 4);
+		colon = strrchr(host, ':');
+		if (colon) {
+			*colon = '\0';
+			port = atoi(colon + 1);
+		}
+		isTcp = 1;
+		error = open_tcp(&api, &tr, host, port, DEF_TIMEOUT);
+	}
+	else
+	{
+		error = open_serial(&api, &tr, device, baudrate);
+	}
+	if (error != NUR_SUCCESS) {
+		printf("Cannot open %s, error %d\n", device, error);
+		return 1;
+	}
+
+	if (maxBaudrate && !isTcp)
+	{
+		error = NurApiNegotiateBaudrate(&api, maxBaudrate, 20, set_serial_baudrate, &setting);
+		if (error != NUR_SUCCESS) {
+			printf("Baudrate negotiation failed, error %d\n", error);
+			close_transport(&api, isTcp);
+			return 1;
+		}
+		printf("Baudrate %u\n", NurApiBaudrateToBps(setting));
+	}
+
+	rtt = (uint32_t *)malloc(count * sizeof(uint32_t));
+	if (!rtt) {
+		close_transport(&api, isTcp);
+		return 1;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		uint32_t t0 = usecs();
+		error = NurApiPing(&api);
+		if (error != NUR_SUCCESS) {
+			printf("Ping %d failed, error %d\n", i, error);
+			continue;
+		}
+		rtt[n] = usecs() - t0;
+		sum += rtt[n];
+		n++;
+	}
+
+	// Throughput: keep the window full
+	gDone = 0;
+	sent = 0;
+	t0 = usecs();
+	while (sent < count || api.XchPending)
+	{
+		while (sent < count && NurApiXchStart(&api, NUR_CMD_PING, 0, DEF_TIMEOUT, ping_complete) == NUR_SUCCESS)
+			sent++;
+		error = NurApiXchPoll(&api);
+		if (error != NUR_SUCCESS && error != NUR_ERROR_NOT_READY)
+			break;
+	}
+	t0 = usecs() - t0;
+
+	close_transport(&api, isTcp);
+
+	printf("%d/%d pipelined pings (window %d) in %u us: %u commands/s\n",
+		gDone, count, NUR_XCH_WINDOW, t0, t0 ? (uint32_t)((uint64_t)gDone * 1000000 / t0) : 0);
+
+	if (n > 0)
+	{
+		qsort(rtt, n, sizeof(uint32_t), cmp_u32);
+		printf("%s: %d/%d pings, round-trip us: min %u avg %u p50 %u p99 %u max %u\n",
+			device, n, count,
+			rtt[0], (uint32_t)(sum / n), rtt[n / 2], rtt[(n * 99) / 100], rtt[n - 1]);
+	}
+
+	free(rtt);
+	return (n == count) ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	End-to-end test over a real Linux pseudo terminal: the virtual module serves the pty master
+	in a thread and the API opens the slave with the termios serial transport (open_serial()),
+	so the tty layer, termios settings and poll timeouts are all in the path.
+	With 'tcp' the module listens on a loopback TCP port instead and the API connects with open_tcp().
+	Checks that every ping and tag fetch succeeds, then reports round-trip time
+	and pipelined command throughput.
+
+	Usage: LoopbackTest [tcp] [count]
+*/
+
+#define _DEFAULT_SOURCE	1
+#define _XOPEN_SOURCE	600
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <termios.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "NurApiConfig.h"
+#include "Transport.h"
+#include "VirtualModule.h"
+
+#define LOOPBACK_TAGS	200
+
+static uint8_t gRxBuffer[NUR_MAX_RCV_SZ];
+static uint8_t gTxBuffer[NUR_MAX_SEND_SZ];
+
+static struct VMODULE *gModule;
+static int gModuleFd = -1;
+static int gListenFd = -1;
+static int gDone;
+static int gFetched;
+
+static void *module_thread(void *arg)
+{
+	(void)arg;
+	if (gListenFd >= 0)
+	{
+		// One connection
+		int one = 1;
+		gModuleFd = accept(gListenFd, NULL, NULL);
+		if (gModuleFd < 0)
+			return NULL;
+		setsockopt(gModuleFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	}
+	vmodule_serve(gModule, gModuleFd);
+	return NULL;
+}
+
+static void ping_complete(struct NUR_API_HANDLE *hApi, uint8_t cmd, int error)
+{
+	(void)hApi;
+	(void)cmd;
+	if (error == NUR_SUCCESS)
+		gDone++;
+}
+
+static int count_tag(struct NUR_API_HANDLE *hApi, struct NUR_IDBUFFER_ENTRY *tag)
+{
+	(void)hApi;
+	if (tag->epcLen == 12)
+		gFetched++;
+	return NUR_SUCCESS;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+	return (x > y) - (x < y);
+}
+
+static uint32_t usecs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000);
+}
+
+// Raw pty master for the module; returns slave path
+static const char *open_module_pty(void)
+{
+	struct termios tio;
+
+	gModuleFd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (gModuleFd < 0 || grantpt(gModuleFd) != 0 || unlockpt(gModuleFd) != 0)
+		return NULL;
+	if (tcgetattr(gModuleFd, &tio) == 0) {
+		cfmakeraw(&tio);
+		tcsetattr(gModuleFd, TCSANOW, &tio);
+	}
+	return ptsname(gModuleFd);
+}
+
+// Listen on an ephemeral loopback port; returns the port, 0 on error
+static int open_module_tcp(void)
+{
+	struct sockaddr_in addr;
+	socklen_t addrLen = sizeof(addr);
+
+	gListenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (gListenFd < 0)
+		return 0;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(gListenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(gListenFd, 1) != 0 ||
+		getsockname(gListenFd, (struct sockaddr *)&addr, &addrLen) != 0)
+		return 0;
+	return ntohs(addr.sin_port);
+}
+
+int main(int argc, char *argv[])
+{
+	struct VMODULE_CONFIG cfg;
+	struct NUR_API_HANDLE api;
+	struct NUR_TRANSPORT tr;
+	pthread_t thread;
+	const char *path = NULL;
+	char tcpPath[32];
+	int isTcp = 0, port = 0;
+	uint32_t *rtt;
+	uint64_t sum = 0;
+	uint32_t t0;
+	int count = 2000;
+	int i, n = 0, sent, tagsFound = 0, error;
+	int failed = 0;
+	int argi = 1;
+
+	if (argi < argc && strcmp(argv[argi], "tcp") == 0) {
+		isTcp = 1;
+		argi++;
+	}
+	if (argi < argc)
+		count = atoi(argv[argi]);
+	if (count < 1)
+		count = 1;
+
+	vmodule_default_config(&cfg);
+	cfg.numTags = LOOPBACK_TAGS;
+	gModule = vmodule_create(&cfg);
+	if (gModule && isTcp) {
+		port = open_module_tcp();
+		snprintf(tcpPath, sizeof(tcpPath), "tcp:127.0.0.1:%d", port);
+		path = port ? tcpPath : NULL;
+	} else if (gModule) {
+		path = open_module_pty();
+	}
+	if (!path || pthread_create(&thread, NULL, module_thread, NULL) != 0) {
+		printf("Cannot start module on %s\n", isTcp ? "TCP port" : "pty");
+		return 1;
+	}
+
+	memset(&api, 0, sizeof(api));
+	api.RxBuffer = gRxBuffer;
+	api.RxBufferLen = sizeof(gRxBuffer);
+	api.TxBuffer = gTxBuffer;
+	api.TxBufferLen = sizeof(gTxBuffer);
+	api.GetTickCountFunction = transport_ticks;
+
+	if (isTcp)
+		error = open_tcp(&api, &tr, "127.0.0.1", port, DEF_TIMEOUT);
+	else
+		error = open_serial(&api, &tr, path, 115200);
+	if (error != NUR_SUCCESS) {
+		printf("Cannot open %s, error %d\n", path, error);
+		return 1;
+	}
+
+	rtt = (uint32_t *)malloc(count * sizeof(uint32_t));
+	if (!rtt)
+		return 1;
+
+	for (i = 0; i < count; i++)
+	{
+		t0 = usecs();
+		error = NurApiPing(&api);
+		if (error != NUR_SUCCESS) {
+			printf("Ping %d failed, error %d\n", i, error);
+			failed++;
+			continue;
+		}
+		rtt[n] = usecs() - t0;
+		sum += rtt[n];
+		n++;
+	}
+
+	// Pipelined pings
+	gDone = 0;
+	sent = 0;
+	t0 = usecs();
+	while (sent < count || api.XchPending)
+	{
+		while (sent < count && NurApiXchStart(&api, NUR_CMD_PING, 0, DEF_TIMEOUT, ping_complete) == NUR_SUCCESS)
+			sent++;
+		error = NurApiXchPoll(&api);
+		if (error != NUR_SUCCESS && error != NUR_ERROR_NOT_READY)
+			break;
+	}
+	t0 = usecs() - t0;
+	failed += count - gDone;
+
+	// Larger responses through the tty: inventory all tags and fetch them
+	error = NurApiClearTags(&api);
+	if (error == NUR_SUCCESS)
+		error = NurApiInventory(&api, NULL);
+	if (error == NUR_SUCCESS)
+		tagsFound = api.resp->inventory.numTagsFound;
+	if (error == NUR_SUCCESS)
+		error = NurApiFetchTags(&api, TRUE, TRUE, NULL, count_tag);
+	if (error != NUR_SUCCESS || tagsFound != LOOPBACK_TAGS || gFetched != LOOPBACK_TAGS) {
+		printf("Inventory and fetch failed, error %d, %d tags found, %d fetched\n", error, tagsFound, gFetched);
+		failed++;
+	}
+
+	if (isTcp)
+		close_tcp(&api);
+	else
+		close_serial(&api);
+	vmodule_stop(gModule);
+	pthread_join(thread, NULL);
+	if (gModuleFd >= 0)
+		close(gModuleFd);
+	if (gListenFd >= 0)
+		close(gListenFd);
+	vmodule_destroy(gModule);
+
+	if (n > 0)
+	{
+		qsort(rtt, n, sizeof(uint32_t), cmp_u32);
+		printf("%s: %d/%d pings, round-trip us: min %u avg %u p50 %u p99 %u max %u\n",
+			path, n, count, rtt[0], (uint32_t)(sum / n), rtt[n / 2], rtt[(n * 99) / 100], rtt[n - 1]);
+	}
+	printf("%d/%d pipelined pings (window %d): %u commands/s\n",
+		gDone, count, NUR_XCH_WINDOW, t0 ? (uint32_t)((uint64_t)gDone * 1000000 / t0) : 0);
+	printf("%d tags inventoried and fetched\n", gFetched);
+	printf("%s\n", failed ? "FAIL" : "PASS");
+
+	free(rtt);
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,225 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	Runs N handles in parallel, one thread each, against their own virtual modules (open_virtual_link()).
+	Each handle has its own tag count and EPC length and its own link: clean, fragmented reads, bit flips,
+	dropped or inserted bytes, slow module; copy and zero-copy receive. A handle that ever sees another
+	handle's tag count or EPCs, or a clean handle with any failed command, fails the test.
+
+	Usage: MultiHandleTest [handles] [iterations]
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "NurApiConfig.h"
+#include "Transport.h"
+#include "VirtualModule.h"
+
+#define XCH_TIMEOUT		300
+
+enum PATTERN
+{
+	PATTERN_CLEAN = 0,
+	PATTERN_FRAGMENTED,		// 1..3 bytes per read, zero-copy
+	PATTERN_FLIP,
+	PATTERN_DROP,
+	PATTERN_INSERT,			// Zero-copy
+	PATTERN_SLOW,			// 2 ms service time, 1 byte per read
+	PATTERN_COUNT
+};
+
+static const char *gPatternName[PATTERN_COUNT] = { "clean", "fragmented", "bit flips", "dropped", "inserted", "slow" };
+
+struct WORKER
+{
+	struct NUR_API_HANDLE api;	// First: tag callback gets the worker from the handle
+	struct NUR_TRANSPORT tr;
+	uint8_t rxBuffer[NUR_MAX_RCV_SZ];
+	uint8_t txBuffer[NUR_MAX_SEND_SZ];
+	pthread_t thread;
+
+	int index;
+	int pattern;
+	int numTags;
+	int epcBytes;
+	int iterations;
+
+	int ok;
+	int failed;
+	int wrong;				// Results of another handle
+	int fetched;
+};
+
+static int clean_pattern(int pattern)
+{
+	return pattern == PATTERN_CLEAN || pattern == PATTERN_FRAGMENTED || pattern == PATTERN_SLOW;
+}
+
+static int check_tag(struct NUR_API_HANDLE *hApi, struct NUR_IDBUFFER_ENTRY *tag)
+{
+	struct WORKER *w = (struct WORKER *)hApi;
+	int serial;
+
+	serial = (tag->epcData[tag->epcLen - 2] << 8) | tag->epcData[tag->epcLen - 1];
+	if (tag->epcLen != w->epcBytes || tag->epcData[0] != 0x30 || serial >= w->numTags)
+		w->wrong++;
+	w->fetched++;
+	return 0;
+}
+
+static void count(struct WORKER *w, int error)
+{
+	if (error == NUR_SUCCESS)
+		w->ok++;
+	else
+		w->failed++;
+}
+
+static void *worker_thread(void *arg)
+{
+	struct WORKER *w = (struct WORKER *)arg;
+	int i, error, tagsReceived;
+
+	for (i = 0; i < w->iterations; i++)
+	{
+		error = NurApiXchPacket(&w->api, NUR_CMD_PING, 0, XCH_TIMEOUT);
+		if (error == NUR_SUCCESS && (w->api.respLen < 2 || memcmp(w->api.resp->rawdata, "OK", 2) != 0))
+			w->wrong++;
+		count(w, error);
+
+		error = NurApiXchPacket(&w->api, NUR_CMD_INVENTORY, 0, XCH_TIMEOUT);
+		if (error == NUR_SUCCESS && w->api.resp->inventory.numTagsFound != w->numTags)
+			w->wrong++;
+		count(w, error);
+
+		// Tag buffer fetch times out after DEF_TIMEOUT on a lost response, so only on clean links
+		if (clean_pattern(w->pattern))
+		{
+			w->fetched = 0;
+			error = NurApiFetchTags(&w->api, TRUE, TRUE, &tagsReceived, check_tag);
+			if (error == NUR_SUCCESS && (tagsReceived != w->numTags || w->fetched != w->numTags))
+				w->wrong++;
+			count(w, error);
+		}
+	}
+	return NULL;
+}
+
+static int start_worker(struct WORKER *w, int index, int iterations)
+{
+	struct VMODULE_CONFIG cfg;
+	struct VLINK_CONFIG link;
+	int error;
+
+	memset(w, 0, sizeof(*w));
+	w->index = index;
+	w->pattern = index % PATTERN_COUNT;
+	w->numTags = 10 + index;
+	w->epcBytes = 8 + 2 * (index % 5);
+	w->iterations = iterations;
+
+	w->api.RxBuffer = w->rxBuffer;
+	w->api.RxBufferLen = sizeof(w->rxBuffer);
+	w->api.TxBuffer = w->txBuffer;
+	w->api.TxBufferLen = sizeof(w->txBuffer);
+	w->api.GetTickCountFunction = transport_ticks;
+	if (w->pattern == PATTERN_FRAGMENTED || w->pattern == PATTERN_INSERT)
+		w->api.Flags |= NUR_HANDLE_FLAG_ZEROCOPY_RX;
+
+	vmodule_default_config(&cfg);
+	cfg.numTags = w->numTags;
+	cfg.epcBytes = w->epcBytes;
+	cfg.seed = (uint32_t)index + 1;
+
+	memset(&link, 0, sizeof(link));
+	link.seed = (uint32_t)index * 7919 + 1;
+	switch (w->pattern)
+	{
+	case PATTERN_FRAGMENTED:
+		link.maxReadChunk = 1 + index % 3;
+		break;
+	case PATTERN_FLIP:
+		link.flipPpm = 1000;
+		break;
+	case PATTERN_DROP:
+		link.dropPpm = 1000;
+		break;
+	case PATTERN_INSERT:
+		link.insertPpm = 1000;
+		break;
+	case PATTERN_SLOW:
+		cfg.serviceTimeUs = 2000;
+		link.maxReadChunk = 1;
+		break;
+	}
+
+	error = open_virtual_link(&w->api, &w->tr, &cfg, &link);
+	if (error != NUR_SUCCESS)
+		return error;
+	if (pthread_create(&w->thread, NULL, worker_thread, w) != 0) {
+		close_virtual(&w->api);
+		return NUR_ERROR_GENERAL;
+	}
+	return NUR_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+	int handles = (argc > 1) ? atoi(argv[1]) : 12;
+	int iterations = (argc > 2) ? atoi(argv[2]) : 300;
+	struct WORKER *workers;
+	int i, pass = 1;
+
+	if (handles < 1 || iterations < 1) {
+		printf("Usage: MultiHandleTest [handles] [iterations]\n");
+		return 2;
+	}
+
+	workers = (struct WORKER *)calloc(handles, sizeof(*workers));
+	if (!workers)
+		return 1;
+
+	for (i = 0; i < handles; i++) {
+		if (start_worker(&workers[i], i, iterations) != NUR_SUCCESS) {
+			printf("Cannot start handle %d\n", i);
+			return 1;
+		}
+	}
+
+	printf("handle  pattern      tags  EPC  ok     failed  faults  wrong\n");
+	for (i = 0; i < handles; i++)
+	{
+		struct WORKER *w = &workers[i];
+		int handlePass;
+
+		pthread_join(w->thread, NULL);
+
+		// Faulty links lose some commands, but most must still succeed
+		handlePass = w->wrong == 0 && (clean_pattern(w->pattern) ? w->failed == 0 : w->failed * 4 < w->ok);
+		printf("%-7d %-12s %-5d %-4d %-6d %-7d %-7u %-6d %s\n", i, gPatternName[w->pattern], w->numTags, w->epcBytes,
+			w->ok, w->failed, virtual_link_faults(&w->api), w->wrong, handlePass ? "ok" : "FAILED");
+		pass &= handlePass;
+		close_virtual(&w->api);
+	}
+
+	free(workers);
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	return pass ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	Command throughput of serialized exchanges (NurApiPing) against pipelined ones
+	(NurApiXchStart with 1 to NUR_XCH_WINDOW commands in flight) over the virtual module,
+	with link latency from open_virtual_link(). Window 1 is the serialized case through the async path.
+
+	Usage: PipelineBench [-s serviceUs] [count] [latencyUs ...]
+	  -s	Module processing time per command, default 100 us
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "NurApiConfig.h"
+#include "Transport.h"
+#include "VirtualModule.h"
+
+static uint8_t gRxBuffer[NUR_MAX_RCV_SZ];
+static uint8_t gTxBuffer[NUR_MAX_SEND_SZ];
+
+static int gDone;
+static int gFailed;
+
+static void ping_complete(struct NUR_API_HANDLE *hApi, uint8_t cmd, int error)
+{
+	(void)hApi;
+	(void)cmd;
+	if (error == NUR_SUCCESS)
+		gDone++;
+	else
+		gFailed++;
+}
+
+static double secs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Pings with at most window commands in flight, commands/s
+static double run_window(struct NUR_API_HANDLE *hApi, int window, int count)
+{
+	double t;
+	int sent = 0, error;
+
+	gDone = 0;
+	gFailed = 0;
+	t = secs();
+	while (sent < count || hApi->XchPending)
+	{
+		while (sent < count && hApi->XchPending < window &&
+			NurApiXchStart(hApi, NUR_CMD_PING, 0, DEF_TIMEOUT, ping_complete) == NUR_SUCCESS)
+			sent++;
+		error = NurApiXchPoll(hApi);
+		if (error != NUR_SUCCESS && error != NUR_ERROR_NOT_READY)
+			break;
+	}
+	t = secs() - t;
+	return gDone / t;
+}
+
+static double run_serial(struct NUR_API_HANDLE *hApi, int count)
+{
+	double t;
+	int i;
+
+	gDone = 0;
+	gFailed = 0;
+	t = secs();
+	for (i = 0; i < count; i++)
+	{
+		if (NurApiPing(hApi) == NUR_SUCCESS)
+			gDone++;
+		else
+			gFailed++;
+	}
+	t = secs() - t;
+	return gDone / t;
+}
+
+int main(int argc, char *argv[])
+{
+	static const uint32_t defLatency[] = { 0, 500, 2000 };
+	const uint32_t *latency = defLatency;
+	uint32_t argLatency[16];
+	int latencyCount = sizeof(defLatency) / sizeof(defLatency[0]);
+	struct VMODULE_CONFIG cfg;
+	struct VLINK_CONFIG link;
+	struct NUR_API_HANDLE api;
+	struct NUR_TRANSPORT tr;
+	uint32_t serviceUs = 100;
+	int count = 1000;
+	int argi = 1;
+	int i, window, error, failed = 0;
+
+	if (argi + 1 < argc && strcmp(argv[argi], "-s") == 0) {
+		serviceUs = (uint32_t)strtoul(argv[argi + 1], NULL, 10);
+		argi += 2;
+	}
+	if (argi < argc)
+		count = atoi(argv[argi++]);
+	if (count < 1)
+		count = 1;
+	if (argi < argc) {
+		for (latencyCount = 0; argi < argc && latencyCount < 16; argi++)
+			argLatency[latencyCount++] = (uint32_t)strtoul(argv[argi], NULL, 10);
+		latency = argLatency;
+	}
+
+	printf("%u us module service time, %d pings per run\n", serviceUs, count);
+	printf("latency us   NurApiPing");
+	for (window = 1; window <= NUR_XCH_WINDOW; window *= 2)
+		printf((window == 1) ? "   window %d" : "   window %d      ", window);
+	printf("   (commands/s)\n");
+
+	for (i = 0; i < latencyCount; i++)
+	{
+		double base;
+
+		vmodule_default_config(&cfg);
+		cfg.serviceTimeUs = serviceUs;
+		memset(&link, 0, sizeof(link));
+		link.latencyUs = latency[i];
+
+		memset(&api, 0, sizeof(api));
+		api.RxBuffer = gRxBuffer;
+		api.RxBufferLen = sizeof(gRxBuffer);
+		api.TxBuffer = gTxBuffer;
+		api.TxBufferLen = sizeof(gTxBuffer);
+		api.GetTickCountFunction = transport_ticks;
+
+		error = open_virtual_link(&api, &tr, &cfg, &link);
+		if (error != NUR_SUCCESS) {
+			printf("Cannot start virtual module, error %d\n", error);
+			return 1;
+		}
+
+		printf("%10u %12.0f", latency[i], run_serial(&api, count));
+		failed += gFailed;
+		base = 0;
+		for (window = 1; window <= NUR_XCH_WINDOW; window *= 2)
+		{
+			double rate = run_window(&api, window, count);
+			failed += gFailed;
+			if (window == 1)
+				base = rate;
+			printf(" %10.0f", rate);
+			if (window > 1 && base > 0)
+				printf(" %4.1fx", rate / base);
+		}
+		printf("\n");
+
+		close_virtual(&api);
+	}
+
+	if (failed)
+		printf("%d pings failed\n", failed);
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,308 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	Tag presence tracker (NurApiPresenceUpdate / NurApiPresenceAdvance) cost per read and per inventory cycle,
+	against scanning all tags for departures every cycle.
+
+	Synthetic: tags come and go over time; each present tag is read in 70% of the 100 ms cycles, with module
+	timestamps (NUR_PRESENCE_MODULE_TIME) and gaps always shorter than the 1 s timeout. Checks that every tag
+	arrives and departs exactly once and that departures are reported at most one wheel tick plus one cycle late.
+	Virtual: runs NurApiInventory + NurApiFetchTags cycles against the virtual module and prints the events.
+
+	Usage: PresenceBench [tags]
+	       PresenceBench virtual [tags] [readpercent] [cycles]
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "NurApiConfig.h"
+#include "Transport.h"
+#include "VirtualModule.h"
+
+#ifndef CONFIG_PRESENCE
+#error "PresenceBench.c needs the API built with CONFIG_PRESENCE (NurApiConfig.h or -DCONFIG_PRESENCE)"
+#endif
+
+#define CYCLE_MS		100
+#define TIMEOUT_MS		1000
+#define MAX_GAP			5		// Most cycles in a row a present tag is missed
+#define EPC_LEN			12
+
+static uint32_t gRng = 0x12345678;
+
+static uint32_t rnd(void)
+{
+	// xorshift32
+	gRng ^= gRng << 13;
+	gRng ^= gRng >> 17;
+	gRng ^= gRng << 5;
+	return gRng;
+}
+
+static double secs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Synthetic
+
+struct SIM_TAG
+{
+	uint8_t epc[EPC_LEN];
+	int enter, leave;		// Present in cycles enter .. leave - 1
+	int missed;				// Cycles missed in a row
+	uint32_t lastRead;		// Read time
+	int arrivals, departures;
+	uint32_t departTime;
+};
+
+static struct SIM_TAG *gSim;
+static uint32_t gNow;
+static int gErrors;
+static uint32_t gMaxLate;
+
+static struct SIM_TAG *sim_tag(struct NUR_PRESENCE_TAG *tag)
+{
+	uint32_t n;
+	memcpy(&n, &tag->Epc.Bytes[EPC_LEN - 4], 4);
+	return &gSim[n];
+}
+
+static void sim_event(struct NUR_PRESENCE *p, struct NUR_PRESENCE_TAG *tag, int event)
+{
+	struct SIM_TAG *s = sim_tag(tag);
+
+	if (event == NUR_PRESENCE_ARRIVE) {
+		s->arrivals++;
+	} else {
+		uint32_t late = gNow - (s->lastRead + p->Timeout);
+		s->departures++;
+		s->departTime = gNow;
+		if ((int32_t)late < 0 || s->departures > 1) {
+			gErrors++;
+		} else if (late > gMaxLate) {
+			gMaxLate = late;
+		}
+	}
+}
+
+static int bench(int tagCount)
+{
+	int cycles = 600, c, i;
+	uint32_t start = 0xFFFF0000;	// Wraps during the run
+	struct NUR_PRESENCE p;
+	struct NUR_PRESENCE_TAG *tags;
+	uint32_t *buckets;
+	struct NUR_IDBUFFER_ENTRY tag;
+	int *readTag, readCount;
+	uint16_t *readTime;
+	double tUpdate = 0, tAdvance = 0, tScan = 0, t;
+	long reads = 0;
+	int maxPresent = 0, present;
+	long scanned = 0;
+
+	gSim = (struct SIM_TAG *)calloc(tagCount, sizeof(*gSim));
+	readTag = (int *)malloc(tagCount * sizeof(*readTag));
+	readTime = (uint16_t *)malloc(tagCount * sizeof(*readTime));
+	for (i = 0; i < tagCount; i++)
+	{
+		struct SIM_TAG *s = &gSim[i];
+		uint32_t n = (uint32_t)i;
+		int b;
+
+		s->epc[0] = 0x30;
+		for (b = 1; b < EPC_LEN - 4; b++)
+			s->epc[b] = (uint8_t)rnd();
+		memcpy(&s->epc[EPC_LEN - 4], &n, 4);
+		s->enter = (int)(rnd() % (cycles - 100));
+		s->leave = s->enter + 1 + (int)(rnd() % 100);
+	}
+
+	// At most about a fifth of the tags present at once
+	tags = (struct NUR_PRESENCE_TAG *)malloc(tagCount * sizeof(*tags));
+	buckets = (uint32_t *)malloc(tagCount * sizeof(*buckets));
+	NurApiPresenceInit(&p, tags, tagCount, buckets, tagCount, TIMEOUT_MS, start);
+	p.EventFunction = sim_event;
+	p.Flags = NUR_PRESENCE_MODULE_TIME;
+
+	memset(&tag, 0, sizeof(tag));
+	tag.epcLen = EPC_LEN;
+	gErrors = 0;
+	gMaxLate = 0;
+
+	for (c = 0; c < cycles + TIMEOUT_MS / CYCLE_MS + 2; c++)
+	{
+		uint32_t cycleStart = start + (uint32_t)c * CYCLE_MS;
+
+		// Reads of this cycle, in tag buffer order with timestamps in the cycle
+		for (i = 0, present = 0, readCount = 0; i < tagCount; i++)
+		{
+			struct SIM_TAG *s = &gSim[i];
+			if (c < s->enter || c >= s->leave)
+				continue;
+			present++;
+			if (c != s->enter && s->missed < MAX_GAP && rnd() % 100 >= 70) {
+				s->missed++;
+				continue;
+			}
+			s->missed = 0;
+			readTag[readCount] = i;
+			readTime[readCount] = (uint16_t)(rnd() % CYCLE_MS);
+			s->lastRead = cycleStart + readTime[readCount];
+			readCount++;
+		}
+		if (present > maxPresent)
+			maxPresent = present;
+
+		gNow = cycleStart + CYCLE_MS;	// Arrivals are not checked for time
+		t = secs();
+		for (i = 0; i < readCount; i++) {
+			tag.epcData = gSim[readTag[i]].epc;
+			tag.timestamp = readTime[i];
+			NurApiPresenceUpdate(&p, &tag, cycleStart);
+		}
+		tUpdate += secs() - t;
+		reads += readCount;
+
+		gNow = cycleStart + CYCLE_MS;
+		t = secs();
+		NurApiPresenceAdvance(&p, gNow);
+		tAdvance += secs() - t;
+
+		// Departure check without the wheel: look at every tag
+		t = secs();
+		for (i = 0; i < tagCount; i++) {
+			if (tags[i].EpcLen && (int32_t)(gNow - (tags[i].LastSeen + TIMEOUT_MS)) >= 0)
+				scanned++;
+		}
+		tScan += secs() - t;
+	}
+
+	for (i = 0; i < tagCount; i++)
+		if (gSim[i].arrivals != 1 || gSim[i].departures != 1)
+			gErrors++;
+	if (p.Count != 0 || p.Arrivals != (uint32_t)tagCount || p.Departures != (uint32_t)tagCount)
+		gErrors++;
+
+	printf("%d tags, most %d present, %ld reads, tick %u ms\n", tagCount, maxPresent, reads, p.Tick);
+	printf("  update          %6.1f ns per read\n", tUpdate * 1e9 / reads);
+	printf("  advance         %6.1f us per cycle\n", tAdvance * 1e6 / c);
+	printf("  full scan       %6.1f us per cycle (%ld due)\n", tScan * 1e6 / c, scanned);
+	printf("  departures at most %u ms late, %s\n", gMaxLate, gErrors ? "FAILED" : "ok");
+
+	free(tags);
+	free(buckets);
+	free(readTag);
+	free(readTime);
+	free(gSim);
+	return gErrors == 0 && gMaxLate <= p.Tick + CYCLE_MS;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Virtual module
+
+static uint8_t gRxBuffer[NUR_MAX_RCV_SZ];
+static uint8_t gTxBuffer[NUR_MAX_SEND_SZ];
+
+static struct NUR_PRESENCE gPresence;
+static uint32_t gCycleStart;
+
+static int presence_tag(struct NUR_API_HANDLE *hApi, struct NUR_IDBUFFER_ENTRY *tag)
+{
+	(void)hApi;
+	NurApiPresenceUpdate(&gPresence, tag, gCycleStart);
+	return 0;
+}
+
+static void print_event(struct NUR_PRESENCE *p, struct NUR_PRESENCE_TAG *tag, int event)
+{
+	int i;
+
+	(void)p;
+	printf("%8u %s ", gCycleStart, (event == NUR_PRESENCE_ARRIVE) ? "arrive" : "depart");
+	for (i = 0; i < tag->EpcLen; i++)
+		printf("%02X", tag->Epc.Bytes[i]);
+	printf(" reads %u\n", tag->ReadCount);
+}
+
+static int run_virtual(int tagCount, int readPercent, int cycles)
+{
+	static struct NUR_PRESENCE_TAG tags[1024];
+	static uint32_t buckets[1024];
+	struct NUR_API_HANDLE api;
+	struct NUR_TRANSPORT tr;
+	struct VMODULE_CONFIG cfg;
+	int c, error, tagsReceived;
+
+	memset(&api, 0, sizeof(api));
+	api.RxBuffer = gRxBuffer;
+	api.RxBufferLen = sizeof(gRxBuffer);
+	api.TxBuffer = gTxBuffer;
+	api.TxBufferLen = sizeof(gTxBuffer);
+	api.GetTickCountFunction = transport_ticks;
+
+	vmodule_default_config(&cfg);
+	cfg.numTags = tagCount;
+	cfg.readPercent = readPercent;
+	cfg.serviceTimeUs = 20000;
+	error = open_virtual(&api, &tr, &cfg);
+	if (error != NUR_SUCCESS) {
+		printf("Cannot open virtual module, error %d\n", error);
+		return 0;
+	}
+
+	// Timestamps count from the virtual module's start, so host time is used here
+	NurApiPresenceInit(&gPresence, tags, sizeof(tags) / sizeof(tags[0]), buckets, sizeof(buckets) / sizeof(buckets[0]), 200, transport_ticks(&api));
+	gPresence.EventFunction = print_event;
+
+	for (c = 0; c < cycles; c++)
+	{
+		gCycleStart = transport_ticks(&api);
+		error = NurApiClearTags(&api);
+		if (error == NUR_SUCCESS)
+			error = NurApiInventory(&api, NULL);
+		if (error == NUR_SUCCESS && api.resp->inventory.numTagsMem > 0)
+			error = NurApiFetchTags(&api, TRUE, TRUE, &tagsReceived, presence_tag);
+		if (error != NUR_SUCCESS && error != NUR_ERROR_NO_TAG) {
+			printf("Inventory failed, error %d\n", error);
+			break;
+		}
+		NurApiPresenceAdvance(&gPresence, transport_ticks(&api));
+	}
+
+	printf("%u present, %u arrivals, %u departures\n", gPresence.Count, gPresence.Arrivals, gPresence.Departures);
+	close_virtual(&api);
+	return error == NUR_SUCCESS || error == NUR_ERROR_NO_TAG;
+}
+
+int main(int argc, char **argv)
+{
+	int ok = 1, count;
+
+	if (argc > 1 && strcmp(argv[1], "virtual") == 0)
+		return run_virtual((argc > 2) ? atoi(argv[2]) : 20, (argc > 3) ? atoi(argv[3]) : 50, (argc > 4) ? atoi(argv[4]) : 50) ? 0 : 1;
+
+	for (count = 10000; count <= ((argc > 1) ? atoi(argv[1]) : 1000000); count *= 10)
+		ok &= bench(count);
+	return ok ? 0 : 1;
+}
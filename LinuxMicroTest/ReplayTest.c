@@ -0,0 +1,298 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	Reruns the commands of a capture (capture_start()) against the replay transport
+	and reports command, tag and byte throughput of the host side: packet parsing,
+	response handling and ParseIdBuffer() for tag buffer fetches.
+	Exits non-zero on transport errors or when the API writes differ from the capture.
+
+	Usage: ReplayTest [-d | -r <device | virtual>] <capture> [loops]
+	  -d	Dump capture records with timestamps instead
+	  -r	Record a fixed set of commands (identification, inventory, tag buffer fetches) from the
+		module to the capture first, then replay it: a round trip that needs no capture at hand.
+		virtual: virtual module (VirtualModule.c), otherwise a serial device at 115200 baud
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "NurApiConfig.h"
+#include "Transport.h"
+#include "Capture.h"
+#include "VirtualModule.h"
+
+struct REPLAY_CMD
+{
+	uint8_t cmd;
+	const uint8_t *data;
+	uint16_t dataLen;
+};
+
+static uint8_t gRxBuffer[NUR_MAX_RCV_SZ];
+static uint8_t gTxBuffer[NUR_MAX_SEND_SZ];
+static uint8_t gWritten[16 * 1024 * 1024];
+
+static int gTags;
+
+static int count_tag(struct NUR_API_HANDLE *hApi, struct NUR_IDBUFFER_ENTRY *tag)
+{
+	(void)hApi;
+	(void)tag;
+	gTags++;
+	return 0;
+}
+
+static uint64_t usecs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void dump(const uint8_t *buf, uint32_t len)
+{
+	struct NUR_CAPTURE_RECORD rec;
+	uint32_t pos = CAPTURE_MAGIC_LEN;
+	uint64_t t = 0;
+	uint32_t i;
+
+	while (capture_next(buf, len, &pos, &rec))
+	{
+		t += rec.deltaUs;
+		printf("%10llu.%06llu %c %4u:", (unsigned long long)(t / 1000000), (unsigned long long)(t % 1000000), rec.type, rec.len);
+		for (i = 0; i < rec.len && i < 32; i++)
+			printf(" %02x", rec.data[i]);
+		printf("%s\n", (rec.len > 32) ? " ..." : "");
+	}
+}
+
+// Concatenate written bytes and split them to commands
+static int extract_commands(const uint8_t *buf, uint32_t len, struct REPLAY_CMD **cmds)
+{
+	struct NUR_CAPTURE_RECORD rec;
+	uint32_t pos = CAPTURE_MAGIC_LEN;
+	uint32_t wrLen = 0, p = 0;
+	int count = 0, max = 0;
+
+	while (capture_next(buf, len, &pos, &rec)) {
+		if (rec.type == CAPTURE_WRITE && wrLen + rec.len <= sizeof(gWritten)) {
+			memcpy(&gWritten[wrLen], rec.data, rec.len);
+			wrLen += rec.len;
+		}
+	}
+
+	*cmds = NULL;
+	while (p + HDR_SIZE <= wrLen)
+	{
+		const uint8_t *h = &gWritten[p];
+		uint32_t payloadLen = h[1] | (h[2] << 8);
+
+		if (h[0] != PACKET_START || payloadLen < 3 || p + HDR_SIZE + payloadLen > wrLen) {
+			p++;
+			continue;
+		}
+		if (count == max) {
+			max = max ? max * 2 : 256;
+			*cmds = (struct REPLAY_CMD *)realloc(*cmds, max * sizeof(struct REPLAY_CMD));
+		}
+		(*cmds)[count].cmd = h[HDR_SIZE];
+		(*cmds)[count].data = &h[HDR_SIZE + 1];
+		(*cmds)[count].dataLen = (uint16_t)(payloadLen - 3);
+		count++;
+		p += HDR_SIZE + payloadLen;
+	}
+	return count;
+}
+
+static int issue(struct NUR_API_HANDLE *hApi, const struct REPLAY_CMD *c)
+{
+	int isFetch = (c->cmd == NUR_CMD_GETIDBUF || c->cmd == NUR_CMD_GETMETABUF);
+	struct NUR_IOVEC iov;
+	int n;
+
+	if (isFetch && c->dataLen <= 1)
+		return NurApiFetchTags(hApi, c->cmd == NUR_CMD_GETMETABUF, c->dataLen == 1 && (c->data[0] & 1), &n, count_tag);
+	if (isFetch && c->dataLen == 4)
+		return NurApiFetchTagAt(hApi, c->cmd == NUR_CMD_GETMETABUF, c->data[0] | (c->data[1] << 8) | (c->data[2] << 16) | (c->data[3] << 24), count_tag);
+
+	iov.data = c->data;
+	iov.len = c->dataLen;
+	return NurApiXchPacketVec(hApi, c->cmd, 0, &iov, 1, DEF_TIMEOUT);
+}
+
+// Record the commands of the -r round trip from device to path
+static int record(const char *device, const char *path)
+{
+	struct NUR_API_HANDLE api;
+	struct NUR_TRANSPORT tr;
+	struct VMODULE_CONFIG cfg;
+	int virt = (strcmp(device, "virtual") == 0);
+	int i, n, failed = 0, error;
+	char mode;
+
+	memset(&api, 0, sizeof(api));
+	api.RxBuffer = gRxBuffer;
+	api.RxBufferLen = sizeof(gRxBuffer);
+	api.TxBuffer = gTxBuffer;
+	api.TxBufferLen = sizeof(gTxBuffer);
+	api.GetTickCountFunction = transport_ticks;
+
+	if (virt) {
+		vmodule_default_config(&cfg);
+		error = open_virtual(&api, &tr, &cfg);
+	} else {
+		error = open_serial(&api, &tr, device, 115200);
+	}
+	if (error != NUR_SUCCESS) {
+		printf("Cannot open %s, error %d\n", device, error);
+		return error;
+	}
+
+	error = capture_start(&api, path);
+	if (error == NUR_SUCCESS)
+	{
+		// Module errors are recorded as they are, transport errors spoil the capture
+		failed += NurApiGetMode(&api, &mode) >= NUR_ERROR_INVALID_HANDLE;
+		failed += NurApiGetVersions(&api) >= NUR_ERROR_INVALID_HANDLE;
+		failed += NurApiPing(&api) >= NUR_ERROR_INVALID_HANDLE;
+		failed += NurApiPing(&api) >= NUR_ERROR_INVALID_HANDLE;
+		failed += NurApiClearTags(&api) >= NUR_ERROR_INVALID_HANDLE;
+		failed += NurApiInventory(&api, NULL) >= NUR_ERROR_INVALID_HANDLE;
+		failed += NurApiFetchTags(&api, TRUE, FALSE, &n, count_tag) >= NUR_ERROR_INVALID_HANDLE;
+		failed += NurApiFetchTags(&api, FALSE, FALSE, &n, count_tag) >= NUR_ERROR_INVALID_HANDLE;
+		for (i = 0; i < 10; i++)
+			failed += NurApiFetchTagAt(&api, TRUE, i, count_tag) >= NUR_ERROR_INVALID_HANDLE;
+		failed += NurApiInventory(&api, NULL) >= NUR_ERROR_INVALID_HANDLE;
+		failed += NurApiFetchTags(&api, TRUE, TRUE, &n, count_tag) >= NUR_ERROR_INVALID_HANDLE;
+		capture_stop(&api);
+
+		printf("Recorded 20 commands, %d tags from %s to %s\n", gTags, device, path);
+		if (failed) {
+			printf("%d transport errors while recording\n", failed);
+			error = NUR_ERROR_GENERAL;
+		}
+	}
+	else {
+		printf("Cannot capture to %s, error %d\n", path, error);
+	}
+
+	if (virt)
+		close_virtual(&api);
+	else
+		close_serial(&api);
+	gTags = 0;
+	return error;
+}
+
+int main(int argc, char *argv[])
+{
+	struct NUR_API_HANDLE api;
+	struct NUR_TRANSPORT tr;
+	struct REPLAY_CMD *cmds;
+	const char *path;
+	const char *recordFrom = NULL;
+	uint8_t *buf;
+	uint32_t len;
+	uint64_t t0, elapsed;
+	int loops = 100;
+	int dumpOnly = 0;
+	int argi = 1;
+	int i, l, count, failed = 0, mismatches = 0, error;
+
+	if (argi < argc && strcmp(argv[argi], "-d") == 0) {
+		dumpOnly = 1;
+		argi++;
+	}
+	else if (argi + 1 < argc && strcmp(argv[argi], "-r") == 0) {
+		recordFrom = argv[argi + 1];
+		argi += 2;
+	}
+	if (argi >= argc) {
+		printf("Usage: %s [-d | -r <device | virtual>] <capture> [loops]\n", argv[0]);
+		return 1;
+	}
+	path = argv[argi++];
+	if (argi < argc)
+		loops = atoi(argv[argi++]);
+	if (loops < 1)
+		loops = 1;
+
+	if (recordFrom && record(recordFrom, path) != NUR_SUCCESS)
+		return 1;
+
+	error = capture_load(path, &buf, &len);
+	if (error != NUR_SUCCESS) {
+		printf("Cannot load %s, error %d\n", path, error);
+		return 1;
+	}
+	if (dumpOnly) {
+		dump(buf, len);
+		free(buf);
+		return 0;
+	}
+
+	count = extract_commands(buf, len, &cmds);
+	if (count == 0) {
+		printf("No commands in %s\n", path);
+		free(buf);
+		return 1;
+	}
+
+	memset(&api, 0, sizeof(api));
+	api.RxBuffer = gRxBuffer;
+	api.RxBufferLen = sizeof(gRxBuffer);
+	api.TxBuffer = gTxBuffer;
+	api.TxBufferLen = sizeof(gTxBuffer);
+	api.GetTickCountFunction = transport_ticks;
+
+	error = open_replay(&api, &tr, path);
+	if (error != NUR_SUCCESS) {
+		printf("Cannot open %s, error %d\n", path, error);
+		free(cmds);
+		free(buf);
+		return 1;
+	}
+
+	t0 = usecs();
+	for (l = 0; l < loops; l++)
+	{
+		replay_rewind(&api);
+		for (i = 0; i < count; i++) {
+			error = issue(&api, &cmds[i]);
+			// Module errors are part of the capture, transport errors are not
+			if (error >= NUR_ERROR_INVALID_HANDLE)
+				failed++;
+		}
+		mismatches += replay_mismatches(&api);
+	}
+	elapsed = usecs() - t0;
+	if (elapsed == 0)
+		elapsed = 1;
+
+	printf("%d commands x %d loops in %llu us: %.0f commands/s, %.0f tags/s, %.1f MB/s\n",
+		count, loops, (unsigned long long)elapsed,
+		(double)count * loops * 1e6 / elapsed, (double)gTags * 1e6 / elapsed,
+		(double)len * loops / elapsed);
+	printf("transport errors %d, write mismatches %d\n", failed, mismatches);
+
+	close_replay(&api);
+	free(cmds);
+	free(buf);
+	return (failed || mismatches) ? 1 : 0;
+}
@@ -0,0 +1,171 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	Host side receive cost per byte, copying parser against zero-copy receive (NUR_HANDLE_FLAG_ZEROCOPY_RX).
+	The transport hands out a prepared response from memory, so the time is the API's own:
+	command write, reads, start byte scan, header and CRC check and, for the copying parser, the copy.
+	Responses of 16 bytes to 8 kB, delivered whole or in 64 byte reads as from a UART FIFO.
+
+	Usage: RxParseBench
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "NurApiConfig.h"
+#include "NurMicroApi.h"
+#include "NurProtocol.h"
+
+static uint8_t gRxBuffer[NUR_MAX_RCV_SZ];
+static uint8_t gTxBuffer[NUR_MAX_SEND_SZ];
+
+// Prepared response and read position in it
+static uint8_t gResponse[NUR_MAX_RCV_SZ + 16];
+static uint32_t gResponseLen;
+static uint32_t gResponsePos;
+static uint32_t gChunk;
+
+static double secs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int mem_read(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesRead)
+{
+	uint32_t n = gResponseLen - gResponsePos;
+
+	(void)hNurApi;
+	if (n == 0)
+		return NUR_ERROR_TR_TIMEOUT;
+	if (gChunk && n > gChunk)
+		n = gChunk;
+	if (n > bufferLen)
+		n = bufferLen;
+	memcpy(buffer, &gResponse[gResponsePos], n);
+	gResponsePos += n;
+	*bytesRead = n;
+	return NUR_SUCCESS;
+}
+
+// Each command write makes the response available again
+static int mem_write(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesWritten)
+{
+	(void)hNurApi;
+	(void)buffer;
+	gResponsePos = 0;
+	*bytesWritten = bufferLen;
+	return NUR_SUCCESS;
+}
+
+static uint16_t crc16(uint16_t crc, const uint8_t *buf, uint32_t len)
+{
+	int bit;
+	while (len--) {
+		crc ^= (uint16_t)(*buf++) << 8;
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+	}
+	return crc;
+}
+
+// Ping response with dataLen bytes of data, framed as the module frames it
+static void make_response(uint32_t dataLen)
+{
+	uint16_t payloadLen = (uint16_t)(1 + 1 + dataLen + 2); // cmd, status, data, CRC
+	uint16_t crc;
+	uint32_t n;
+
+	gResponse[0] = PACKET_START;
+	gResponse[1] = (uint8_t)payloadLen;
+	gResponse[2] = (uint8_t)(payloadLen >> 8);
+	gResponse[3] = 0;
+	gResponse[4] = 0;
+	gResponse[5] = CS_STARTBYTE;
+	for (n = 0; n < 5; n++)
+		gResponse[5] ^= gResponse[n];
+
+	gResponse[HDR_SIZE] = NUR_CMD_PING;
+	gResponse[HDR_SIZE + 1] = NUR_SUCCESS;
+	for (n = 0; n < dataLen; n++)
+		gResponse[HDR_SIZE + 2 + n] = (uint8_t)(n * 7);
+
+	crc = crc16(0xFFFF, &gResponse[HDR_SIZE], 2 + dataLen);
+	gResponse[HDR_SIZE + 2 + dataLen] = (uint8_t)crc;
+	gResponse[HDR_SIZE + 3 + dataLen] = (uint8_t)(crc >> 8);
+	gResponseLen = HDR_SIZE + payloadLen;
+}
+
+static void bench(uint32_t dataLen, uint32_t chunk)
+{
+	struct NUR_API_HANDLE api;
+	double nsPerByte[2];
+	int zeroCopy;
+
+	make_response(dataLen);
+	gChunk = chunk;
+
+	for (zeroCopy = 0; zeroCopy < 2; zeroCopy++)
+	{
+		double t, elapsed;
+		long n, rounds = 0;
+
+		memset(&api, 0, sizeof(api));
+		api.RxBuffer = gRxBuffer;
+		api.RxBufferLen = sizeof(gRxBuffer);
+		api.TxBuffer = gTxBuffer;
+		api.TxBufferLen = sizeof(gTxBuffer);
+		api.TransportReadDataFunction = mem_read;
+		api.TransportWriteDataFunction = mem_write;
+		if (zeroCopy)
+			api.Flags |= NUR_HANDLE_FLAG_ZEROCOPY_RX;
+
+		// Run for about 0.2 s
+		t = secs();
+		do {
+			for (n = 0; n < 1000; n++) {
+				if (NurApiXchPacket(&api, NUR_CMD_PING, 0, 1000) != NUR_SUCCESS || api.respLen != dataLen) {
+					printf("Exchange failed\n");
+					exit(1);
+				}
+			}
+			rounds += n;
+			elapsed = secs() - t;
+		} while (elapsed < 0.2);
+
+		nsPerByte[zeroCopy] = elapsed * 1e9 / ((double)rounds * gResponseLen);
+	}
+
+	printf("%6u  %5s  %8.2f  %9.2f  %6.1fx\n", gResponseLen, chunk ? "64" : "whole",
+		nsPerByte[0], nsPerByte[1], nsPerByte[0] / nsPerByte[1]);
+}
+
+int main(void)
+{
+	static const uint32_t sizes[] = { 16, 128, 1024, 4096, NUR_MAX_RCV_SZ - 16 };
+	unsigned i;
+
+	printf(" bytes  reads  copy ns/B  zero-copy ns/B  ratio\n");
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+		bench(sizes[i], 0);
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+		bench(sizes[i], 64);
+	return 0;
+}
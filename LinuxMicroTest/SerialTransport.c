@@ -0,0 +1,290 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Sample serial transport for Linux / POSIX (termios)
+
+	Port is in raw mode with VMIN=0 / VTIME=0, so read() returns only what is already received.
+	Waiting is done with poll() for the time the API allows (TransportReadTimeout), which returns
+	as soon as the first byte arrives. Writes are not drained (tcdrain), the API does not need it.
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+#include "Transport.h"
+
+#define TR(hApi)	((struct NUR_TRANSPORT *)(hApi)->UserData)
+
+static int serial_read(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesRead);
+static int serial_write(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesWritten);
+static int serial_writev(struct NUR_API_HANDLE *hNurApi, const struct NUR_IOVEC *iov, int iovCnt, uint32_t *bytesWritten);
+
+// Wraps every 49 days; the API only uses differences of ticks
+uint32_t transport_ticks(struct NUR_API_HANDLE *hApi)
+{
+	struct timespec ts;
+
+	(void)hApi;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000);
+}
+
+static speed_t baud_to_speed(uint32_t baudrate)
+{
+	switch (baudrate)
+	{
+	case 9600: return B9600;
+	case 19200: return B19200;
+	case 38400: return B38400;
+	case 57600: return B57600;
+	case 115200: return B115200;
+	case 230400: return B230400;
+#ifdef B460800
+	case 460800: return B460800;
+#endif
+#ifdef B500000
+	case 500000: return B500000;
+#endif
+#ifdef B921600
+	case 921600: return B921600;
+#endif
+#ifdef B1000000
+	case 1000000: return B1000000;
+#endif
+#ifdef B1500000
+	case 1500000: return B1500000;
+#endif
+#ifdef B2000000
+	case 2000000: return B2000000;
+#endif
+#ifdef B3000000
+	case 3000000: return B3000000;
+#endif
+#ifdef B4000000
+	case 4000000: return B4000000;
+#endif
+	default: return B0;
+	}
+}
+
+int open_serial(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, const char *device, uint32_t baudrate)
+{
+	struct termios tio;
+	speed_t speed = baud_to_speed(baudrate);
+
+	if (speed == B0)
+		return NUR_ERROR_INVALID_PARAMETER;
+
+	tr->fd = open(device, O_RDWR | O_NOCTTY | O_CLOEXEC);
+	if (tr->fd < 0)
+		return NUR_ERROR_TR_NOT_CONNECTED;
+
+	if (tcgetattr(tr->fd, &tio) != 0) {
+		close(tr->fd);
+		tr->fd = -1;
+		return NUR_ERROR_TRANSPORT;
+	}
+
+	// 8N1, no flow control, no line discipline processing
+	cfmakeraw(&tio);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 0;
+	cfsetispeed(&tio, speed);
+	cfsetospeed(&tio, speed);
+
+	if (tcsetattr(tr->fd, TCSANOW, &tio) != 0) {
+		close(tr->fd);
+		tr->fd = -1;
+		return NUR_ERROR_TRANSPORT;
+	}
+
+#if defined(__linux__) && defined(ASYNC_LOW_LATENCY)
+	{
+		// Ask driver to push received data immediately (e.g. FTDI latency timer 1 ms).
+		// Not supported by all drivers (pty, cdc-acm); failure is not an error.
+		struct serial_struct ser;
+		if (ioctl(tr->fd, TIOCGSERIAL, &ser) == 0) {
+			ser.flags |= ASYNC_LOW_LATENCY;
+			ioctl(tr->fd, TIOCSSERIAL, &ser);
+		}
+	}
+#endif
+
+	tcflush(tr->fd, TCIOFLUSH);
+
+	attach_fd(hApi, tr, tr->fd);
+
+	return NUR_SUCCESS;
+}
+
+void attach_fd(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, int fd)
+{
+	tr->fd = fd;
+	tr->priv = NULL;
+	tr->capture = NULL;
+	tr->trace = NULL;
+
+	hApi->UserData = tr;
+	hApi->TransportReadDataFunction = serial_read;
+	hApi->TransportWriteDataFunction = serial_write;
+	hApi->TransportWriteVecFunction = serial_writev;
+}
+
+void close_serial(struct NUR_API_HANDLE *hApi)
+{
+	struct NUR_TRANSPORT *tr = TR(hApi);
+
+	if (tr && tr->fd >= 0) {
+		close(tr->fd);
+		tr->fd = -1;
+	}
+}
+
+int set_serial_baudrate(struct NUR_API_HANDLE *hApi, uint32_t baudrate)
+{
+	struct NUR_TRANSPORT *tr = TR(hApi);
+	struct termios tio;
+	speed_t speed = baud_to_speed(baudrate);
+
+	if (tr->fd < 0)
+		return NUR_ERROR_TR_NOT_CONNECTED;
+	if (!isatty(tr->fd))
+		return NUR_SUCCESS;	// Socketpair or pipe, nothing to set
+	if (speed == B0)
+		return NUR_ERROR_INVALID_PARAMETER;
+
+	if (tcgetattr(tr->fd, &tio) != 0)
+		return NUR_ERROR_TRANSPORT;
+	cfsetispeed(&tio, speed);
+	cfsetospeed(&tio, speed);
+	// Pending output goes at the old speed, input received during the switch is garbage
+	if (tcsetattr(tr->fd, TCSADRAIN, &tio) != 0)
+		return NUR_ERROR_TRANSPORT;
+	tcflush(tr->fd, TCIFLUSH);
+
+	return NUR_SUCCESS;
+}
+
+static int serial_read(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesRead)
+{
+	struct NUR_TRANSPORT *tr = TR(hNurApi);
+	struct pollfd pfd;
+	ssize_t n;
+	int rc;
+
+	if (tr->fd < 0)
+		return NUR_ERROR_TR_NOT_CONNECTED;
+
+	// Block until first byte arrives or API deadline passes, zero timeout does not block.
+	pfd.fd = tr->fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	do {
+		rc = poll(&pfd, 1, (int)hNurApi->TransportReadTimeout);
+	} while (rc < 0 && errno == EINTR);
+
+	if (rc < 0)
+		return NUR_ERROR_TRANSPORT;
+	if (rc == 0)
+		return NUR_ERROR_TR_TIMEOUT;
+
+	n = read(tr->fd, buffer, bufferLen);
+	if (n < 0)
+	{
+		if (errno == EAGAIN || errno == EINTR)
+			return NUR_ERROR_TR_TIMEOUT;
+		// EIO happens when usb converter is unplugged
+		return NUR_ERROR_TR_NOT_CONNECTED;
+	}
+	if (n == 0)
+	{
+		// Readable but no data: hang up
+		if (pfd.revents & (POLLHUP | POLLERR))
+			return NUR_ERROR_TR_NOT_CONNECTED;
+		return NUR_ERROR_TR_TIMEOUT;
+	}
+
+	*bytesRead = (uint32_t)n;
+	return NUR_SUCCESS;
+}
+
+// Partial writes are allowed, the API writes the rest
+static int serial_write(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesWritten)
+{
+	struct NUR_TRANSPORT *tr = TR(hNurApi);
+	ssize_t n;
+
+	if (tr->fd < 0)
+		return NUR_ERROR_TR_NOT_CONNECTED;
+
+	n = write(tr->fd, buffer, bufferLen);
+	if (n < 0)
+	{
+		if (errno == EAGAIN || errno == EINTR) {
+			*bytesWritten = 0;
+			return NUR_SUCCESS;
+		}
+		return (errno == EIO || errno == ENXIO) ? NUR_ERROR_TR_NOT_CONNECTED : NUR_ERROR_TRANSPORT;
+	}
+
+	*bytesWritten = (uint32_t)n;
+	return NUR_SUCCESS;
+}
+
+// Header, payload and CRC with one system call
+static int serial_writev(struct NUR_API_HANDLE *hNurApi, const struct NUR_IOVEC *iov, int iovCnt, uint32_t *bytesWritten)
+{
+	struct NUR_TRANSPORT *tr = TR(hNurApi);
+	struct iovec vec[NUR_MAX_IOVEC];
+	ssize_t n;
+	int i;
+
+	if (tr->fd < 0)
+		return NUR_ERROR_TR_NOT_CONNECTED;
+
+	if (iovCnt > NUR_MAX_IOVEC)
+		iovCnt = NUR_MAX_IOVEC;
+	for (i = 0; i < iovCnt; i++) {
+		vec[i].iov_base = (void *)iov[i].data;
+		vec[i].iov_len = iov[i].len;
+	}
+
+	n = writev(tr->fd, vec, iovCnt);
+	if (n < 0)
+	{
+		if (errno == EAGAIN || errno == EINTR) {
+			*bytesWritten = 0;
+			return NUR_SUCCESS;
+		}
+		return (errno == EIO || errno == ENXIO) ? NUR_ERROR_TR_NOT_CONNECTED : NUR_ERROR_TRANSPORT;
+	}
+
+	*bytesWritten = (uint32_t)n;
+	return NUR_SUCCESS;
+}
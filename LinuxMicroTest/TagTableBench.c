@@ -0,0 +1,165 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	EPC deduplication table (NurApiTagTableAdd / NurApiTagTableFind) insert and lookup rates
+	for 10k, 100k and 1M unique tags, with 96-bit EPCs and with 128-bit EPCs (generic path).
+	Checks the table contents while at it: counts, finds after removing every other tag.
+
+	Usage: TagTableBench [maxtags]
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "NurApiConfig.h"
+#include "NurMicroApi.h"
+
+#ifndef CONFIG_TAG_TABLE
+#error "TagTableBench.c needs the API built with CONFIG_TAG_TABLE (NurApiConfig.h or -DCONFIG_TAG_TABLE)"
+#endif
+
+static uint32_t gRng = 0x12345678;
+
+static uint32_t rnd(void)
+{
+	// xorshift32
+	gRng ^= gRng << 13;
+	gRng ^= gRng >> 17;
+	gRng ^= gRng << 5;
+	return gRng;
+}
+
+static double secs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// EPCs as read from the module: header byte, random body, serial number in the last bytes
+static void make_epcs(uint8_t *epcs, int count, int epcLen, uint32_t serialBase)
+{
+	int i, b;
+
+	for (i = 0; i < count; i++)
+	{
+		uint8_t *epc = &epcs[i * epcLen];
+		uint32_t serial = serialBase + (uint32_t)i;
+
+		epc[0] = 0x30;
+		for (b = 1; b < epcLen - 4; b++)
+			epc[b] = (uint8_t)rnd();
+		for (b = 0; b < 4; b++)
+			epc[epcLen - 1 - b] = (uint8_t)(serial >> (b * 8));
+	}
+}
+
+static void report(const char *what, int ops, double t)
+{
+	printf("  %-22s %7.1f M/s  (%.1f ns)\n", what, ops / t / 1e6, t * 1e9 / ops);
+}
+
+static int bench(int count, int epcLen)
+{
+	uint32_t slotCount = 4;
+	struct NUR_TAG_ENTRY *slots;
+	struct NUR_TAG_TABLE table;
+	struct NUR_IDBUFFER_ENTRY tag;
+	uint8_t *epcs, *misses;
+	int i, found, errors = 0;
+	double t;
+
+	while (slotCount - slotCount / 4 < (uint32_t)count)
+		slotCount *= 2;
+
+	slots = malloc(slotCount * sizeof(*slots));
+	epcs = malloc((size_t)count * epcLen);
+	misses = malloc((size_t)count * epcLen);
+	if (!slots || !epcs || !misses) {
+		printf("Out of memory\n");
+		return 1;
+	}
+	make_epcs(epcs, count, epcLen, 0);
+	make_epcs(misses, count, epcLen, 0x80000000UL);
+
+	NurApiTagTableInit(&table, slots, slotCount);
+	printf("%d tags, %d byte EPC, %u slots (%u KiB):\n", count, epcLen, slotCount,
+		(unsigned)(slotCount * sizeof(*slots) / 1024));
+
+	memset(&tag, 0, sizeof(tag));
+	tag.epcLen = (uint8_t)epcLen;
+
+	t = secs();
+	for (i = 0; i < count; i++) {
+		tag.epcData = &epcs[i * epcLen];
+		tag.rssi = (int8_t)(-40 - (i & 31));
+		errors += NurApiTagTableAdd(&table, &tag, 1, NULL) != NUR_SUCCESS;
+	}
+	report("insert new", count, secs() - t);
+
+	t = secs();
+	for (i = 0; i < count; i++) {
+		tag.epcData = &epcs[i * epcLen];
+		errors += NurApiTagTableAdd(&table, &tag, 2, NULL) != NUR_SUCCESS;
+	}
+	report("add seen (dedup)", count, secs() - t);
+
+	t = secs();
+	for (i = found = 0; i < count; i++)
+		found += NurApiTagTableFind(&table, &epcs[i * epcLen], (uint8_t)epcLen) != NULL;
+	report("find hit", count, secs() - t);
+	errors += found != count;
+
+	t = secs();
+	for (i = found = 0; i < count; i++)
+		found += NurApiTagTableFind(&table, &misses[i * epcLen], (uint8_t)epcLen) != NULL;
+	report("find miss", count, secs() - t);
+	errors += found != 0;
+
+	errors += table.Count != (uint32_t)count;
+	for (i = 0; i < count; i += 2)
+		errors += NurApiTagTableRemove(&table, NurApiTagTableFind(&table, &epcs[i * epcLen], (uint8_t)epcLen)) != NUR_SUCCESS;
+	for (i = found = 0; i < count; i++) {
+		struct NUR_TAG_ENTRY *e = NurApiTagTableFind(&table, &epcs[i * epcLen], (uint8_t)epcLen);
+		if (e && (i & 1) && e->ReadCount == 2 && e->FirstSeen == 1 && e->LastSeen == 2)
+			found++;
+		else if (e || !(i & 1))
+			errors += (e != NULL);
+	}
+	errors += found != count / 2 || table.Count != (uint32_t)(count / 2);
+	printf("  check %s\n", errors ? "FAILED" : "ok");
+
+	free(misses);
+	free(epcs);
+	free(slots);
+	return errors != 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int maxTags = (argc > 1) ? atoi(argv[1]) : 1000000;
+	int count, failed = 0;
+
+	for (count = 10000; count <= maxTags; count *= 10)
+	{
+		failed |= bench(count, 12);
+		failed |= bench(count, 16);
+	}
+	return failed;
+}
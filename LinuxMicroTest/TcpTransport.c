@@ -0,0 +1,212 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Sample TCP transport for Ethernet attached readers (Sampo, default port 4333)
+
+	Socket is non-blocking with TCP_NODELAY. Whole packet (header, payload, CRC) is written with
+	one writev() so it leaves in one segment without Nagle delay. Reads wait with poll() for
+	TransportReadTimeout and return whatever has arrived.
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "Transport.h"
+
+#define TR(hApi)	((struct NUR_TRANSPORT *)(hApi)->UserData)
+
+// Max time to wait for socket send buffer space per write call
+#define TCP_WRITE_WAIT	100
+
+static int tcp_read(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesRead);
+static int tcp_write(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesWritten);
+static int tcp_writev(struct NUR_API_HANDLE *hNurApi, const struct NUR_IOVEC *iov, int iovCnt, uint32_t *bytesWritten);
+
+static int wait_fd(int fd, short events, int timeout)
+{
+	struct pollfd pfd;
+	int rc;
+
+	pfd.fd = fd;
+	pfd.events = events;
+	pfd.revents = 0;
+	do {
+		rc = poll(&pfd, 1, timeout);
+	} while (rc < 0 && errno == EINTR);
+
+	return rc;
+}
+
+int open_tcp(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, const char *host, int port, int timeout)
+{
+	struct addrinfo hints, *res, *ai;
+	char portStr[8];
+	int one = 1;
+	int fd = -1;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	snprintf(portStr, sizeof(portStr), "%d", port);
+
+	if (getaddrinfo(host, portStr, &hints, &res) != 0)
+		return NUR_ERROR_TR_NOT_CONNECTED;
+
+	for (ai = res; ai; ai = ai->ai_next)
+	{
+		int soErr = 0;
+		socklen_t soErrLen = sizeof(soErr);
+
+		fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+		if (fd < 0)
+			continue;
+
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+		// Connect with timeout
+		if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+			break;
+		if (errno == EINPROGRESS &&
+			wait_fd(fd, POLLOUT, timeout) > 0 &&
+			getsockopt(fd, SOL_SOCKET, SO_ERROR, &soErr, &soErrLen) == 0 && soErr == 0)
+			break;
+
+		close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(res);
+
+	if (fd < 0)
+		return NUR_ERROR_TR_NOT_CONNECTED;
+
+	// Small request/response packets; do not wait for ACK before sending
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	tr->fd = fd;
+	tr->priv = NULL;
+	tr->capture = NULL;
+	tr->trace = NULL;
+	hApi->UserData = tr;
+	hApi->TransportReadDataFunction = tcp_read;
+	hApi->TransportWriteDataFunction = tcp_write;
+	hApi->TransportWriteVecFunction = tcp_writev;
+
+	return NUR_SUCCESS;
+}
+
+void close_tcp(struct NUR_API_HANDLE *hApi)
+{
+	struct NUR_TRANSPORT *tr = TR(hApi);
+
+	if (tr && tr->fd >= 0) {
+		close(tr->fd);
+		tr->fd = -1;
+	}
+}
+
+static int tcp_read(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesRead)
+{
+	struct NUR_TRANSPORT *tr = TR(hNurApi);
+	ssize_t n;
+
+	if (tr->fd < 0)
+		return NUR_ERROR_TR_NOT_CONNECTED;
+
+	n = recv(tr->fd, buffer, bufferLen, 0);
+	if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+	{
+		// Nothing received yet; wait until the API deadline
+		int rc = wait_fd(tr->fd, POLLIN, (int)hNurApi->TransportReadTimeout);
+		if (rc < 0)
+			return NUR_ERROR_TRANSPORT;
+		if (rc == 0)
+			return NUR_ERROR_TR_TIMEOUT;
+		n = recv(tr->fd, buffer, bufferLen, 0);
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+			return NUR_ERROR_TR_TIMEOUT;
+	}
+
+	if (n <= 0) {
+		// Connection closed or reset by reader
+		return NUR_ERROR_TR_NOT_CONNECTED;
+	}
+
+	*bytesRead = (uint32_t)n;
+	return NUR_SUCCESS;
+}
+
+static int tcp_result(ssize_t n, uint32_t *bytesWritten)
+{
+	if (n < 0)
+	{
+		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+			// Send buffer full, API retries
+			*bytesWritten = 0;
+			return NUR_SUCCESS;
+		}
+		return (errno == EPIPE || errno == ECONNRESET) ? NUR_ERROR_TR_NOT_CONNECTED : NUR_ERROR_TRANSPORT;
+	}
+
+	*bytesWritten = (uint32_t)n;
+	return NUR_SUCCESS;
+}
+
+static int tcp_write(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesWritten)
+{
+	struct NUR_TRANSPORT *tr = TR(hNurApi);
+
+	if (tr->fd < 0)
+		return NUR_ERROR_TR_NOT_CONNECTED;
+
+	wait_fd(tr->fd, POLLOUT, TCP_WRITE_WAIT);
+	return tcp_result(send(tr->fd, buffer, bufferLen, MSG_NOSIGNAL), bytesWritten);
+}
+
+// Header, payload and CRC are coalesced into one send
+static int tcp_writev(struct NUR_API_HANDLE *hNurApi, const struct NUR_IOVEC *iov, int iovCnt, uint32_t *bytesWritten)
+{
+	struct NUR_TRANSPORT *tr = TR(hNurApi);
+	struct iovec vec[NUR_MAX_IOVEC];
+	struct msghdr msg;
+	int i;
+
+	if (tr->fd < 0)
+		return NUR_ERROR_TR_NOT_CONNECTED;
+
+	if (iovCnt > NUR_MAX_IOVEC)
+		iovCnt = NUR_MAX_IOVEC;
+	for (i = 0; i < iovCnt; i++) {
+		vec[i].iov_base = (void *)iov[i].data;
+		vec[i].iov_len = iov[i].len;
+	}
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = vec;
+	msg.msg_iovlen = iovCnt;
+
+	wait_fd(tr->fd, POLLOUT, TCP_WRITE_WAIT);
+	return tcp_result(sendmsg(tr->fd, &msg, MSG_NOSIGNAL), bytesWritten);
+}
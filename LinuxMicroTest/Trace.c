@@ -0,0 +1,286 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Exchange trace recorder and Chrome trace event writer.
+
+	trace_start() sets hApi->XchTraceFunction to a recorder that stores every event
+	with a microsecond timestamp in memory; trace_write_chrome() turns them into one
+	timeline slice per command, split in phases:
+		write		command being written to the transport
+		module		command written, no response bytes yet (transport latency and module processing)
+		receive		response bytes arriving until the response is parsed
+	and "host" slices for time between exchanges (response handling in the API and the application).
+	Responses are matched to commands in order. With pipelined commands the first received
+	bytes are assigned to the oldest command, so module/receive split is approximate there.
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "NurApiConfig.h"
+#include "Transport.h"
+
+#ifndef CONFIG_XCH_TRACE
+#error "Trace.c needs the API built with CONFIG_XCH_TRACE (NurApiConfig.h or -DCONFIG_XCH_TRACE)"
+#endif
+
+#define TR(hApi)	((struct NUR_TRANSPORT *)(hApi)->UserData)
+
+// Most commands in flight that are paired, more than NUR_XCH_WINDOW for safety
+#define MAX_OPEN	16
+
+struct TRACE_EVENT
+{
+	uint64_t us;
+	uint8_t event;
+	uint8_t cmd;
+	uint32_t len;
+	int status;
+};
+
+struct TRACE
+{
+	struct TRACE_EVENT *events;
+	uint32_t count;
+	uint32_t maxEvents;
+	uint32_t dropped;
+	pXchTraceFunction prev;
+};
+
+// Command being paired by trace_write_chrome()
+struct TRACE_OPEN
+{
+	uint8_t cmd;
+	uint32_t len;
+	int track;
+	uint64_t beginUs;
+	uint64_t sentUs;
+	uint64_t rxUs;		// First received bytes, 0 if none yet
+};
+
+static const struct
+{
+	uint8_t cmd;
+	const char *name;
+} cmdNames[] =
+{
+	{ NUR_CMD_PING, "Ping" },
+	{ NUR_CMD_GETMODE, "GetMode" },
+	{ NUR_CMD_VERSIONEX, "GetVersions" },
+	{ NUR_CMD_CLEARIDBUF, "ClearTags" },
+	{ NUR_CMD_GETIDBUF, "FetchTags" },
+	{ NUR_CMD_GETMETABUF, "FetchTagsMeta" },
+	{ NUR_CMD_INVENTORY, "Inventory" },
+	{ NUR_CMD_INVENTORYEX, "InventoryEx" },
+	{ NUR_CMD_READ, "ReadTag" },
+	{ NUR_CMD_WRITE, "WriteTag" },
+	{ NUR_CMD_LOADSETUP2, "ModuleSetup" },
+	{ NUR_CMD_DIAG, "Diag" },
+};
+
+static uint64_t now_us(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void trace_event(struct NUR_API_HANDLE *hNurApi, int event, uint8_t cmd, uint32_t len, int status)
+{
+	struct TRACE *trc = (struct TRACE *)TR(hNurApi)->trace;
+	struct TRACE_EVENT *ev;
+
+	if (trc->prev)
+		trc->prev(hNurApi, event, cmd, len, status);
+
+	if (trc->count == trc->maxEvents) {
+		trc->dropped++;
+		return;
+	}
+	ev = &trc->events[trc->count++];
+	ev->us = now_us();
+	ev->event = (uint8_t)event;
+	ev->cmd = cmd;
+	ev->len = len;
+	ev->status = status;
+}
+
+int trace_start(struct NUR_API_HANDLE *hApi, uint32_t maxEvents)
+{
+	struct NUR_TRANSPORT *tr = TR(hApi);
+	struct TRACE *trc;
+
+	if (!tr || tr->trace || maxEvents == 0)
+		return NUR_ERROR_INVALID_PARAMETER;
+
+	trc = (struct TRACE *)calloc(1, sizeof(*trc));
+	if (!trc)
+		return NUR_ERROR_GENERAL;
+	trc->events = (struct TRACE_EVENT *)malloc(maxEvents * sizeof(struct TRACE_EVENT));
+	if (!trc->events) {
+		free(trc);
+		return NUR_ERROR_GENERAL;
+	}
+	trc->maxEvents = maxEvents;
+	trc->prev = hApi->XchTraceFunction;
+	tr->trace = trc;
+
+	hApi->XchTraceFunction = trace_event;
+	return NUR_SUCCESS;
+}
+
+void trace_stop(struct NUR_API_HANDLE *hApi)
+{
+	struct NUR_TRANSPORT *tr = TR(hApi);
+	struct TRACE *trc;
+
+	if (!tr || !tr->trace)
+		return;
+	trc = (struct TRACE *)tr->trace;
+
+	hApi->XchTraceFunction = trc->prev;
+	free(trc->events);
+	free(trc);
+	tr->trace = NULL;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Chrome trace event writer
+
+static const char *cmd_name(uint8_t cmd, char *buf, size_t bufLen)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(cmdNames) / sizeof(cmdNames[0]); i++) {
+		if (cmdNames[i].cmd == cmd)
+			return cmdNames[i].name;
+	}
+	snprintf(buf, bufLen, "Cmd 0x%02X", cmd);
+	return buf;
+}
+
+// Complete event ("X"); zero length slices are kept so that every command shows up
+static void write_slice(FILE *f, int *first, const char *name, const char *cat, int track, uint64_t t0, uint64_t begin, uint64_t end, const char *args)
+{
+	fprintf(f, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%llu,\"dur\":%llu%s%s}",
+		*first ? "" : ",", name, cat, track,
+		(unsigned long long)(begin - t0), (unsigned long long)(end > begin ? end - begin : 0),
+		args ? ",\"args\":" : "", args ? args : "");
+	*first = 0;
+}
+
+static void write_exchange(FILE *f, int *first, uint64_t t0, const struct TRACE_OPEN *op, const struct TRACE_EVENT *end)
+{
+	char nameBuf[16];
+	char args[128];
+	uint64_t rxUs = op->rxUs ? op->rxUs : end->us;
+
+	snprintf(args, sizeof(args), "{\"cmd\":%u,\"payload\":%u,\"response\":%u,\"status\":%d}",
+		op->cmd, op->len, end->event == NUR_XCH_TRACE_END ? end->len : 0, end->status);
+
+	write_slice(f, first, cmd_name(op->cmd, nameBuf, sizeof(nameBuf)), "cmd", op->track, t0, op->beginUs, end->us, args);
+	write_slice(f, first, "write", "phase", op->track, t0, op->beginUs, op->sentUs ? op->sentUs : end->us, NULL);
+	if (op->sentUs)
+	{
+		write_slice(f, first, "module", "phase", op->track, t0, op->sentUs, rxUs, NULL);
+		write_slice(f, first, "receive", "phase", op->track, t0, rxUs, end->us, NULL);
+	}
+}
+
+int trace_write_chrome(struct NUR_API_HANDLE *hApi, const char *path)
+{
+	struct NUR_TRANSPORT *tr = TR(hApi);
+	struct TRACE *trc;
+	struct TRACE_OPEN open[MAX_OPEN];
+	int openCount = 0;
+	uint64_t t0, idleUs = 0;
+	int first = 1;
+	uint32_t i;
+	int n;
+	FILE *f;
+
+	if (!tr || !tr->trace)
+		return NUR_ERROR_INVALID_PARAMETER;
+	trc = (struct TRACE *)tr->trace;
+
+	f = fopen(path, "w");
+	if (!f)
+		return NUR_ERROR_FILE_NOT_FOUND;
+
+	t0 = trc->count ? trc->events[0].us : 0;
+	fprintf(f, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":%u},\"traceEvents\":[", trc->dropped);
+
+	for (i = 0; i < trc->count; i++)
+	{
+		const struct TRACE_EVENT *ev = &trc->events[i];
+
+		switch (ev->event)
+		{
+		case NUR_XCH_TRACE_BEGIN:
+			if (openCount == MAX_OPEN)
+				break;
+			if (openCount == 0 && idleUs)
+				write_slice(f, &first, "host", "host", 1, t0, idleUs, ev->us, NULL);
+			// One track per window position, so that pipelined commands do not overlap
+			open[openCount].cmd = ev->cmd;
+			open[openCount].len = ev->len;
+			open[openCount].track = openCount ? open[openCount - 1].track % NUR_XCH_WINDOW + 1 : 1;
+			open[openCount].beginUs = ev->us;
+			open[openCount].sentUs = 0;
+			open[openCount].rxUs = 0;
+			openCount++;
+			break;
+
+		case NUR_XCH_TRACE_SENT:
+			// Written right after BEGIN, before anything else
+			if (openCount == 0 || open[openCount - 1].cmd != ev->cmd)
+				break;
+			if (ev->status != NUR_SUCCESS) {
+				// Not started
+				openCount--;
+				write_exchange(f, &first, t0, &open[openCount], ev);
+				idleUs = openCount ? 0 : ev->us;
+				break;
+			}
+			open[openCount - 1].sentUs = ev->us;
+			break;
+
+		case NUR_XCH_TRACE_RX:
+			if (openCount > 0 && open[0].sentUs && !open[0].rxUs)
+				open[0].rxUs = ev->us;
+			break;
+
+		case NUR_XCH_TRACE_END:
+			// Oldest matching command; the rest move up
+			for (n = 0; n < openCount && open[n].cmd != ev->cmd; n++)
+				;
+			if (n == openCount)
+				break;
+			write_exchange(f, &first, t0, &open[n], ev);
+			openCount--;
+			memmove(&open[n], &open[n + 1], (openCount - n) * sizeof(open[0]));
+			idleUs = openCount ? 0 : ev->us;
+			break;
+		}
+	}
+
+	fprintf(f, "\n]}\n");
+	if (fclose(f) != 0)
+		return NUR_ERROR_GENERAL;
+	return NUR_SUCCESS;
+}
@@ -0,0 +1,132 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Sample transports for Linux / POSIX hosts.
+	Transport state is kept in struct NUR_TRANSPORT, pointed by hApi->UserData,
+	so several handles can be open at the same time.
+*/
+
+#ifndef _NURTRANSPORT_H_
+#define _NURTRANSPORT_H_	1
+
+#include "NurMicroApi.h"
+
+struct NUR_TRANSPORT
+{
+	int fd;
+	void *priv;		// Transport specific state
+	void *capture;	// Recording state, see capture_start()
+	void *trace;	// Exchange trace state, see trace_start()
+};
+
+/** Monotonic millisecond clock for hApi->GetTickCountFunction. */
+uint32_t transport_ticks(struct NUR_API_HANDLE *hApi);
+
+/**
+ * Open serial port (e.g. "/dev/ttyACM0") in raw mode and set transport functions to hApi.
+ * @return	NUR_SUCCESS or error code.
+ */
+int open_serial(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, const char *device, uint32_t baudrate);
+void close_serial(struct NUR_API_HANDLE *hApi);
+
+/**
+ * Change baudrate of open serial port, e.g. as NurApiNegotiateBaudrate() callback.
+ * Does nothing for descriptors that are not terminals (attach_fd(), open_virtual()).
+ * @return	NUR_SUCCESS or error code.
+ */
+int set_serial_baudrate(struct NUR_API_HANDLE *hApi, uint32_t baudrate);
+
+/**
+ * Use already open stream descriptor (pipe, socketpair, pty master) with serial transport functions.
+ * Descriptor is closed by close_serial().
+ */
+void attach_fd(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, int fd);
+
+/**
+ * Connect to Ethernet reader (e.g. Sampo, port 4333) and set transport functions to hApi.
+ * @param timeout	Connect timeout in milliseconds.
+ * @return	NUR_SUCCESS or error code.
+ */
+int open_tcp(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, const char *host, int port, int timeout);
+void close_tcp(struct NUR_API_HANDLE *hApi);
+
+struct VMODULE_CONFIG;
+
+/**
+ * Start virtual module (VirtualModule.c) in a thread, connected to hApi over a socketpair.
+ * @param cfg	Module configuration, NULL for vmodule_default_config().
+ * @return	NUR_SUCCESS or error code.
+ */
+int open_virtual(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, const struct VMODULE_CONFIG *cfg);
+void close_virtual(struct NUR_API_HANDLE *hApi);
+
+/** Faults and delay of the virtual link on bytes from the module, see open_virtual_link(). */
+struct VLINK_CONFIG
+{
+	uint32_t flipPpm;		/**< Bytes with one bit flipped, per million. */
+	uint32_t dropPpm;		/**< Bytes dropped, per million. */
+	uint32_t insertPpm;		/**< Bytes preceded by an extra 0xA5 or random byte, per million. */
+	uint32_t maxReadChunk;	/**< Most bytes returned per read, 0 = no limit. */
+	uint32_t latencyUs;		/**< Bytes are readable this long after the module sent them (link round trip), 0 = none. */
+	uint32_t seed;
+};
+
+/**
+ * As open_virtual(), with faults injected into the bytes read from the module, and optional latency.
+ * @param link	Faults and latency, NULL for none.
+ * @return	NUR_SUCCESS or error code.
+ */
+int open_virtual_link(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, const struct VMODULE_CONFIG *cfg, const struct VLINK_CONFIG *link);
+/** Bytes flipped, dropped or inserted by the virtual link so far. */
+uint32_t virtual_link_faults(struct NUR_API_HANDLE *hApi);
+
+/**
+ * Record all bytes read and written through hApi's current transport to capture file (Capture.h).
+ * Transport functions are wrapped; call after the transport is opened.
+ * @return	NUR_SUCCESS or error code.
+ */
+int capture_start(struct NUR_API_HANDLE *hApi, const char *path);
+/** Restore transport functions and close capture file. */
+void capture_stop(struct NUR_API_HANDLE *hApi);
+
+/**
+ * Record exchange trace events (hApi->XchTraceFunction) with microsecond timestamps to memory.
+ * Recording stops when maxEvents are recorded. Transport must be open.
+ * @return	NUR_SUCCESS or error code.
+ */
+int trace_start(struct NUR_API_HANDLE *hApi, uint32_t maxEvents);
+/** Stop recording and free the events. */
+void trace_stop(struct NUR_API_HANDLE *hApi);
+/**
+ * Write recorded exchanges in Chrome trace event JSON (chrome://tracing, Perfetto).
+ * @return	NUR_SUCCESS or error code.
+ */
+int trace_write_chrome(struct NUR_API_HANDLE *hApi, const char *path);
+
+/**
+ * Replay capture file as transport. Reads return recorded module bytes in recorded chunks
+ * without delays; writes are compared with recorded writes and always succeed.
+ * Read returns NUR_ERROR_TR_TIMEOUT when the capture expects a write next,
+ * and NUR_ERROR_TR_NOT_CONNECTED at end of capture.
+ * @return	NUR_SUCCESS or error code.
+ */
+int open_replay(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, const char *path);
+void close_replay(struct NUR_API_HANDLE *hApi);
+/** Start replay from beginning again. */
+void replay_rewind(struct NUR_API_HANDLE *hApi);
+/** Number of written chunks that did not match the capture. */
+int replay_mismatches(struct NUR_API_HANDLE *hApi);
+
+#endif
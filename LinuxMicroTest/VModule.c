@@ -0,0 +1,140 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	Virtual NUR module as a standalone program.
+	Creates a pseudo terminal (or listens on TCP port) and answers NUR commands on it,
+	so that LatencyTest and other host tools can be run without hardware.
+
+	Usage: VModule [-l port] [-t tags] [-e epcbytes] [-r readpercent] [-s serviceus] [-p tagus] [-b baudrate] [-x maxgoodbaudrate]
+	  -l	Listen on TCP port instead of pty; one connection at a time.
+	  -x	Corrupt one response in ten above this baudrate (set with NUR_CMD_SETBDR), to test baudrate negotiation.
+*/
+
+#define _DEFAULT_SOURCE	1
+#define _XOPEN_SOURCE	600
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "VirtualModule.h"
+
+static int serve_pty(struct VMODULE *vm)
+{
+	struct termios tio;
+	int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+	if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+		perror("pty");
+		return 1;
+	}
+
+	// Raw master side; slave is configured by the host transport
+	if (tcgetattr(fd, &tio) == 0) {
+		cfmakeraw(&tio);
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+
+	printf("%s\n", ptsname(fd));
+	fflush(stdout);
+
+	// EIO from master means the slave was closed; keep serving for the next open
+	for (;;) {
+		vmodule_serve(vm, fd);
+		usleep(10000);
+	}
+	return 0;
+}
+
+static int serve_tcp(struct VMODULE *vm, int port)
+{
+	struct sockaddr_in addr;
+	int one = 1;
+	int lfd = socket(AF_INET, SOCK_STREAM, 0);
+
+	if (lfd < 0) {
+		perror("socket");
+		return 1;
+	}
+	setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons((uint16_t)port);
+	if (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(lfd, 1) != 0) {
+		perror("bind");
+		close(lfd);
+		return 1;
+	}
+
+	printf("Listening on port %d\n", port);
+	fflush(stdout);
+
+	for (;;)
+	{
+		int fd = accept(lfd, NULL, NULL);
+		if (fd < 0)
+			continue;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		vmodule_serve(vm, fd);
+		close(fd);
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct VMODULE_CONFIG cfg;
+	struct VMODULE *vm;
+	int port = 0;
+	int i, rc;
+
+	vmodule_default_config(&cfg);
+
+	for (i = 1; i + 1 < argc; i += 2)
+	{
+		long v = strtol(argv[i + 1], NULL, 10);
+		if (strcmp(argv[i], "-l") == 0) port = (int)v;
+		else if (strcmp(argv[i], "-t") == 0) cfg.numTags = (int)v;
+		else if (strcmp(argv[i], "-e") == 0) cfg.epcBytes = (int)v;
+		else if (strcmp(argv[i], "-r") == 0) cfg.readPercent = (int)v;
+		else if (strcmp(argv[i], "-s") == 0) cfg.serviceTimeUs = (uint32_t)v;
+		else if (strcmp(argv[i], "-p") == 0) cfg.tagTimeUs = (uint32_t)v;
+		else if (strcmp(argv[i], "-b") == 0) cfg.baudrate = (uint32_t)v;
+		else if (strcmp(argv[i], "-x") == 0) cfg.maxGoodBaudrate = (uint32_t)v;
+		else break;
+	}
+	if (i < argc) {
+		printf("Usage: %s [-l port] [-t tags] [-e epcbytes] [-r readpercent] [-s serviceus] [-p tagus] [-b baudrate] [-x maxgoodbaudrate]\n", argv[0]);
+		return 1;
+	}
+
+	vm = vmodule_create(&cfg);
+	if (!vm) {
+		printf("Invalid configuration\n");
+		return 1;
+	}
+
+	rc = port ? serve_tcp(vm, port) : serve_pty(vm);
+	vmodule_destroy(vm);
+	return rc;
+}
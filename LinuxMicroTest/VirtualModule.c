@@ -0,0 +1,978 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Virtual NUR module
+
+	Implemented commands:
+	PING, GETMODE, VERSIONEX, CLEARIDBUF, GETIDBUF, GETMETABUF, LOADSETUP2,
+	INVENTORY, INVENTORYEX (filters must all match), READ, WRITE, PAGEWRITE, APPVALIDATE, BLVALIDATE.
+	Other commands are answered with NUR_ERROR_INVALID_COMMAND.
+
+	Each tag has password, EPC, TID and user memory. Tags seen by inventory are added to the
+	module's tag buffer with metadata (RSSI, timestamp, frequency), as in a real module.
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include "NurMicroApi.h"
+#include "VirtualModule.h"
+
+#define VTAG_BANK_SZ		128
+#define VTAG_PASSWD_BYTES	8
+#define VTAG_TID_BYTES		12
+#define VTAG_USER_BYTES		64
+
+// G2 tag error codes sent with NUR_ERROR_G2_TAG_RESP
+#define TAGERR_MEM_OVERRUN	3
+
+struct VTAG
+{
+	uint8_t mem[4][VTAG_BANK_SZ];
+	uint16_t bankLen[4];
+
+	// Tag buffer state and metadata of last read
+	uint8_t inBuffer;
+	int8_t rssi;
+	uint16_t timestamp;
+	uint32_t freq;
+	uint8_t channel;
+};
+
+struct VMODULE
+{
+	struct VMODULE_CONFIG cfg;
+	struct VTAG *tags;
+	int *idBuf;			// Tag indices in the order they were found
+	int idBufCount;
+	struct NUR_CMD_LOADSETUP_PARAMS setup;
+	uint32_t rng;
+	uint32_t startMs;
+	volatile int stop;
+	int pagesWritten;
+	struct NUR_DIAG_REPORT diag;	// Byte and command counters for NUR_CMD_DIAG
+	uint32_t bps;			// Link baudrate, also without pacing
+	uint32_t nextBps;		// Baudrate to switch to after the response, 0 = none
+	int streaming;			// NUR_CMD_INVENTORYSTREAM or streaming NUR_CMD_INVENTORYEX running
+	uint32_t streamStartMs;
+	uint8_t streamNotify;	// NUR_NOTIFY_INVENTORY or NUR_NOTIFY_INVENTORYEX
+	int streamFilterCount;	// Filters of streaming NUR_CMD_INVENTORYEX
+	uint32_t streamFiltersLen;
+	uint8_t streamFilters[NUR_MAX_SEND_SZ];
+
+	uint8_t rx[NUR_MAX_SEND_SZ + HDR_SIZE + 1];
+	uint32_t rxLen;
+	uint8_t tx[NUR_MAX_RCV_SZ + HDR_SIZE + 1];
+};
+
+// Setup members follow flags in struct order, bit N is member N
+static const uint16_t setupOffsets[] =
+{
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, linkFreq),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, rxDecoding),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, txLevel),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, txModulation),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, regionId),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, inventoryQ),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, inventorySession),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, inventoryRounds),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, antennaMask),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, scanSingleTriggerTimeout),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, inventoryTriggerTimeout),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, selectedAntenna),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, opFlags),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, inventoryTarget),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, inventoryEpcLength),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, readRssiFilter),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, writeRssiFilter),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, inventoryRssiFilter),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, readTO),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, writeTO),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, lockTO),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, killTO),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, periodSetup),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, antPower),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, powerOffset),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, antennaMaskEx),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, autotune),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, antPowerEx),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, rxSensitivity),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, rfProfile),
+	offsetof(struct NUR_CMD_LOADSETUP_PARAMS, toSleepTime),
+	sizeof(struct NUR_CMD_LOADSETUP_PARAMS)
+};
+#define SETUP_MEMBERS	(int)(sizeof(setupOffsets) / sizeof(setupOffsets[0]) - 1)
+
+static uint32_t vm_rand(struct VMODULE *vm)
+{
+	// xorshift32
+	uint32_t x = vm->rng;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	vm->rng = x;
+	return x;
+}
+
+static uint32_t now_ms(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000);
+}
+
+static void sleep_us(uint32_t us)
+{
+	struct timespec ts;
+	if (us == 0)
+		return;
+	ts.tv_sec = us / 1000000;
+	ts.tv_nsec = (long)(us % 1000000) * 1000;
+	while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+		;
+}
+
+// Time to transfer bytes at configured baudrate, 10 bits per byte
+static void pace(struct VMODULE *vm, uint32_t bytes)
+{
+	if (vm->cfg.baudrate > 0)
+		sleep_us((uint32_t)((uint64_t)bytes * 10 * 1000000 / vm->cfg.baudrate));
+}
+
+static uint16_t crc16(uint16_t crc, const uint8_t *buf, uint32_t len)
+{
+	int i;
+	while (len--) {
+		crc ^= (uint16_t)(*buf++) << 8;
+		for (i = 0; i < 8; i++)
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+	}
+	return crc;
+}
+
+static uint32_t crc32(const uint8_t *buf, uint32_t len)
+{
+	uint32_t crc = 0xFFFFFFFF;
+	int i;
+	while (len--) {
+		crc ^= *buf++;
+		for (i = 0; i < 8; i++)
+			crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+	}
+	return crc ^ 0xFFFFFFFF;
+}
+
+static uint32_t get_le(const uint8_t *p, int bytes)
+{
+	uint32_t v = 0;
+	while (bytes--)
+		v = (v << 8) | p[bytes];
+	return v;
+}
+
+static void put_le(uint8_t *p, uint32_t v, int bytes)
+{
+	while (bytes--) {
+		*p++ = (uint8_t)v;
+		v >>= 8;
+	}
+}
+
+static int tag_epc_len(const struct VTAG *tag)
+{
+	// PC word (big endian) bits 15..11 are EPC length in words
+	return ((tag->mem[NUR_BANK_EPC][2] >> 3) & 0x1F) * 2;
+}
+
+static void init_tag(struct VMODULE *vm, struct VTAG *tag, int idx)
+{
+	uint8_t *epcBank = tag->mem[NUR_BANK_EPC];
+	uint16_t pc = (uint16_t)((vm->cfg.epcBytes / 2) << 11);
+	int epcLen = vm->cfg.epcBytes;
+	int i;
+
+	memset(tag, 0, sizeof(*tag));
+
+	tag->bankLen[NUR_BANK_PASSWD] = VTAG_PASSWD_BYTES;
+	tag->bankLen[NUR_BANK_EPC] = 4 + NUR_MAX_EPC_LENGTH;
+	tag->bankLen[NUR_BANK_TID] = VTAG_TID_BYTES;
+	tag->bankLen[NUR_BANK_USER] = VTAG_USER_BYTES;
+
+	// EPC: header 0x30, pseudo random body, index in last bytes to keep EPCs unique
+	epcBank[2] = (uint8_t)(pc >> 8);
+	epcBank[3] = (uint8_t)pc;
+	epcBank[4] = 0x30;
+	for (i = 1; i < epcLen; i++)
+		epcBank[4 + i] = (uint8_t)vm_rand(vm);
+	for (i = 0; i < 4 && i < epcLen - 1; i++)
+		epcBank[4 + epcLen - 1 - i] = (uint8_t)(idx >> (i * 8));
+	{
+		uint16_t crc = (uint16_t)~crc16(0xFFFF, &epcBank[2], 2 + epcLen);
+		epcBank[0] = (uint8_t)(crc >> 8);
+		epcBank[1] = (uint8_t)crc;
+	}
+
+	// TID: class E2, Impinj-like model, serial is index
+	tag->mem[NUR_BANK_TID][0] = 0xE2;
+	tag->mem[NUR_BANK_TID][1] = 0x80;
+	tag->mem[NUR_BANK_TID][2] = 0x11;
+	tag->mem[NUR_BANK_TID][3] = 0x05;
+	put_le(&tag->mem[NUR_BANK_TID][8], (uint32_t)idx, 4);
+}
+
+void vmodule_default_config(struct VMODULE_CONFIG *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->numTags = 100;
+	cfg->epcBytes = 12;
+	cfg->readPercent = 100;
+	cfg->seed = 1;
+}
+
+struct VMODULE *vmodule_create(const struct VMODULE_CONFIG *cfg)
+{
+	struct VMODULE *vm;
+	int i;
+
+	if (cfg->numTags < 0 || cfg->epcBytes < 2 || cfg->epcBytes > NUR_MAX_EPC_LENGTH || (cfg->epcBytes & 1))
+		return NULL;
+
+	vm = (struct VMODULE *)calloc(1, sizeof(*vm));
+	if (!vm)
+		return NULL;
+
+	vm->cfg = *cfg;
+	vm->rng = cfg->seed ? cfg->seed : 1;
+	vm->startMs = now_ms();
+	vm->bps = cfg->baudrate ? cfg->baudrate : NUR_DEFAULT_BAUDRATE;
+	vm->tags = (struct VTAG *)calloc(cfg->numTags ? cfg->numTags : 1, sizeof(struct VTAG));
+	vm->idBuf = (int *)calloc(cfg->numTags ? cfg->numTags : 1, sizeof(int));
+	if (!vm->tags || !vm->idBuf) {
+		vmodule_destroy(vm);
+		return NULL;
+	}
+
+	for (i = 0; i < cfg->numTags; i++)
+		init_tag(vm, &vm->tags[i], i);
+
+	// Module defaults
+	vm->setup.linkFreq = 256000;
+	vm->setup.rxDecoding = 2;
+	vm->setup.txLevel = 0;
+	vm->setup.regionId = 0;
+	vm->setup.inventoryQ = 0;
+	vm->setup.inventoryRounds = 0;
+	vm->setup.antennaMask = 1;
+	vm->setup.antennaMaskEx = 1;
+	vm->setup.readTO = 500;
+	vm->setup.writeTO = 500;
+	memset(vm->setup.antPowerEx, -1, sizeof(vm->setup.antPowerEx));
+
+	return vm;
+}
+
+void vmodule_destroy(struct VMODULE *vm)
+{
+	if (vm) {
+		free(vm->tags);
+		free(vm->idBuf);
+		free(vm);
+	}
+}
+
+void vmodule_stop(struct VMODULE *vm)
+{
+	vm->stop = 1;
+}
+
+int vmodule_pages_written(struct VMODULE *vm)
+{
+	return vm->pagesWritten;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Commands. Handlers write response data to 'out' and return status.
+
+static int mask_matches(const struct VTAG *tag, int bank, uint32_t bitAddr, int bitLen, const uint8_t *mask)
+{
+	int i;
+
+	if (bank < 0 || bank > NUR_BANK_USER)
+		return FALSE;
+
+	for (i = 0; i < bitLen; i++)
+	{
+		uint32_t b = bitAddr + i;
+		int memBit, maskBit;
+
+		if (b / 8 >= tag->bankLen[bank])
+			return FALSE;
+		memBit = (tag->mem[bank][b / 8] >> (7 - (b % 8))) & 1;
+		maskBit = (mask[i / 8] >> (7 - (i % 8))) & 1;
+		if (memBit != maskBit)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+// Common RW and optional singulation block. Returns tag or NULL; *pos is advanced past the blocks.
+static struct VTAG *singulate(struct VMODULE *vm, const uint8_t *p, uint32_t len, uint32_t *pos)
+{
+	uint8_t flags;
+	int i;
+
+	if (len < 5)
+		return NULL;
+	flags = p[0];
+	*pos = 5;	// flags, passwd
+
+	if (flags & RW_SBP)
+	{
+		uint32_t btf, bank, addr;
+		int hdrSize = (flags & RW_EA1) ? 11 : 7;
+		int maskBits;
+		const uint8_t *mask;
+
+		if (*pos + 1 + hdrSize > len)
+			return NULL;
+		btf = p[(*pos)++];
+		bank = p[(*pos)++];
+		addr = get_le(&p[*pos], 4);	// 64-bit addresses are never this large on virtual tags
+		*pos += (flags & RW_EA1) ? 8 : 4;
+		maskBits = (int)get_le(&p[*pos], 2);
+		*pos += 2;
+		mask = &p[*pos];
+		*pos += btf - hdrSize;
+		if (*pos > len)
+			return NULL;
+
+		for (i = 0; i < vm->cfg.numTags; i++) {
+			if (mask_matches(&vm->tags[i], (int)bank, addr, maskBits, mask))
+				return &vm->tags[i];
+		}
+		return NULL;
+	}
+
+	// Not singulated: the only (first) tag in field
+	return vm->cfg.numTags > 0 ? &vm->tags[0] : NULL;
+}
+
+static int cmd_read(struct VMODULE *vm, const uint8_t *p, uint32_t len, uint8_t *out, uint32_t *outLen)
+{
+	uint32_t pos, bank, addr, words;
+	struct VTAG *tag = singulate(vm, p, len, &pos);
+
+	if (!tag)
+		return NUR_ERROR_NO_TAG;
+	if (pos + 7 > len)
+		return NUR_ERROR_INVALID_LENGTH;
+
+	bank = p[pos + 1];
+	addr = get_le(&p[pos + 2], 4) * 2;
+	pos += (p[0] & RW_EA2) ? 10 : 6;
+	words = p[pos];
+
+	if (bank > NUR_BANK_USER)
+		return NUR_ERROR_INVALID_PARAMETER;
+	if (words == 0 && addr < tag->bankLen[bank])
+		words = (tag->bankLen[bank] - addr) / 2;	// Whole bank
+	if (addr + words * 2 > tag->bankLen[bank]) {
+		out[0] = TAGERR_MEM_OVERRUN;
+		*outLen = 1;
+		return NUR_ERROR_G2_TAG_RESP;
+	}
+
+	memcpy(out, &tag->mem[bank][addr], words * 2);
+	*outLen = words * 2;
+	return NUR_SUCCESS;
+}
+
+static int cmd_write(struct VMODULE *vm, const uint8_t *p, uint32_t len, uint8_t *out, uint32_t *outLen)
+{
+	uint32_t pos, bank, addr, words;
+	struct VTAG *tag = singulate(vm, p, len, &pos);
+
+	if (!tag)
+		return NUR_ERROR_NO_TAG;
+	if (pos + 7 > len)
+		return NUR_ERROR_INVALID_LENGTH;
+
+	bank = p[pos + 1];
+	addr = get_le(&p[pos + 2], 4) * 2;
+	pos += (p[0] & RW_EA2) ? 10 : 6;
+	words = p[pos++];
+
+	if (bank > NUR_BANK_USER || pos + words * 2 > len)
+		return NUR_ERROR_INVALID_PARAMETER;
+	if (bank == NUR_BANK_TID || addr + words * 2 > tag->bankLen[bank]) {
+		out[0] = TAGERR_MEM_OVERRUN;
+		*outLen = 1;
+		return NUR_ERROR_G2_TAG_RESP;
+	}
+
+	memcpy(&tag->mem[bank][addr], &p[pos], words * 2);
+	return NUR_SUCCESS;
+}
+
+// Inventory filters; all must match. Layout is struct NUR_CMD_INVENTORYEX_FILTER without unused mask bytes.
+static int filters_match(const struct VTAG *tag, const uint8_t *filters, int count, uint32_t len)
+{
+	uint32_t pos = 0;
+	int n;
+
+	for (n = 0; n < count; n++)
+	{
+		int maskBits, maskBytes;
+		if (pos + 9 > len)
+			return FALSE;
+		maskBits = filters[pos + 8];
+		maskBytes = (maskBits / 8) + ((maskBits % 8) != 0);
+		if (pos + 9 + maskBytes > len)
+			return FALSE;
+		if (!mask_matches(tag, filters[pos + 3], get_le(&filters[pos + 4], 4), maskBits, &filters[pos + 9]))
+			return FALSE;
+		pos += 9 + maskBytes;
+	}
+	return TRUE;
+}
+
+static int cmd_inventory(struct VMODULE *vm, const uint8_t *filters, int filterCount, uint32_t filtersLen, uint8_t *out, uint32_t *outLen)
+{
+	struct NUR_CMD_INVENTORY_RESP resp;
+	int i, seen = 0;
+	uint8_t channel = (uint8_t)(vm_rand(vm) % 10);
+
+	for (i = 0; i < vm->cfg.numTags; i++)
+	{
+		struct VTAG *tag = &vm->tags[i];
+
+		if ((int)(vm_rand(vm) % 100) >= vm->cfg.readPercent)
+			continue;
+		if (filterCount > 0 && !filters_match(tag, filters, filterCount, filtersLen))
+			continue;
+
+		seen++;
+		tag->rssi = (int8_t)(-40 - (int)(vm_rand(vm) % 40));
+		tag->timestamp = (uint16_t)(now_ms() - vm->startMs);
+		tag->channel = channel;
+		tag->freq = 865700 + channel * 600;
+		if (!tag->inBuffer) {
+			tag->inBuffer = 1;
+			vm->idBuf[vm->idBufCount++] = i;
+		}
+	}
+
+	sleep_us(vm->cfg.tagTimeUs * seen);
+
+	resp.numTagsFound = (uint16_t)seen;
+	resp.numTagsMem = (uint16_t)vm->idBufCount;
+	resp.roundsDone = 1;
+	resp.collisions = 0;
+	resp.Q = vm->setup.inventoryQ;
+	memcpy(out, &resp, sizeof(resp));
+	*outLen = sizeof(resp);
+
+	return seen ? NUR_SUCCESS : NUR_ERROR_NO_TAG;
+}
+
+static void clear_idbuf(struct VMODULE *vm)
+{
+	int i;
+	for (i = 0; i < vm->idBufCount; i++)
+		vm->tags[vm->idBuf[i]].inBuffer = 0;
+	vm->idBufCount = 0;
+}
+
+// Tag block: length, [rssi, scaledRssi, timestamp, freq, pc, channel], antenna id, EPC
+static uint32_t put_tag(const struct VTAG *tag, int meta, uint8_t *out)
+{
+	uint32_t pos = 1;
+	int epcLen = tag_epc_len(tag);
+
+	if (meta)
+	{
+		int scaled = (tag->rssi + 90) * 100 / 60;
+		out[pos++] = (uint8_t)tag->rssi;
+		out[pos++] = (uint8_t)(scaled < 0 ? 0 : scaled > 100 ? 100 : scaled);
+		put_le(&out[pos], tag->timestamp, 2);
+		pos += 2;
+		put_le(&out[pos], tag->freq, 4);
+		pos += 4;
+		put_le(&out[pos], ((uint16_t)tag->mem[NUR_BANK_EPC][2] << 8) | tag->mem[NUR_BANK_EPC][3], 2);
+		pos += 2;
+		out[pos++] = tag->channel;
+	}
+	out[pos++] = 0;	// Antenna id
+	memcpy(&out[pos], &tag->mem[NUR_BANK_EPC][4], epcLen);
+	pos += epcLen;
+
+	out[0] = (uint8_t)(pos - 1);
+	return pos;
+}
+
+static int cmd_getidbuf(struct VMODULE *vm, int meta, const uint8_t *p, uint32_t len, uint8_t *out, uint32_t *outLen, uint32_t outMax)
+{
+	uint32_t pos = 0;
+	int i, first = 0, last = vm->idBufCount;
+
+	if (len == 8 && vm->cfg.rangeFetch == VMODULE_RANGE_REJECT)
+		return NUR_ERROR_INVALID_LENGTH;
+
+	if (len == 4 || (len == 8 && vm->cfg.rangeFetch != VMODULE_RANGE_IGNORE))
+	{
+		// Single tag at index, or range: first index, count
+		first = (int)get_le(p, 4);
+		if (first >= vm->idBufCount)
+			return NUR_ERROR_NO_TAG;
+		last = first + 1;
+		if (len == 8 && vm->cfg.rangeFetch == VMODULE_RANGE_ACCEPT) {
+			uint32_t count = get_le(&p[4], 4);
+			last = (count < (uint32_t)(vm->idBufCount - first)) ? first + (int)count : vm->idBufCount;
+		}
+	}
+	if (vm->idBufCount == 0)
+		return NUR_ERROR_NO_TAG;
+
+	for (i = first; i < last; i++)
+	{
+		const struct VTAG *tag = &vm->tags[vm->idBuf[i]];
+		if (pos + 2 + 12 + tag_epc_len(tag) > outMax)
+			break;	// Rest can be fetched by index
+		pos += put_tag(tag, meta, &out[pos]);
+	}
+	*outLen = pos;
+
+	if (len == 1 && (p[0] & 1))
+	{
+		// Clear only tags that were sent, rest stay for next fetch
+		int sent = i - first;
+		for (i = 0; i < sent; i++)
+			vm->tags[vm->idBuf[i]].inBuffer = 0;
+		memmove(vm->idBuf, &vm->idBuf[sent], (vm->idBufCount - sent) * sizeof(int));
+		vm->idBufCount -= sent;
+	}
+
+	return NUR_SUCCESS;
+}
+
+static int cmd_loadsetup(struct VMODULE *vm, const uint8_t *p, uint32_t len, uint8_t *out, uint32_t *outLen)
+{
+	uint8_t *setup = (uint8_t *)&vm->setup;
+	uint32_t flags, pos = 4, outPos = 4;
+	int i, status = NUR_SUCCESS;
+
+	if (len < 4)
+		return NUR_ERROR_INVALID_LENGTH;
+	flags = get_le(p, 4) & NUR_SETUP_ALL;
+
+	if (len > 4)
+	{
+		// Set members present in flags
+		for (i = 0; i < SETUP_MEMBERS; i++) {
+			uint32_t sz = setupOffsets[i + 1] - setupOffsets[i];
+			if (!(flags & (1UL << i)))
+				continue;
+			if (pos + sz > len) {
+				status = NUR_ERROR_INVALID_LENGTH;
+				break;
+			}
+			memcpy(setup + setupOffsets[i], &p[pos], sz);
+			pos += sz;
+		}
+	}
+
+	// Response: flags and current value of requested members
+	put_le(out, flags, 4);
+	for (i = 0; i < SETUP_MEMBERS; i++) {
+		uint32_t sz = setupOffsets[i + 1] - setupOffsets[i];
+		if (flags & (1UL << i)) {
+			memcpy(&out[outPos], setup + setupOffsets[i], sz);
+			outPos += sz;
+		}
+	}
+	*outLen = outPos;
+	return status;
+}
+
+static int cmd_pagewrite(struct VMODULE *vm, const uint8_t *p, uint32_t len)
+{
+	uint8_t page[NUR_FLASH_PAGE_SIZE];
+	uint32_t crc;
+	int i;
+
+	if (len != sizeof(struct NUR_CMD_PAGEWRITE_PARAMS))
+		return NUR_ERROR_INVALID_LENGTH;
+
+	// Data is XOR'ed with page CRC
+	crc = get_le(&p[2], 4);
+	for (i = 0; i < NUR_FLASH_PAGE_SIZE; i += 4)
+		put_le(&page[i], get_le(&p[6 + i], 4) ^ crc, 4);
+
+	if (crc32(page, NUR_FLASH_PAGE_SIZE) != crc)
+		return NUR_ERROR_CRC_CHECK;
+
+	vm->pagesWritten++;
+	return NUR_SUCCESS;
+}
+
+// Indexed by enum NUR_BAUDRATE
+static const uint32_t baudrates[] = { 115200, 230400, 500000, 1000000, 1500000, 38400 };
+
+// Switch takes effect after the response, like in the module
+static int cmd_setbdr(struct VMODULE *vm, const uint8_t *p, uint32_t len, uint8_t *out, uint32_t *outLen)
+{
+	uint8_t setting;
+
+	if (len == 0)
+	{
+		// Get: setting of current baudrate
+		for (setting = 0; setting < sizeof(baudrates) / sizeof(baudrates[0]) && baudrates[setting] != vm->bps; setting++)
+			;
+		out[0] = (setting < sizeof(baudrates) / sizeof(baudrates[0])) ? setting : NUR_BR_115200;
+		*outLen = 1;
+		return NUR_SUCCESS;
+	}
+
+	if (p[0] >= sizeof(baudrates) / sizeof(baudrates[0]))
+		return NUR_ERROR_INVALID_PARAMETER;
+	vm->nextBps = baudrates[p[0]];
+	out[0] = p[0];
+	*outLen = 1;
+	return NUR_SUCCESS;
+}
+
+// Only the report; counters are those of struct NUR_DIAG_REPORT the virtual module can have.
+// Report is built before its own response bytes are counted.
+static int cmd_diag(struct VMODULE *vm, const uint8_t *p, uint32_t len, uint8_t *out, uint32_t *outLen)
+{
+	if (len < 1 || p[0] != NUR_CMD_DIAG_GETREPORT)
+		return NUR_ERROR_INVALID_PARAMETER;
+
+	vm->diag.uptime = now_ms() - vm->startMs;
+	vm->diag.temperature = 1000;	// Not supported
+	memcpy(out, &vm->diag, sizeof(vm->diag));
+	*outLen = sizeof(vm->diag);
+
+	if (len >= 5 && (get_le(&p[1], 4) & NUR_DIAG_GETREPORT_RESET_STATS)) {
+		memset(&vm->diag, 0, sizeof(vm->diag));
+		vm->startMs = now_ms();
+	}
+	return NUR_SUCCESS;
+}
+
+static int handle_command(struct VMODULE *vm, uint8_t cmd, const uint8_t *p, uint32_t len, uint8_t *out, uint32_t *outLen, uint32_t outMax)
+{
+	*outLen = 0;
+
+	switch (cmd)
+	{
+	case NUR_CMD_PING:
+		out[0] = 'O';
+		out[1] = 'K';
+		*outLen = 2;
+		return NUR_SUCCESS;
+
+	case NUR_CMD_GETMODE:
+		out[0] = 'A';
+		*outLen = 1;
+		return NUR_SUCCESS;
+
+	case NUR_CMD_VERSIONEX:
+	{
+		struct NUR_CMD_VERSION_RESP v = { 'A', 7, 9, 'A', 7, 0, 'B' };
+		memcpy(out, &v, sizeof(v));
+		*outLen = sizeof(v);
+		return NUR_SUCCESS;
+	}
+
+	case NUR_CMD_CLEARIDBUF:
+		clear_idbuf(vm);
+		return NUR_SUCCESS;
+
+	case NUR_CMD_GETIDBUF:
+	case NUR_CMD_GETMETABUF:
+		return cmd_getidbuf(vm, cmd == NUR_CMD_GETMETABUF, p, len, out, outLen, outMax);
+
+	case NUR_CMD_LOADSETUP2:
+		return cmd_loadsetup(vm, p, len, out, outLen);
+
+	case NUR_CMD_INVENTORY:
+		return cmd_inventory(vm, NULL, 0, 0, out, outLen);
+
+	case NUR_CMD_INVENTORYEX:
+		// flags, Q, session, rounds, transitTime, target, selState, filterCount, filters
+		if (len < 9)
+			return cmd_inventory(vm, NULL, 0, 0, out, outLen);
+		if (p[0] & NUR_INVEX_FLAGS_STREAM)
+		{
+			vm->streamFilterCount = p[8];
+			vm->streamFiltersLen = len - 9;
+			memcpy(vm->streamFilters, &p[9], len - 9);
+			vm->streamNotify = NUR_NOTIFY_INVENTORYEX;
+			vm->streaming = 1;
+			vm->streamStartMs = now_ms();
+			return NUR_SUCCESS;
+		}
+		return cmd_inventory(vm, &p[9], p[8], len - 9, out, outLen);
+
+	case NUR_CMD_READ:
+		return cmd_read(vm, p, len, out, outLen);
+
+	case NUR_CMD_WRITE:
+		return cmd_write(vm, p, len, out, outLen);
+
+	case NUR_CMD_PAGEWRITE:
+		return cmd_pagewrite(vm, p, len);
+
+	case NUR_CMD_APPVALIDATE:
+	case NUR_CMD_BLVALIDATE:
+		return NUR_SUCCESS;
+
+	case NUR_CMD_DIAG:
+		return cmd_diag(vm, p, len, out, outLen);
+
+	case NUR_CMD_SETBDR:
+		return cmd_setbdr(vm, p, len, out, outLen);
+
+	case NUR_CMD_INVENTORYSTREAM:
+		// Rounds are run by vmodule_serve() while no commands arrive
+		vm->streamFilterCount = 0;
+		vm->streamNotify = NUR_NOTIFY_INVENTORY;
+		vm->streaming = 1;
+		vm->streamStartMs = now_ms();
+		return NUR_SUCCESS;
+
+	case NUR_CMD_STOPALLCONT:
+		vm->streaming = 0;
+		return NUR_SUCCESS;
+
+	default:
+		vm->diag.invalidCmds++;
+		return NUR_ERROR_INVALID_COMMAND;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Framing
+
+static int write_all(int fd, const uint8_t *buf, uint32_t len)
+{
+	while (len > 0)
+	{
+		ssize_t n = write(fd, buf, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN) {
+				struct pollfd pfd = { fd, POLLOUT, 0 };
+				poll(&pfd, 1, 100);
+				continue;
+			}
+			return -1;
+		}
+		buf += n;
+		len -= (uint32_t)n;
+	}
+	return 0;
+}
+
+static int send_packet(struct VMODULE *vm, int fd, uint16_t flags, uint8_t cmd, uint8_t status, uint32_t dataLen)
+{
+	uint8_t *b = vm->tx;
+	uint32_t payloadLen = dataLen + 4;	// cmd, status, CRC
+	uint16_t crc;
+
+	b[0] = PACKET_START;
+	put_le(&b[1], payloadLen, 2);
+	put_le(&b[3], flags, 2);
+	b[5] = (uint8_t)(CS_STARTBYTE ^ b[0] ^ b[1] ^ b[2] ^ b[3] ^ b[4]);
+	b[6] = cmd;
+	b[7] = status;
+	crc = crc16(0xFFFF, &b[6], dataLen + 2);
+	put_le(&b[8 + dataLen], crc, 2);
+
+	if (vm->cfg.maxGoodBaudrate && vm->bps > vm->cfg.maxGoodBaudrate && vm_rand(vm) % 10 == 0) {
+		// Unreliable link
+		b[vm_rand(vm) % (HDR_SIZE + payloadLen)] ^= 0x10;
+	}
+
+	pace(vm, HDR_SIZE + payloadLen);
+	vm->diag.bytesOut += HDR_SIZE + payloadLen;
+	if (write_all(fd, b, HDR_SIZE + payloadLen) != 0)
+		return -1;
+
+	if (vm->nextBps) {
+		vm->bps = vm->nextBps;
+		if (vm->cfg.baudrate)
+			vm->cfg.baudrate = vm->bps;
+		vm->nextBps = 0;
+	}
+	return 0;
+}
+
+// Handle complete packets in RX buffer. Returns -1 on write error.
+static int process_rx(struct VMODULE *vm, int fd)
+{
+	uint32_t pos = 0;
+
+	while (vm->rxLen - pos >= HDR_SIZE)
+	{
+		uint8_t *h = &vm->rx[pos];
+		uint32_t payloadLen;
+
+		if (h[0] != PACKET_START || (uint8_t)(CS_STARTBYTE ^ h[0] ^ h[1] ^ h[2] ^ h[3] ^ h[4]) != h[5]) {
+			// Not a header, resync
+			vm->diag.bytesIgnored++;
+			pos++;
+			continue;
+		}
+
+		payloadLen = get_le(&h[1], 2);
+		if (payloadLen < 3 || payloadLen > NUR_MAX_SEND_SZ) {
+			vm->diag.bytesIgnored++;
+			pos++;
+			continue;
+		}
+		if (vm->rxLen - pos < HDR_SIZE + payloadLen)
+			break;	// Wait for rest
+
+		if (crc16(0xFFFF, &h[HDR_SIZE], payloadLen - 2) == get_le(&h[HDR_SIZE + payloadLen - 2], 2))
+		{
+			uint32_t dataLen = 0;
+			int status;
+
+			pace(vm, HDR_SIZE + payloadLen);
+			sleep_us(vm->cfg.serviceTimeUs);
+
+			status = handle_command(vm, h[HDR_SIZE], &h[HDR_SIZE + 1], payloadLen - 3,
+									&vm->tx[HDR_SIZE + 2], &dataLen, NUR_MAX_RCV_SZ - 4);
+			if (send_packet(vm, fd, 0, h[HDR_SIZE], (uint8_t)status, dataLen) != 0)
+				return -1;
+		}
+		else {
+			// Bad CRC is ignored, like the module does
+			vm->diag.bytesIgnored += HDR_SIZE + payloadLen;
+		}
+		pos += HDR_SIZE + payloadLen;
+	}
+
+	// Keep partial packet
+	memmove(vm->rx, &vm->rx[pos], vm->rxLen - pos);
+	vm->rxLen -= pos;
+	return 0;
+}
+
+/*
+	One inventory stream round: tags seen are sent in NUR_NOTIFY_INVENTORY (NUR_NOTIFY_INVENTORYEX) notifications,
+	stopped, roundsDone, collisions (u16), Q, then tags as in NUR_CMD_GETMETABUF.
+	The last notification has stopped set when the stream times out.
+*/
+static int stream_round(struct VMODULE *vm, int fd)
+{
+	uint8_t *out = &vm->tx[HDR_SIZE + 2];
+	uint32_t pos = 5;
+	int stop = vm->cfg.streamTimeoutMs && now_ms() - vm->streamStartMs >= vm->cfg.streamTimeoutMs;
+	uint8_t channel = (uint8_t)(vm_rand(vm) % 10);
+	int i, seen = 0;
+
+	sleep_us(vm->cfg.serviceTimeUs);
+
+	for (i = 0; i <= vm->cfg.numTags; i++)
+	{
+		struct VTAG *tag = (i < vm->cfg.numTags) ? &vm->tags[i] : NULL;
+
+		if (tag && (int)(vm_rand(vm) % 100) >= vm->cfg.readPercent)
+			continue;
+		if (tag && vm->streamFilterCount > 0 && !filters_match(tag, vm->streamFilters, vm->streamFilterCount, vm->streamFiltersLen))
+			continue;
+
+		if (!tag || pos + 2 + 12 + tag_epc_len(tag) > NUR_MAX_RCV_SZ - 4)
+		{
+			// Full or end of round
+			if (!tag && pos == 5 && !stop)
+				break;
+			out[0] = (uint8_t)(!tag && stop);
+			out[1] = 1;
+			put_le(&out[2], 0, 2);
+			out[4] = vm->setup.inventoryQ;
+			if (send_packet(vm, fd, PACKET_FLAG_UNSOL, vm->streamNotify, NUR_SUCCESS, pos) != 0)
+				return -1;
+			pos = 5;
+			if (!tag)
+				break;
+		}
+
+		seen++;
+		tag->rssi = (int8_t)(-40 - (int)(vm_rand(vm) % 40));
+		tag->timestamp = (uint16_t)(now_ms() - vm->startMs);
+		tag->channel = channel;
+		tag->freq = 865700 + channel * 600;
+		pos += put_tag(tag, 1, &out[pos]);
+	}
+
+	// Round takes at least a millisecond, also without tags
+	sleep_us(seen ? vm->cfg.tagTimeUs * seen : 1000);
+
+	if (stop)
+		vm->streaming = 0;
+	return 0;
+}
+
+int vmodule_serve(struct VMODULE *vm, int fd)
+{
+	vm->stop = 0;
+
+	while (!vm->stop)
+	{
+		struct pollfd pfd = { fd, POLLIN, 0 };
+		ssize_t n;
+		int rc = poll(&pfd, 1, vm->streaming ? 0 : 100);
+
+		if (rc < 0 && errno != EINTR)
+			return -1;
+		if (rc == 0 && vm->streaming) {
+			if (stream_round(vm, fd) != 0)
+				return -1;
+			continue;
+		}
+		if (rc <= 0)
+			continue;
+
+		if (vm->rxLen == sizeof(vm->rx)) {
+			vm->diag.bytesIgnored += vm->rxLen;
+			vm->rxLen = 0;	// Garbage only, start over
+		}
+		n = read(fd, &vm->rx[vm->rxLen], sizeof(vm->rx) - vm->rxLen);
+		if (n == 0 || (n < 0 && errno == EIO))
+			return 0;	// Peer closed (EIO on pty master)
+		if (n < 0) {
+			if (errno == EINTR || errno == EAGAIN)
+				continue;
+			return -1;
+		}
+		vm->rxLen += (uint32_t)n;
+		vm->diag.bytesIn += (uint32_t)n;
+
+		if (process_rx(vm, fd) != 0)
+			return -1;
+	}
+	return 0;
+}
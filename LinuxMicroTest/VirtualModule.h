@@ -0,0 +1,67 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Virtual NUR module.
+	Answers the NUR protocol (header, CRC16) over any file descriptor: pty, socketpair or TCP socket.
+	Used for testing and benchmarking without hardware.
+*/
+
+#ifndef _VIRTUALMODULE_H_
+#define _VIRTUALMODULE_H_	1
+
+#include <stdint.h>
+
+/** How NUR_CMD_GETIDBUF / NUR_CMD_GETMETABUF answer a range request: first index and count, 8 byte payload. */
+enum VMODULE_RANGE
+{
+	VMODULE_RANGE_ACCEPT = 0,	/**< Tags first .. first + count - 1. */
+	VMODULE_RANGE_REJECT,		/**< NUR_ERROR_INVALID_LENGTH. */
+	VMODULE_RANGE_INDEX,		/**< Count ignored: tag at first index only. */
+	VMODULE_RANGE_IGNORE		/**< Payload ignored: whole tag buffer. */
+};
+
+struct VMODULE_CONFIG
+{
+	int numTags;			/**< Tag population in the field. */
+	int epcBytes;			/**< EPC length in bytes, even, 2..62. */
+	int readPercent;		/**< Probability (0..100) that a tag is seen in one inventory. */
+	uint32_t serviceTimeUs;	/**< Processing time of every command in microseconds. */
+	uint32_t tagTimeUs;		/**< Additional inventory time per tag seen in microseconds. */
+	uint32_t baudrate;		/**< Bytes are paced at this rate (10 bits per byte). 0 = no pacing. Changed by NUR_CMD_SETBDR. */
+	uint32_t streamTimeoutMs;	/**< Inventory stream stops by itself after this long, like the module does. 0 = never. */
+	uint32_t maxGoodBaudrate;	/**< Above this baudrate one response in ten has a corrupted byte. 0 = never. */
+	int rangeFetch;			/**< Answer to range requests, enum VMODULE_RANGE. */
+	uint32_t seed;			/**< Seed for tag EPCs, RSSI and read probability. */
+};
+
+/** Fill config with defaults: 100 tags, 12 byte EPC, always seen, no delays. */
+void vmodule_default_config(struct VMODULE_CONFIG *cfg);
+
+struct VMODULE;
+
+struct VMODULE *vmodule_create(const struct VMODULE_CONFIG *cfg);
+void vmodule_destroy(struct VMODULE *vm);
+
+/**
+ * Serve commands from fd until it is closed or vmodule_stop() is called.
+ * @return	Zero when fd was closed by the peer.
+ */
+int vmodule_serve(struct VMODULE *vm, int fd);
+void vmodule_stop(struct VMODULE *vm);
+
+/** Number of flash pages written with NUR_CMD_PAGEWRITE. */
+int vmodule_pages_written(struct VMODULE *vm);
+
+#endif
@@ -0,0 +1,280 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	In-process transport to virtual module (VirtualModule.c).
+	Module runs in its own thread at the other end of a socketpair;
+	API side uses the serial transport functions on the socket, optionally behind
+	a faulty or slow link (open_virtual_link()).
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "NurMicroApi.h"
+#include "Transport.h"
+#include "VirtualModule.h"
+
+#define LINK_CHUNK	4096
+
+// Delay line: bytes in transit, and the reads they arrived in with their due times
+#define LINK_DELAY_BYTES	65536
+#define LINK_DELAY_SEGS		256
+
+struct VIRTUAL_PRIV
+{
+	struct VMODULE *vm;
+	int fd;
+	pthread_t thread;
+
+	struct VLINK_CONFIG link;
+	pTransportReadDataFunction read;	// Serial read under the link
+	uint32_t rng;
+	uint32_t faults;
+	uint8_t chunk[LINK_CHUNK];
+
+	uint8_t *delay;
+	uint32_t delayHead, delayCount;
+	uint64_t segDue[LINK_DELAY_SEGS];
+	uint32_t segLen[LINK_DELAY_SEGS];
+	uint32_t segHead, segCount;
+};
+
+static uint32_t link_rnd(struct VIRTUAL_PRIV *priv)
+{
+	// xorshift32
+	priv->rng ^= priv->rng << 13;
+	priv->rng ^= priv->rng >> 17;
+	priv->rng ^= priv->rng << 5;
+	return priv->rng;
+}
+
+static uint64_t link_usecs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+// Move bytes from the module to the delay line, due latencyUs from now. Each read fills a contiguous segment.
+static int delay_fill(struct NUR_API_HANDLE *hNurApi, struct VIRTUAL_PRIV *priv, uint32_t timeoutMs)
+{
+	uint32_t savedTimeout = hNurApi->TransportReadTimeout;
+	uint32_t tail, room, got = 0, seg;
+	int error;
+
+	if (priv->segCount == LINK_DELAY_SEGS || priv->delayCount == LINK_DELAY_BYTES)
+		return NUR_ERROR_TR_TIMEOUT;
+
+	tail = (priv->delayHead + priv->delayCount) % LINK_DELAY_BYTES;
+	room = LINK_DELAY_BYTES - priv->delayCount;
+	if (room > LINK_DELAY_BYTES - tail)
+		room = LINK_DELAY_BYTES - tail;
+
+	hNurApi->TransportReadTimeout = timeoutMs;
+	error = priv->read(hNurApi, priv->delay + tail, room, &got);
+	hNurApi->TransportReadTimeout = savedTimeout;
+	if (error != NUR_SUCCESS)
+		return error;
+
+	seg = (priv->segHead + priv->segCount++) % LINK_DELAY_SEGS;
+	priv->segDue[seg] = link_usecs() + priv->link.latencyUs;
+	priv->segLen[seg] = got;
+	priv->delayCount += got;
+	return NUR_SUCCESS;
+}
+
+// Read through the delay line within the API's read timeout; data keeps arriving while the oldest bytes are in transit
+static int delay_read(struct NUR_API_HANDLE *hNurApi, struct VIRTUAL_PRIV *priv, uint8_t *buffer, uint32_t len, uint32_t *got)
+{
+	uint64_t deadline = link_usecs() + (uint64_t)hNurApi->TransportReadTimeout * 1000;
+	uint64_t now, until;
+	int polled = 0;
+	int error;
+
+	for (;;)
+	{
+		now = link_usecs();
+		if (priv->segCount && priv->segDue[priv->segHead] <= now)
+			break;
+		if (now >= deadline && polled)
+			return NUR_ERROR_TR_TIMEOUT;
+
+		until = (priv->segCount && priv->segDue[priv->segHead] < deadline) ? priv->segDue[priv->segHead] : deadline;
+		error = delay_fill(hNurApi, priv, (until > now) ? (uint32_t)((until - now) / 1000) : 0);
+		polled = 1;
+		if (error == NUR_ERROR_TR_TIMEOUT) {
+			// Poll has millisecond resolution, finish shorter waits here
+			now = link_usecs();
+			if (until > now)
+				usleep((until - now < 100) ? (useconds_t)(until - now) : 100);
+		} else if (error != NUR_SUCCESS) {
+			return error;
+		}
+	}
+
+	if (len > priv->segLen[priv->segHead])
+		len = priv->segLen[priv->segHead];
+	memcpy(buffer, priv->delay + priv->delayHead, len);
+	priv->delayHead = (priv->delayHead + len) % LINK_DELAY_BYTES;
+	priv->delayCount -= len;
+	priv->segLen[priv->segHead] -= len;
+	if (priv->segLen[priv->segHead] == 0) {
+		priv->segHead = (priv->segHead + 1) % LINK_DELAY_SEGS;
+		priv->segCount--;
+	}
+	*got = len;
+	return NUR_SUCCESS;
+}
+
+// Read at most half of bufferLen so that every byte can get an inserted one before it
+static int link_read(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesRead)
+{
+	struct VIRTUAL_PRIV *priv = (struct VIRTUAL_PRIV *)((struct NUR_TRANSPORT *)hNurApi->UserData)->priv;
+	const struct VLINK_CONFIG *link = &priv->link;
+	uint32_t len = bufferLen / 2, got = 0, out = 0, n;
+	int error;
+
+	if (len > LINK_CHUNK)
+		len = LINK_CHUNK;
+	if (link->maxReadChunk && len > link->maxReadChunk)
+		len = link->maxReadChunk;
+	if (len == 0)
+		len = 1;
+
+	if (priv->delay)
+		error = delay_read(hNurApi, priv, priv->chunk, len, &got);
+	else
+		error = priv->read(hNurApi, priv->chunk, len, &got);
+	if (error != NUR_SUCCESS)
+		return error;
+
+	for (n = 0; n < got; n++)
+	{
+		uint8_t b = priv->chunk[n];
+
+		if (link->dropPpm && link_rnd(priv) % 1000000 < link->dropPpm) {
+			priv->faults++;
+			continue;
+		}
+		if (link->insertPpm && link_rnd(priv) % 1000000 < link->insertPpm && out + 1 < bufferLen) {
+			buffer[out++] = (link_rnd(priv) & 1) ? 0xA5 : (uint8_t)link_rnd(priv);
+			priv->faults++;
+		}
+		if (link->flipPpm && link_rnd(priv) % 1000000 < link->flipPpm) {
+			b ^= (uint8_t)(1 << (link_rnd(priv) % 8));
+			priv->faults++;
+		}
+		buffer[out++] = b;
+	}
+
+	if (out == 0)
+		return NUR_ERROR_TR_TIMEOUT;
+	*bytesRead = out;
+	return NUR_SUCCESS;
+}
+
+static void *module_thread(void *arg)
+{
+	struct VIRTUAL_PRIV *priv = (struct VIRTUAL_PRIV *)arg;
+	vmodule_serve(priv->vm, priv->fd);
+	return NULL;
+}
+
+int open_virtual(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, const struct VMODULE_CONFIG *cfg)
+{
+	return open_virtual_link(hApi, tr, cfg, NULL);
+}
+
+int open_virtual_link(struct NUR_API_HANDLE *hApi, struct NUR_TRANSPORT *tr, const struct VMODULE_CONFIG *cfg, const struct VLINK_CONFIG *link)
+{
+	struct VMODULE_CONFIG defCfg;
+	struct VIRTUAL_PRIV *priv;
+	int sv[2];
+
+	if (!cfg) {
+		vmodule_default_config(&defCfg);
+		cfg = &defCfg;
+	}
+
+	priv = (struct VIRTUAL_PRIV *)calloc(1, sizeof(*priv));
+	if (!priv)
+		return NUR_ERROR_GENERAL;
+
+	priv->vm = vmodule_create(cfg);
+	if (!priv->vm) {
+		free(priv);
+		return NUR_ERROR_INVALID_PARAMETER;
+	}
+
+	if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) {
+		vmodule_destroy(priv->vm);
+		free(priv);
+		return NUR_ERROR_TRANSPORT;
+	}
+	priv->fd = sv[1];
+
+	if (pthread_create(&priv->thread, NULL, module_thread, priv) != 0) {
+		close(sv[0]);
+		close(sv[1]);
+		vmodule_destroy(priv->vm);
+		free(priv);
+		return NUR_ERROR_TRANSPORT;
+	}
+
+	attach_fd(hApi, tr, sv[0]);
+	tr->priv = priv;
+
+	if (link)
+	{
+		priv->link = *link;
+		priv->rng = link->seed ? link->seed : 0x12345678;
+		priv->read = hApi->TransportReadDataFunction;
+		hApi->TransportReadDataFunction = link_read;
+		if (link->latencyUs)
+			priv->delay = (uint8_t *)malloc(LINK_DELAY_BYTES);
+	}
+
+	return NUR_SUCCESS;
+}
+
+uint32_t virtual_link_faults(struct NUR_API_HANDLE *hApi)
+{
+	struct NUR_TRANSPORT *tr = (struct NUR_TRANSPORT *)hApi->UserData;
+	return (tr && tr->priv) ? ((struct VIRTUAL_PRIV *)tr->priv)->faults : 0;
+}
+
+void close_virtual(struct NUR_API_HANDLE *hApi)
+{
+	struct NUR_TRANSPORT *tr = (struct NUR_TRANSPORT *)hApi->UserData;
+	struct VIRTUAL_PRIV *priv;
+
+	if (!tr || !tr->priv)
+		return;
+	priv = (struct VIRTUAL_PRIV *)tr->priv;
+
+	vmodule_stop(priv->vm);
+	pthread_join(priv->thread, NULL);
+	close(priv->fd);
+	close_serial(hApi);
+
+	vmodule_destroy(priv->vm);
+	free(priv->delay);
+	free(priv);
+	tr->priv = NULL;
+}
@@ -0,0 +1,524 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	EPC watchlist matcher, see Watchlist.h.
+
+	Keys are the first 128 bits of the EPC as four big-endian 32-bit words, zero padded, masked to the prefix length.
+	Bloom filter is blocked: one 32-bit word per key with three bits set, so a probe is one load (one gather for 8 keys).
+	Hash is computed in 32-bit lanes so that the scalar and AVX2 paths give identical results.
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdlib.h>
+#include <string.h>
+#include "NurApiConfig.h"
+#include "NurMicroApi.h"
+#include "Watchlist.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define WL_HAVE_X86	1
+#include <immintrin.h>
+#endif
+
+#define WL_LANES			8		// EPCs per block
+#define WL_BLOOM_BITS		16		// Bloom filter bits per entry
+#define WL_MAX_DIR_BITS		20
+
+#define WL_C0	0x85EBCA77U
+#define WL_C1	0xC2B2AE3DU
+#define WL_C2	0x27D4EB2FU
+#define WL_C3	0x165667B1U
+#define WL_C4	0x9E3779B1U
+#define WL_M1	0x2C1B3C6DU
+#define WL_M2	0x297A2D39U
+
+struct WL_ENTRY
+{
+	uint64_t hi, lo;		// Masked key
+	uint32_t id;
+	uint32_t hits;
+};
+
+// All entries of one prefix length
+struct WL_GROUP
+{
+	int bits;
+	uint32_t mask[4];
+	uint64_t maskHi, maskLo;
+	int fullWords;				// Words fully in the prefix
+	int partWord;				// Word partly in the prefix, -1 if none
+	struct WL_ENTRY *entries;	// Sorted by key
+	uint32_t count;
+	int dirBits;
+	uint32_t *dir;				// Entries with first dirBits of key = b are dir[b] .. dir[b + 1] - 1
+};
+
+struct WATCHLIST
+{
+	// Added entries until compile
+	struct WL_ENTRY *added;
+	uint8_t *addedBits;
+	uint32_t addedCount, addedMax;
+
+	struct WL_GROUP groups[WATCHLIST_MAX_BITS];
+	int groupCount;
+	uint32_t entryCount;
+
+	uint32_t *bloom;
+	uint32_t bloomMask;			// Words - 1
+
+	int compiled;
+	int isa;
+};
+
+// EPC words of one block, lane n of word i at w[i][n]
+struct WL_BLOCK
+{
+	uint32_t w[4][WL_LANES];
+	uint32_t p[4][WL_LANES];	// Hash products w[i] * C[i], shared by groups where word i is fully in the prefix
+	int32_t avail[WL_LANES];	// EPC bits, 0 for unused lanes
+};
+
+static const uint32_t gWordMul[4] = { WL_C0, WL_C1, WL_C2, WL_C3 };
+
+static uint32_t be32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void word_masks(int bits, uint32_t *mask)
+{
+	int i;
+	for (i = 0; i < 4; i++, bits -= 32)
+		mask[i] = (bits >= 32) ? 0xFFFFFFFFU : (bits <= 0) ? 0 : ~(0xFFFFFFFFU >> bits);
+}
+
+static uint32_t wl_hash(uint32_t w0, uint32_t w1, uint32_t w2, uint32_t w3, uint32_t bits)
+{
+	uint32_t h = (bits * WL_C4) ^ (w0 * WL_C0) ^ (w1 * WL_C1) ^ (w2 * WL_C2) ^ (w3 * WL_C3);
+	h ^= h >> 15;
+	h *= WL_M1;
+	h ^= h >> 12;
+	h *= WL_M2;
+	h ^= h >> 15;
+	return h;
+}
+
+// Three bits of the Bloom word, from the high bits of a second multiply
+static uint32_t wl_bloom_bits(uint32_t h)
+{
+	uint32_t g = h * WL_C4;
+	return (1U << (g >> 27)) | (1U << ((g >> 22) & 31)) | (1U << ((g >> 17) & 31));
+}
+
+struct WATCHLIST *watchlist_create(void)
+{
+	return (struct WATCHLIST *)calloc(1, sizeof(struct WATCHLIST));
+}
+
+void watchlist_destroy(struct WATCHLIST *wl)
+{
+	int g;
+
+	if (!wl)
+		return;
+	for (g = 0; g < wl->groupCount; g++) {
+		free(wl->groups[g].entries);
+		free(wl->groups[g].dir);
+	}
+	free(wl->added);
+	free(wl->addedBits);
+	free(wl->bloom);
+	free(wl);
+}
+
+int watchlist_add(struct WATCHLIST *wl, const uint8_t *prefix, int bitLen, uint32_t id)
+{
+	uint8_t key[16];
+	uint32_t mask[4];
+	struct WL_ENTRY *e;
+
+	if (wl->compiled || bitLen < 1 || bitLen > WATCHLIST_MAX_BITS)
+		return NUR_ERROR_INVALID_PARAMETER;
+
+	if (wl->addedCount == wl->addedMax)
+	{
+		uint32_t max = wl->addedMax ? wl->addedMax * 2 : 1024;
+		struct WL_ENTRY *added = (struct WL_ENTRY *)realloc(wl->added, max * sizeof(*added));
+		uint8_t *addedBits;
+		if (!added)
+			return NUR_ERROR_GENERAL;
+		wl->added = added;
+		addedBits = (uint8_t *)realloc(wl->addedBits, max);
+		if (!addedBits)
+			return NUR_ERROR_GENERAL;
+		wl->addedBits = addedBits;
+		wl->addedMax = max;
+	}
+
+	memset(key, 0, sizeof(key));
+	memcpy(key, prefix, (bitLen + 7) / 8);
+	word_masks(bitLen, mask);
+
+	e = &wl->added[wl->addedCount];
+	e->hi = ((uint64_t)(be32(key) & mask[0]) << 32) | (be32(key + 4) & mask[1]);
+	e->lo = ((uint64_t)(be32(key + 8) & mask[2]) << 32) | (be32(key + 12) & mask[3]);
+	e->id = id;
+	e->hits = 0;
+	wl->addedBits[wl->addedCount] = (uint8_t)bitLen;
+	wl->addedCount++;
+
+	return NUR_SUCCESS;
+}
+
+int watchlist_add_filter(struct WATCHLIST *wl, const struct NUR_CMD_INVENTORYEX_FILTER *filter, uint32_t id)
+{
+	if (filter->bank != NUR_BANK_EPC || filter->address != 32)
+		return NUR_ERROR_INVALID_PARAMETER;
+	return watchlist_add(wl, filter->maskdata, filter->maskbitlen, id);
+}
+
+static int cmp_entry(const void *a, const void *b)
+{
+	const struct WL_ENTRY *x = (const struct WL_ENTRY *)a, *y = (const struct WL_ENTRY *)b;
+	if (x->hi != y->hi)
+		return (x->hi > y->hi) ? 1 : -1;
+	if (x->lo != y->lo)
+		return (x->lo > y->lo) ? 1 : -1;
+	return 0;
+}
+
+static uint32_t dir_index(const struct WL_GROUP *grp, uint64_t hi)
+{
+	return grp->dirBits ? (uint32_t)(hi >> (64 - grp->dirBits)) : 0;
+}
+
+int watchlist_compile(struct WATCHLIST *wl)
+{
+	uint32_t perBits[WATCHLIST_MAX_BITS + 1];
+	uint32_t i, words;
+	int bits, g;
+
+	if (wl->compiled)
+		return NUR_SUCCESS;
+
+	memset(perBits, 0, sizeof(perBits));
+	for (i = 0; i < wl->addedCount; i++)
+		perBits[wl->addedBits[i]]++;
+
+	// Longest prefixes first: full EPCs are usually the largest group
+	for (bits = WATCHLIST_MAX_BITS; bits >= 1; bits--)
+	{
+		struct WL_GROUP *grp;
+		uint32_t n, b, dirSize;
+
+		if (perBits[bits] == 0)
+			continue;
+
+		grp = &wl->groups[wl->groupCount++];
+		grp->bits = bits;
+		word_masks(bits, grp->mask);
+		grp->maskHi = ((uint64_t)grp->mask[0] << 32) | grp->mask[1];
+		grp->maskLo = ((uint64_t)grp->mask[2] << 32) | grp->mask[3];
+		grp->fullWords = bits / 32;
+		grp->partWord = (bits % 32) ? bits / 32 : -1;
+		grp->entries = (struct WL_ENTRY *)malloc(perBits[bits] * sizeof(struct WL_ENTRY));
+		if (!grp->entries)
+			return NUR_ERROR_GENERAL;
+
+		for (i = n = 0; i < wl->addedCount; i++)
+			if (wl->addedBits[i] == bits)
+				grp->entries[n++] = wl->added[i];
+		grp->count = n;
+		qsort(grp->entries, n, sizeof(struct WL_ENTRY), cmp_entry);
+
+		// Directory on about log2(count) first bits, so that a range holds one or two keys
+		for (grp->dirBits = 0; grp->dirBits < bits && grp->dirBits < WL_MAX_DIR_BITS && (1U << (grp->dirBits + 1)) <= n; grp->dirBits++)
+			;
+		dirSize = (1U << grp->dirBits) + 1;
+		grp->dir = (uint32_t *)malloc(dirSize * sizeof(uint32_t));
+		if (!grp->dir)
+			return NUR_ERROR_GENERAL;
+		for (b = 0, i = 0; b < dirSize; b++) {
+			while (i < n && dir_index(grp, grp->entries[i].hi) < b)
+				i++;
+			grp->dir[b] = i;
+		}
+	}
+
+	// Bloom filter over all groups
+	for (words = 16; words * 32 < wl->addedCount * WL_BLOOM_BITS; words *= 2)
+		;
+	wl->bloom = (uint32_t *)calloc(words, sizeof(uint32_t));
+	if (!wl->bloom)
+		return NUR_ERROR_GENERAL;
+	wl->bloomMask = words - 1;
+
+	for (g = 0; g < wl->groupCount; g++)
+	{
+		struct WL_GROUP *grp = &wl->groups[g];
+		for (i = 0; i < grp->count; i++)
+		{
+			const struct WL_ENTRY *e = &grp->entries[i];
+			uint32_t h = wl_hash((uint32_t)(e->hi >> 32), (uint32_t)e->hi, (uint32_t)(e->lo >> 32), (uint32_t)e->lo, (uint32_t)grp->bits);
+			wl->bloom[h & wl->bloomMask] |= wl_bloom_bits(h);
+		}
+	}
+
+	wl->entryCount = wl->addedCount;
+	free(wl->added);
+	free(wl->addedBits);
+	wl->added = NULL;
+	wl->addedBits = NULL;
+	wl->compiled = 1;
+	if (!wl->isa)
+		watchlist_set_isa(wl, WATCHLIST_ISA_AUTO);
+
+	return NUR_SUCCESS;
+}
+
+int watchlist_set_isa(struct WATCHLIST *wl, int isa)
+{
+	int best = WATCHLIST_ISA_SCALAR;
+
+#ifdef WL_HAVE_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		best = WATCHLIST_ISA_AVX2;
+#endif
+
+	wl->isa = (isa == WATCHLIST_ISA_AUTO || isa > best) ? best : isa;
+	return wl->isa;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Bloom probes: bit n of result set when lane n may match grp
+
+// wl_hash() of lane n masked to grp, from the block's products
+static uint32_t wl_hash_block(const struct WL_GROUP *grp, const struct WL_BLOCK *blk, int n)
+{
+	uint32_t h = (uint32_t)grp->bits * WL_C4;
+	int i;
+
+	for (i = 0; i < grp->fullWords; i++)
+		h ^= blk->p[i][n];
+	if (grp->partWord >= 0)
+		h ^= (blk->w[grp->partWord][n] & grp->mask[grp->partWord]) * gWordMul[grp->partWord];
+	h ^= h >> 15;
+	h *= WL_M1;
+	h ^= h >> 12;
+	h *= WL_M2;
+	h ^= h >> 15;
+	return h;
+}
+
+static uint32_t probe_scalar(const struct WATCHLIST *wl, const struct WL_GROUP *grp, const struct WL_BLOCK *blk, int lanes)
+{
+	uint32_t result = 0;
+	int n;
+
+	for (n = 0; n < lanes; n++)
+	{
+		uint32_t h, bm;
+		if (blk->avail[n] < grp->bits)
+			continue;
+		h = wl_hash_block(grp, blk, n);
+		bm = wl_bloom_bits(h);
+		if ((wl->bloom[h & wl->bloomMask] & bm) == bm)
+			result |= 1U << n;
+	}
+	return result;
+}
+
+#ifdef WL_HAVE_X86
+
+// Hash of 8 lanes, as wl_hash()
+#define WL_MIX_AVX2(h) \
+	h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15)); \
+	h = _mm256_mullo_epi32(h, _mm256_set1_epi32((int)WL_M1)); \
+	h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 12)); \
+	h = _mm256_mullo_epi32(h, _mm256_set1_epi32((int)WL_M2)); \
+	h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+
+__attribute__((target("avx2")))
+static uint32_t probe_avx2(const struct WATCHLIST *wl, const struct WL_GROUP *grp, const struct WL_BLOCK *blk, int lanes)
+{
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i bit31 = _mm256_set1_epi32(31);
+	__m256i h = _mm256_set1_epi32((int)((uint32_t)grp->bits * WL_C4));
+	__m256i g, bm, words, ok;
+	int i;
+
+	(void)lanes;	// Unused lanes have avail 0
+	for (i = 0; i < grp->fullWords; i++)
+		h = _mm256_xor_si256(h, _mm256_loadu_si256((const __m256i *)blk->p[i]));
+	if ((i = grp->partWord) >= 0) {
+		__m256i w = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)blk->w[i]), _mm256_set1_epi32((int)grp->mask[i]));
+		h = _mm256_xor_si256(h, _mm256_mullo_epi32(w, _mm256_set1_epi32((int)gWordMul[i])));
+	}
+	WL_MIX_AVX2(h);
+
+	// Bloom word and its three bits, as wl_bloom_bits()
+	words = _mm256_i32gather_epi32((const int *)wl->bloom, _mm256_and_si256(h, _mm256_set1_epi32((int)wl->bloomMask)), 4);
+	g = _mm256_mullo_epi32(h, _mm256_set1_epi32((int)WL_C4));
+	bm = _mm256_or_si256(
+		_mm256_sllv_epi32(one, _mm256_srli_epi32(g, 27)),
+		_mm256_or_si256(
+			_mm256_sllv_epi32(one, _mm256_and_si256(_mm256_srli_epi32(g, 22), bit31)),
+			_mm256_sllv_epi32(one, _mm256_and_si256(_mm256_srli_epi32(g, 17), bit31))));
+
+	ok = _mm256_and_si256(
+		_mm256_cmpeq_epi32(_mm256_and_si256(words, bm), bm),
+		_mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i *)blk->avail), _mm256_set1_epi32(grp->bits - 1)));
+	return (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(ok));
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// Matching
+
+// Binary search in directory range, then report all entries with the key
+static uint32_t lookup(struct WL_GROUP *grp, const struct WL_BLOCK *blk, int lane, uint32_t tag,
+	struct WATCHLIST_HIT *hits, uint32_t maxHits, uint32_t found)
+{
+	uint64_t hi = (((uint64_t)blk->w[0][lane] << 32) | blk->w[1][lane]) & grp->maskHi;
+	uint64_t lo = (((uint64_t)blk->w[2][lane] << 32) | blk->w[3][lane]) & grp->maskLo;
+	uint32_t b = dir_index(grp, hi);
+	uint32_t first = grp->dir[b], last = grp->dir[b + 1];
+
+	while (first < last)
+	{
+		uint32_t mid = first + (last - first) / 2;
+		const struct WL_ENTRY *e = &grp->entries[mid];
+		if (e->hi < hi || (e->hi == hi && e->lo < lo))
+			first = mid + 1;
+		else
+			last = mid;
+	}
+
+	for (; first < grp->count && grp->entries[first].hi == hi && grp->entries[first].lo == lo; first++)
+	{
+		grp->entries[first].hits++;
+		if (found < maxHits) {
+			hits[found].tag = tag;
+			hits[found].id = grp->entries[first].id;
+		}
+		found++;
+	}
+	return found;
+}
+
+static void load_lane(struct WL_BLOCK *blk, int lane, const uint8_t *epc, uint8_t epcLen)
+{
+	uint8_t key[16];
+
+	if (epcLen >= 16) {
+		memcpy(key, epc, 16);
+	} else {
+		memset(key, 0, sizeof(key));
+		memcpy(key, epc, epcLen);
+	}
+	blk->w[0][lane] = be32(key);
+	blk->w[1][lane] = be32(key + 4);
+	blk->w[2][lane] = be32(key + 8);
+	blk->w[3][lane] = be32(key + 12);
+	blk->p[0][lane] = blk->w[0][lane] * WL_C0;
+	blk->p[1][lane] = blk->w[1][lane] * WL_C1;
+	blk->p[2][lane] = blk->w[2][lane] * WL_C2;
+	blk->p[3][lane] = blk->w[3][lane] * WL_C3;
+	blk->avail[lane] = epcLen * 8;
+}
+
+// EPCs either from pointer array or from batch buffer and offsets
+static uint32_t match(struct WATCHLIST *wl, const uint8_t *const *epcs, const uint8_t *buffer, const uint16_t *offsets,
+	const uint8_t *epcLens, uint32_t count, struct WATCHLIST_HIT *hits, uint32_t maxHits)
+{
+	struct WL_BLOCK blk;
+	uint32_t found = 0;
+	uint32_t base;
+
+	if (!wl->compiled)
+		return 0;
+
+	for (base = 0; base < count; base += WL_LANES)
+	{
+		int lanes = (count - base < WL_LANES) ? (int)(count - base) : WL_LANES;
+		int n, g;
+
+		for (n = 0; n < WL_LANES; n++) {
+			if (n < lanes)
+				load_lane(&blk, n, epcs ? epcs[base + n] : buffer + offsets[base + n], epcLens[base + n]);
+			else
+				blk.avail[n] = 0;
+		}
+
+		for (g = 0; g < wl->groupCount; g++)
+		{
+			struct WL_GROUP *grp = &wl->groups[g];
+			uint32_t cand;
+
+#ifdef WL_HAVE_X86
+			if (wl->isa == WATCHLIST_ISA_AVX2)
+				cand = probe_avx2(wl, grp, &blk, lanes);
+			else
+#endif
+				cand = probe_scalar(wl, grp, &blk, lanes);
+
+			while (cand)
+			{
+				n = __builtin_ctz(cand);
+				cand &= cand - 1;
+				found = lookup(grp, &blk, n, base + (uint32_t)n, hits, maxHits, found);
+			}
+		}
+	}
+	return found;
+}
+
+uint32_t watchlist_match(struct WATCHLIST *wl, const uint8_t *const *epcs, const uint8_t *epcLens, uint32_t count,
+	struct WATCHLIST_HIT *hits, uint32_t maxHits)
+{
+	return match(wl, epcs, NULL, NULL, epcLens, count, hits, maxHits);
+}
+
+uint32_t watchlist_match_batch(struct WATCHLIST *wl, const struct NUR_TAG_BATCH *batch, struct WATCHLIST_HIT *hits, uint32_t maxHits)
+{
+	return match(wl, NULL, batch->Buffer, batch->EpcOffset, batch->EpcLen, batch->Count, hits, maxHits);
+}
+
+uint32_t watchlist_hit_count(struct WATCHLIST *wl, uint32_t id)
+{
+	uint32_t i, sum = 0;
+	int g;
+
+	for (g = 0; g < wl->groupCount; g++)
+		for (i = 0; i < wl->groups[g].count; i++)
+			if (wl->groups[g].entries[i].id == id)
+				sum += wl->groups[g].entries[i].hits;
+	return sum;
+}
+
+void watchlist_info(struct WATCHLIST *wl, uint32_t *entries, uint32_t *lengths, uint32_t *bloomBytes)
+{
+	if (entries)
+		*entries = wl->compiled ? wl->entryCount : wl->addedCount;
+	if (lengths)
+		*lengths = (uint32_t)wl->groupCount;
+	if (bloomBytes)
+		*bloomBytes = wl->compiled ? (wl->bloomMask + 1) * 4 : 0;
+}
@@ -0,0 +1,92 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	Host side EPC watchlist matcher (Watchlist.c).
+
+	Entries are EPC prefixes: the first bitLen bits of the EPC, 1..WATCHLIST_MAX_BITS, as with
+	NUR_CMD_INVENTORYEX_FILTER on EPC bank address 32. A full EPC is an entry with bitLen = 8 * EPC length.
+	After watchlist_compile() entries are kept per prefix length as sorted keys with a directory on their
+	first bits (two level prefix trie), behind one Bloom filter for all lengths. EPCs are screened in batches;
+	the Bloom filter is probed 8 EPCs at a time when the CPU has AVX2.
+*/
+
+#ifndef _WATCHLIST_H_
+#define _WATCHLIST_H_	1
+
+#include <stdint.h>
+
+#define WATCHLIST_MAX_BITS	128
+
+/** Instruction set used by watchlist_match(). */
+enum WATCHLIST_ISA
+{
+	WATCHLIST_ISA_AUTO = 0,		/**< Best supported by the CPU */
+	WATCHLIST_ISA_SCALAR,
+	WATCHLIST_ISA_AVX2
+};
+
+/** One match: tag index in the batch and id of the entry given to watchlist_add(). */
+struct WATCHLIST_HIT
+{
+	uint32_t tag;
+	uint32_t id;
+};
+
+struct WATCHLIST;
+struct NUR_CMD_INVENTORYEX_FILTER;
+struct NUR_TAG_BATCH;
+
+struct WATCHLIST *watchlist_create(void);
+void watchlist_destroy(struct WATCHLIST *wl);
+
+/**
+ * Add prefix entry. Entries can be added until watchlist_compile(); the same prefix may be added with several ids.
+ * @param prefix	Prefix bytes, EPC order, bits after bitLen are ignored.
+ * @return	NUR_SUCCESS, NUR_ERROR_INVALID_PARAMETER for bitLen out of range or after compile, NUR_ERROR_GENERAL when out of memory.
+ */
+int watchlist_add(struct WATCHLIST *wl, const uint8_t *prefix, int bitLen, uint32_t id);
+
+/**
+ * Add inventory filter mask as entry; only EPC bank masks starting at EPC (bit address 32) are prefixes.
+ * @return	As watchlist_add().
+ */
+int watchlist_add_filter(struct WATCHLIST *wl, const struct NUR_CMD_INVENTORYEX_FILTER *filter, uint32_t id);
+
+/** Build lookup structures; no more entries can be added after this. @return NUR_SUCCESS or NUR_ERROR_GENERAL. */
+int watchlist_compile(struct WATCHLIST *wl);
+
+/** Select instruction set for benchmarking; unsupported ones fall back. @return The one that will be used. */
+int watchlist_set_isa(struct WATCHLIST *wl, int isa);
+
+/**
+ * Screen count EPCs. Each match is added to the entry's hit count and stored in hits while there is room.
+ * @param epcs		EPC byte pointers.
+ * @param epcLens	EPC lengths in bytes.
+ * @return	Number of matches, including those that did not fit in hits.
+ */
+uint32_t watchlist_match(struct WATCHLIST *wl, const uint8_t *const *epcs, const uint8_t *epcLens, uint32_t count,
+	struct WATCHLIST_HIT *hits, uint32_t maxHits);
+
+/** Screen the tags of a batch decoded with NurApiParseIdBufferBatch(). @return As watchlist_match(). */
+uint32_t watchlist_match_batch(struct WATCHLIST *wl, const struct NUR_TAG_BATCH *batch, struct WATCHLIST_HIT *hits, uint32_t maxHits);
+
+/** Times the entry with this id has matched. Ids added more than once are summed. */
+uint32_t watchlist_hit_count(struct WATCHLIST *wl, uint32_t id);
+
+/** Number of entries, prefix lengths and Bloom filter size in bytes after compile. */
+void watchlist_info(struct WATCHLIST *wl, uint32_t *entries, uint32_t *lengths, uint32_t *bloomBytes);
+
+#endif
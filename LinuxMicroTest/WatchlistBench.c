@@ -0,0 +1,295 @@
+/*
+	Copyright (c) 2017 Nordic ID.
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+	EPC watchlist (Watchlist.c) screening rate in EPCs/s for watchlists of 1k to 1M entries,
+	scalar and AVX2. Lists are mostly full 96-bit EPCs with some 28..64 bit prefixes of 8 lengths;
+	about 1% of the screened EPCs are on the list.
+	First checks all instruction sets against a plain compare of every EPC with every entry.
+
+	Usage: WatchlistBench [maxentries]
+*/
+
+#define _DEFAULT_SOURCE	1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "NurApiConfig.h"
+#include "NurMicroApi.h"
+#include "Watchlist.h"
+
+#define EPC_LEN		12
+#define BATCH		256			// EPCs per watchlist_match() call
+#define STREAM		1000000		// EPCs screened per run
+#define PREFIX_PCT	5			// Prefix entries out of 100
+
+// Prefix lengths of prefix entries, e.g. header, filter and company prefix of different SGTIN partitions
+static const int gPrefixBits[8] = { 28, 32, 36, 40, 44, 48, 56, 64 };
+
+static const char *gIsaName[] = { "auto", "scalar", "avx2" };
+
+static uint32_t gRng = 0x12345678;
+
+static uint32_t rnd(void)
+{
+	// xorshift32
+	gRng ^= gRng << 13;
+	gRng ^= gRng >> 17;
+	gRng ^= gRng << 5;
+	return gRng;
+}
+
+static double secs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void random_epc(uint8_t *epc)
+{
+	int b;
+	epc[0] = 0x30;
+	for (b = 1; b < EPC_LEN; b++)
+		epc[b] = (uint8_t)rnd();
+}
+
+struct LIST
+{
+	uint8_t *keys;		// EPC_LEN bytes per entry
+	int *bits;
+	int count;
+};
+
+static void make_list(struct LIST *list, int count)
+{
+	int i;
+
+	list->keys = (uint8_t *)malloc((size_t)count * EPC_LEN);
+	list->bits = (int *)malloc(count * sizeof(int));
+	list->count = count;
+	for (i = 0; i < count; i++) {
+		random_epc(&list->keys[i * EPC_LEN]);
+		list->bits[i] = ((int)(rnd() % 100) < PREFIX_PCT) ? gPrefixBits[rnd() % 8] : EPC_LEN * 8;
+	}
+}
+
+static struct WATCHLIST *compile_list(const struct LIST *list)
+{
+	struct WATCHLIST *wl = watchlist_create();
+	int i;
+
+	for (i = 0; i < list->count; i++) {
+		if (watchlist_add(wl, &list->keys[i * EPC_LEN], list->bits[i], (uint32_t)i) != NUR_SUCCESS)
+			return NULL;
+	}
+	return (watchlist_compile(wl) == NUR_SUCCESS) ? wl : NULL;
+}
+
+// Screened EPCs: every 100th a copy of a full EPC entry with its serial, rest random
+static void make_stream(const struct LIST *list, uint8_t *epcs, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		uint8_t *epc = &epcs[i * EPC_LEN];
+		int e = (int)(rnd() % (uint32_t)list->count);
+		if (i % 100 == 0 && list->bits[e] == EPC_LEN * 8)
+			memcpy(epc, &list->keys[e * EPC_LEN], EPC_LEN);
+		else
+			random_epc(epc);
+	}
+}
+
+static int prefix_match(const uint8_t *epc, const uint8_t *key, int bits)
+{
+	int full = bits / 8, rest = bits % 8;
+	if (memcmp(epc, key, full) != 0)
+		return 0;
+	return rest == 0 || ((epc[full] ^ key[full]) & (0xFF00 >> rest) & 0xFF) == 0;
+}
+
+static int cmp_hit(const void *a, const void *b)
+{
+	const struct WATCHLIST_HIT *x = (const struct WATCHLIST_HIT *)a, *y = (const struct WATCHLIST_HIT *)b;
+	if (x->tag != y->tag)
+		return (x->tag > y->tag) ? 1 : -1;
+	return (x->id > y->id) - (x->id < y->id);
+}
+
+static int check(void)
+{
+	const int listCount = 2000, epcCount = 20000;
+	struct LIST list;
+	struct WATCHLIST *wl;
+	struct NUR_CMD_INVENTORYEX_FILTER filter;
+	struct WATCHLIST_HIT *ref, *hits;
+	const uint8_t **ptrs;
+	uint8_t *epcs, *lens;
+	uint32_t refCount = 0, n, i;
+	int e, isa, passes = 0, ok = 1;
+
+	make_list(&list, listCount);
+	// Some short prefixes so that many EPCs hit more than one entry
+	for (e = 0; e < 20; e++)
+		list.bits[e] = 9 + e;
+	wl = compile_list(&list);
+	epcs = (uint8_t *)malloc((size_t)epcCount * EPC_LEN);
+	lens = (uint8_t *)malloc(epcCount);
+	ptrs = (const uint8_t **)malloc(epcCount * sizeof(*ptrs));
+	make_stream(&list, epcs, epcCount);
+	for (i = 0; i < (uint32_t)epcCount; i++) {
+		ptrs[i] = &epcs[i * EPC_LEN];
+		// A few short EPCs: entries longer than the EPC must not match
+		lens[i] = (i % 97 == 0) ? 4 : EPC_LEN;
+	}
+
+	ref = (struct WATCHLIST_HIT *)malloc(epcCount * 32 * sizeof(*ref));
+	hits = (struct WATCHLIST_HIT *)malloc(epcCount * 32 * sizeof(*hits));
+	for (i = 0; i < (uint32_t)epcCount; i++)
+		for (e = 0; e < listCount; e++)
+			if (list.bits[e] <= lens[i] * 8 && prefix_match(ptrs[i], &list.keys[e * EPC_LEN], list.bits[e])) {
+				ref[refCount].tag = i;
+				ref[refCount].id = (uint32_t)e;
+				refCount++;
+			}
+	qsort(ref, refCount, sizeof(*ref), cmp_hit);
+
+	for (isa = WATCHLIST_ISA_SCALAR; isa <= WATCHLIST_ISA_AVX2; isa++)
+	{
+		if (watchlist_set_isa(wl, isa) != isa) {
+			printf("check %-7s not supported\n", gIsaName[isa]);
+			continue;
+		}
+		n = watchlist_match(wl, ptrs, lens, epcCount, hits, epcCount * 32);
+		passes++;
+		qsort(hits, n, sizeof(*hits), cmp_hit);
+		if (n != refCount || memcmp(hits, ref, n * sizeof(*hits)) != 0) {
+			printf("check %-7s FAILED: %u matches, expected %u\n", gIsaName[isa], n, refCount);
+			ok = 0;
+		} else {
+			printf("check %-7s ok, %u matches\n", gIsaName[isa], n);
+		}
+	}
+	if (ok && watchlist_hit_count(wl, 0) != 0) {
+		// Each pass counted the same matches
+		for (i = 0, n = 0; i < refCount; i++)
+			n += (ref[i].id == 0);
+		if (watchlist_hit_count(wl, 0) != passes * n) {
+			printf("check hit count FAILED\n");
+			ok = 0;
+		}
+	}
+	watchlist_destroy(wl);
+
+	// Filter masks: EPC bank at address 32 only
+	wl = watchlist_create();
+	memset(&filter, 0, sizeof(filter));
+	filter.bank = NUR_BANK_EPC;
+	filter.address = 32;
+	filter.maskbitlen = 12;
+	filter.maskdata[0] = 0x30;
+	filter.maskdata[1] = 0x1F;		// Last 4 bits ignored
+	if (watchlist_add_filter(wl, &filter, 7) != NUR_SUCCESS || watchlist_compile(wl) != NUR_SUCCESS) {
+		printf("check filter FAILED\n");
+		ok = 0;
+	} else {
+		static const uint8_t in[EPC_LEN] = { 0x30, 0x12 }, out[EPC_LEN] = { 0x30, 0x22 };
+		const uint8_t *p[2] = { in, out };
+		uint8_t l[2] = { EPC_LEN, EPC_LEN };
+		if (watchlist_match(wl, p, l, 2, hits, 2) != 1 || hits[0].tag != 0 || hits[0].id != 7) {
+			printf("check filter FAILED\n");
+			ok = 0;
+		}
+	}
+	filter.address = 0;
+	if (watchlist_add_filter(wl, &filter, 8) != NUR_ERROR_INVALID_PARAMETER) {
+		printf("check filter address FAILED\n");
+		ok = 0;
+	}
+	watchlist_destroy(wl);
+
+	free(list.keys);
+	free(list.bits);
+	free(epcs);
+	free(lens);
+	free(ptrs);
+	free(ref);
+	free(hits);
+	return ok;
+}
+
+static void bench(int count)
+{
+	struct LIST list;
+	struct WATCHLIST *wl;
+	struct WATCHLIST_HIT hits[BATCH * 2];
+	const uint8_t **ptrs;
+	uint8_t *epcs, lens[BATCH];
+	uint32_t entries, lengths, bloomBytes, matches;
+	double t, tBuild;
+	int i, isa;
+
+	make_list(&list, count);
+	tBuild = secs();
+	wl = compile_list(&list);
+	tBuild = secs() - tBuild;
+	if (!wl) {
+		printf("%d entries: out of memory\n", count);
+		return;
+	}
+	watchlist_info(wl, &entries, &lengths, &bloomBytes);
+	printf("%u entries, %u prefix lengths, bloom %u kB, compile %.0f ms\n", entries, lengths, bloomBytes / 1024, tBuild * 1e3);
+
+	epcs = (uint8_t *)malloc((size_t)STREAM * EPC_LEN);
+	ptrs = (const uint8_t **)malloc(STREAM * sizeof(*ptrs));
+	make_stream(&list, epcs, STREAM);
+	for (i = 0; i < STREAM; i++)
+		ptrs[i] = &epcs[i * EPC_LEN];
+	memset(lens, EPC_LEN, sizeof(lens));
+
+	for (isa = WATCHLIST_ISA_SCALAR; isa <= WATCHLIST_ISA_AVX2; isa++)
+	{
+		if (watchlist_set_isa(wl, isa) != isa)
+			continue;
+		matches = 0;
+		t = secs();
+		for (i = 0; i < STREAM; i += BATCH)
+			matches += watchlist_match(wl, &ptrs[i], lens, (STREAM - i < BATCH) ? STREAM - i : BATCH, hits, BATCH * 2);
+		t = secs() - t;
+		printf("  %-7s %7.1f M EPC/s  (%.1f ns)  %u matches\n", gIsaName[isa], STREAM / t / 1e6, t * 1e9 / STREAM, matches);
+	}
+
+	watchlist_destroy(wl);
+	free(list.keys);
+	free(list.bits);
+	free(epcs);
+	free(ptrs);
+}
+
+int main(int argc, char **argv)
+{
+	int maxEntries = (argc > 1) ? atoi(argv[1]) : 1000000;
+	int count;
+
+	if (!check())
+		return 1;
+	for (count = 1000; count <= maxEntries; count *= 10)
+		bench(count);
+	return 0;
+}
@@ -25,6 +25,8 @@
 
 // This is anything that the serial transport requires to have; here it is the HANDLE returned by the Win32 API.
 static HANDLE gSerial = INVALID_HANDLE_VALUE;
+// Currently configured read timeout (COMMTIMEOUTS.ReadTotalTimeoutConstant)
+static DWORD gReadTimeout = 0;
 
 static int serial_read(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesRead);
 static int serial_write(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesWritten);
@@ -71,6 +73,7 @@ int32_t open_serial(struct NUR_API_HANDLE *hApi, int number, uint32_t baudrate)
 	to.WriteTotalTimeoutMultiplier = 1;
 	to.WriteTotalTimeoutConstant = 1;
 	SetCommTimeouts(gSerial, &to);
+	gReadTimeout = to.ReadTotalTimeoutConstant;
 
 	hApi->TransportReadDataFunction = (pTransportReadDataFunction)serial_read;
 	hApi->TransportWriteDataFunction = (pTransportWriteDataFunction)serial_write;
@@ -96,6 +99,20 @@ static int serial_read(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t
 	if (gSerial == INVALID_HANDLE_VALUE)
 		return NUR_ERROR_TR_NOT_CONNECTED;
 
+	// Block until first byte arrives or API deadline passes, zero timeout does not block.
+	// With ReadIntervalTimeout MAXDWORD, ReadFile returns as soon as any data is available.
+	if (hNurApi->TransportReadTimeout != gReadTimeout)
+	{
+		COMMTIMEOUTS to;
+		if (GetCommTimeouts(gSerial, &to)) {
+			to.ReadTotalTimeoutMultiplier = (hNurApi->TransportReadTimeout > 0) ? MAXDWORD : 0;
+			to.ReadTotalTimeoutConstant = hNurApi->TransportReadTimeout;
+			if (SetCommTimeouts(gSerial, &to)) {
+				gReadTimeout = to.ReadTotalTimeoutConstant;
+			}
+		}
+	}
+
 	if (!ReadFile(gSerial, buffer, bufferLen, &dwRead, NULL))
 	{
 		dwError = GetLastError();
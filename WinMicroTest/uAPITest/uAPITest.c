@@ -54,7 +54,22 @@ static struct NUR_API_HANDLE gApi =
 	0,		// uint32_t RxBufferUsed;
 
 	0,		// uint32_t respLen;
-	NULL	// struct NUR_CMD_RESP *resp;
+	NULL,	// struct NUR_CMD_RESP *resp;
+
+	0,		// uint8_t RxPacketState;
+	0,		// uint16_t RxPayloadCRC;
+	0,		// uint32_t RxPayloadCRCPos;
+	0,		// uint32_t Flags;
+
+	NULL,	// GetTickCountFunction
+	0,		// uint32_t TransportReadTimeout;
+	NULL,	// TransportWriteVecFunction
+	NULL,	// UnsolQueue
+	NULL,	// Stats
+	NULL,	// XchTraceFunction
+	NULL	// InvStream
+
+	// Rest is API internal exchange state
 };
 
 static struct NUR_API_HANDLE *hApi = &gApi;
@@ -259,6 +274,11 @@ static int NurApiProgramBootloaderFile(struct NUR_API_HANDLE *hNurApi, const cha
 	return error;
 }
 
+static uint32_t GetTicks(struct NUR_API_HANDLE *hApi)
+{
+	return GetTickCount();
+}
+
 int InitNurApiHandle(struct NUR_API_HANDLE *hApi)
 {
 	// Init RX buffer
@@ -271,6 +291,9 @@ int InitNurApiHandle(struct NUR_API_HANDLE *hApi)
 
 	hApi->UnsolEventHandler = UnsolEventHandler;
 
+	// Timeouts are real milliseconds
+	hApi->GetTickCountFunction = GetTicks;
+
 	return hApi->RxBufferLen;
 }
 
@@ -23,6 +23,48 @@
 #define DEF_TIMEOUT 3000
 #define DEF_LONG_TIMEOUT 10000
 
+// Maximum number of commands in flight per handle, see NurApiXchStart().
+// Each additional slot takes about 16 bytes in struct NUR_API_HANDLE.
+// Changes layout of struct NUR_API_HANDLE: when changed, include this file before NurMicroApi.h everywhere.
+#define NUR_XCH_WINDOW	4
+
+// Uncomment to include link statistics (hNurApi->Stats, NurApiGetLinkStats()).
+//#define CONFIG_LINK_STATS
+
+// Uncomment to include exchange tracing (hNurApi->XchTraceFunction).
+//#define CONFIG_XCH_TRACE
+
+// Uncomment to include inventory streaming (NurApiStartInventoryStream()).
+//#define CONFIG_INVENTORY_STREAM
+
+// Uncomment to include the unsolicited packet queue (NurApiUnsolQueueInit()).
+//#define CONFIG_UNSOL_QUEUE
+
+// Uncomment to include the EPC deduplication table (NurApiTagTableInit()).
+//#define CONFIG_TAG_TABLE
+
+// With CONFIG_TAG_TABLE or CONFIG_PRESENCE: longest EPC in bytes kept in struct NUR_TAG_ENTRY and struct NUR_PRESENCE_TAG, multiple of 4.
+// Tags with longer EPCs are not added. Changes layout of both structs.
+#define NUR_TAGTABLE_MAX_EPC	32
+
+// Uncomment to include the tag record arena (NurApiTagArenaInit()).
+//#define CONFIG_TAG_ARENA
+
+// Uncomment to include the struct-of-arrays tag parser (NurApiParseIdBufferBatch()).
+//#define CONFIG_TAG_BATCH
+
+// Uncomment to include the tag presence tracker (NurApiPresenceInit()).
+//#define CONFIG_PRESENCE
+
+// With CONFIG_PRESENCE: timing wheel slots in struct NUR_PRESENCE, at least 4. Departures are reported
+// up to Timeout / (slots - 2) late. Changes layout of struct NUR_PRESENCE.
+#define NUR_PRESENCE_WHEEL_SLOTS	64
+
+// Memory fences for the unsolicited packet queue; defaults exist for GCC, Clang and MSVC.
+// Single core targets where the consumer does not run concurrently on another core can use empty ones.
+//#define NUR_RELEASE_FENCE()
+//#define NUR_ACQUIRE_FENCE()
+
 // Comment out to use 'memset' instead.
 #define HAVE_NUR_MEMSET
 
@@ -45,8 +87,16 @@
 #define CONFIG_GENERIC_WRITE
 
 // Comment out to use calculation instead of lookup with CRC-16.
+// Lookup tables are constant (ROM), 512 bytes per slice.
 //#define HAVE_CRC16_LOOKUP
 
+// With HAVE_CRC16_LOOKUP: number of bytes handled per lookup step; 1, 4 or 8 (slice-by-N).
+//#define CRC16_LOOKUP_SLICES	8
+
+// With HAVE_CRC16_LOOKUP: use carry-less multiply (PCLMULQDQ) for long buffers on x86-64.
+// CPU support is checked at run-time; lookup is used when not supported.
+//#define HAVE_CRC16_PCLMUL
+
 // Comment out to leave out error messages.
 //#define HAVE_ERROR_MESSAGES
 
@@ -153,40 +153,438 @@ const char * NURAPICONV NurApiGetErrorMessage(int error)
 
 #endif
 
+#define CRC16_START				0xFFFF
+
 #ifdef IMPLEMENT_CRC16
 
-#define CRC16_START				0xFFFF
 #define MSG_CCITT_CRC_POLY		0x1021
 
 #ifdef HAVE_CRC16_LOOKUP
 
-static uint16_t crctable[256];
-static int32_t init = FALSE;
+#ifndef CRC16_LOOKUP_SLICES
+#define CRC16_LOOKUP_SLICES		1
+#endif
+
+#if CRC16_LOOKUP_SLICES != 1 && CRC16_LOOKUP_SLICES != 4 && CRC16_LOOKUP_SLICES != 8
+#error "CRC16_LOOKUP_SLICES must be 1, 4 or 8"
+#endif
 
-static uint16_t NurCRC16(uint16_t crc, uint8_t *buf, uint32_t len)
+/*
+	crc16Table[n][v] is the CRC of byte v followed by n zero bytes.
+	Row 0 is the classic byte-at-a-time table, other rows are used for slicing.
+	Tables are constant so they can live in ROM and need no run-time initialization.
+*/
+static const uint16_t crc16Table[CRC16_LOOKUP_SLICES][256] =
 {
-	if (!init)
 	{
-		int i, j;
-		uint32_t c;
-
-		for (i = 0; i < 256; i++) {
-			c = i << 8;
-			for ( j = 0; j < 8; j++ ) {
-				c = (c & 0x8000) ? MSG_CCITT_CRC_POLY ^ (c << 1) : (c << 1);
-			}
-			crctable[i] = (uint16_t)c;
-		}
+		0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+		0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+		0x1231, 0x0210, 0x3273, 0x2252, 0x52b5, 0x4294, 0x72f7, 0x62d6,
+		0x9339, 0x8318, 0xb37b, 0xa35a, 0xd3bd, 0xc39c, 0xf3ff, 0xe3de,
+		0x2462, 0x3443, 0x0420, 0x1401, 0x64e6, 0x74c7, 0x44a4, 0x5485,
+		0xa56a, 0xb54b, 0x8528, 0x9509, 0xe5ee, 0xf5cf, 0xc5ac, 0xd58d,
+		0x3653, 0x2672, 0x1611, 0x0630, 0x76d7, 0x66f6, 0x5695, 0x46b4,
+		0xb75b, 0xa77a, 0x9719, 0x8738, 0xf7df, 0xe7fe, 0xd79d, 0xc7bc,
+		0x48c4, 0x58e5, 0x6886, 0x78a7, 0x0840, 0x1861, 0x2802, 0x3823,
+		0xc9cc, 0xd9ed, 0xe98e, 0xf9af, 0x8948, 0x9969, 0xa90a, 0xb92b,
+		0x5af5, 0x4ad4, 0x7ab7, 0x6a96, 0x1a71, 0x0a50, 0x3a33, 0x2a12,
+		0xdbfd, 0xcbdc, 0xfbbf, 0xeb9e, 0x9b79, 0x8b58, 0xbb3b, 0xab1a,
+		0x6ca6, 0x7c87, 0x4ce4, 0x5cc5, 0x2c22, 0x3c03, 0x0c60, 0x1c41,
+		0xedae, 0xfd8f, 0xcdec, 0xddcd, 0xad2a, 0xbd0b, 0x8d68, 0x9d49,
+		0x7e97, 0x6eb6, 0x5ed5, 0x4ef4, 0x3e13, 0x2e32, 0x1e51, 0x0e70,
+		0xff9f, 0xefbe, 0xdfdd, 0xcffc, 0xbf1b, 0xaf3a, 0x9f59, 0x8f78,
+		0x9188, 0x81a9, 0xb1ca, 0xa1eb, 0xd10c, 0xc12d, 0xf14e, 0xe16f,
+		0x1080, 0x00a1, 0x30c2, 0x20e3, 0x5004, 0x4025, 0x7046, 0x6067,
+		0x83b9, 0x9398, 0xa3fb, 0xb3da, 0xc33d, 0xd31c, 0xe37f, 0xf35e,
+		0x02b1, 0x1290, 0x22f3, 0x32d2, 0x4235, 0x5214, 0x6277, 0x7256,
+		0xb5ea, 0xa5cb, 0x95a8, 0x8589, 0xf56e, 0xe54f, 0xd52c, 0xc50d,
+		0x34e2, 0x24c3, 0x14a0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+		0xa7db, 0xb7fa, 0x8799, 0x97b8, 0xe75f, 0xf77e, 0xc71d, 0xd73c,
+		0x26d3, 0x36f2, 0x0691, 0x16b0, 0x6657, 0x7676, 0x4615, 0x5634,
+		0xd94c, 0xc96d, 0xf90e, 0xe92f, 0x99c8, 0x89e9, 0xb98a, 0xa9ab,
+		0x5844, 0x4865, 0x7806, 0x6827, 0x18c0, 0x08e1, 0x3882, 0x28a3,
+		0xcb7d, 0xdb5c, 0xeb3f, 0xfb1e, 0x8bf9, 0x9bd8, 0xabbb, 0xbb9a,
+		0x4a75, 0x5a54, 0x6a37, 0x7a16, 0x0af1, 0x1ad0, 0x2ab3, 0x3a92,
+		0xfd2e, 0xed0f, 0xdd6c, 0xcd4d, 0xbdaa, 0xad8b, 0x9de8, 0x8dc9,
+		0x7c26, 0x6c07, 0x5c64, 0x4c45, 0x3ca2, 0x2c83, 0x1ce0, 0x0cc1,
+		0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8,
+		0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0,
+	},
+#if CRC16_LOOKUP_SLICES > 1
+	{
+		0x0000, 0x3331, 0x6662, 0x5553, 0xccc4, 0xfff5, 0xaaa6, 0x9997,
+		0x89a9, 0xba98, 0xefcb, 0xdcfa, 0x456d, 0x765c, 0x230f, 0x103e,
+		0x0373, 0x3042, 0x6511, 0x5620, 0xcfb7, 0xfc86, 0xa9d5, 0x9ae4,
+		0x8ada, 0xb9eb, 0xecb8, 0xdf89, 0x461e, 0x752f, 0x207c, 0x134d,
+		0x06e6, 0x35d7, 0x6084, 0x53b5, 0xca22, 0xf913, 0xac40, 0x9f71,
+		0x8f4f, 0xbc7e, 0xe92d, 0xda1c, 0x438b, 0x70ba, 0x25e9, 0x16d8,
+		0x0595, 0x36a4, 0x63f7, 0x50c6, 0xc951, 0xfa60, 0xaf33, 0x9c02,
+		0x8c3c, 0xbf0d, 0xea5e, 0xd96f, 0x40f8, 0x73c9, 0x269a, 0x15ab,
+		0x0dcc, 0x3efd, 0x6bae, 0x589f, 0xc108, 0xf239, 0xa76a, 0x945b,
+		0x8465, 0xb754, 0xe207, 0xd136, 0x48a1, 0x7b90, 0x2ec3, 0x1df2,
+		0x0ebf, 0x3d8e, 0x68dd, 0x5bec, 0xc27b, 0xf14a, 0xa419, 0x9728,
+		0x8716, 0xb427, 0xe174, 0xd245, 0x4bd2, 0x78e3, 0x2db0, 0x1e81,
+		0x0b2a, 0x381b, 0x6d48, 0x5e79, 0xc7ee, 0xf4df, 0xa18c, 0x92bd,
+		0x8283, 0xb1b2, 0xe4e1, 0xd7d0, 0x4e47, 0x7d76, 0x2825, 0x1b14,
+		0x0859, 0x3b68, 0x6e3b, 0x5d0a, 0xc49d, 0xf7ac, 0xa2ff, 0x91ce,
+		0x81f0, 0xb2c1, 0xe792, 0xd4a3, 0x4d34, 0x7e05, 0x2b56, 0x1867,
+		0x1b98, 0x28a9, 0x7dfa, 0x4ecb, 0xd75c, 0xe46d, 0xb13e, 0x820f,
+		0x9231, 0xa100, 0xf453, 0xc762, 0x5ef5, 0x6dc4, 0x3897, 0x0ba6,
+		0x18eb, 0x2bda, 0x7e89, 0x4db8, 0xd42f, 0xe71e, 0xb24d, 0x817c,
+		0x9142, 0xa273, 0xf720, 0xc411, 0x5d86, 0x6eb7, 0x3be4, 0x08d5,
+		0x1d7e, 0x2e4f, 0x7b1c, 0x482d, 0xd1ba, 0xe28b, 0xb7d8, 0x84e9,
+		0x94d7, 0xa7e6, 0xf2b5, 0xc184, 0x5813, 0x6b22, 0x3e71, 0x0d40,
+		0x1e0d, 0x2d3c, 0x786f, 0x4b5e, 0xd2c9, 0xe1f8, 0xb4ab, 0x879a,
+		0x97a4, 0xa495, 0xf1c6, 0xc2f7, 0x5b60, 0x6851, 0x3d02, 0x0e33,
+		0x1654, 0x2565, 0x7036, 0x4307, 0xda90, 0xe9a1, 0xbcf2, 0x8fc3,
+		0x9ffd, 0xaccc, 0xf99f, 0xcaae, 0x5339, 0x6008, 0x355b, 0x066a,
+		0x1527, 0x2616, 0x7345, 0x4074, 0xd9e3, 0xead2, 0xbf81, 0x8cb0,
+		0x9c8e, 0xafbf, 0xfaec, 0xc9dd, 0x504a, 0x637b, 0x3628, 0x0519,
+		0x10b2, 0x2383, 0x76d0, 0x45e1, 0xdc76, 0xef47, 0xba14, 0x8925,
+		0x991b, 0xaa2a, 0xff79, 0xcc48, 0x55df, 0x66ee, 0x33bd, 0x008c,
+		0x13c1, 0x20f0, 0x75a3, 0x4692, 0xdf05, 0xec34, 0xb967, 0x8a56,
+		0x9a68, 0xa959, 0xfc0a, 0xcf3b, 0x56ac, 0x659d, 0x30ce, 0x03ff,
+	},
+	{
+		0x0000, 0x3730, 0x6e60, 0x5950, 0xdcc0, 0xebf0, 0xb2a0, 0x8590,
+		0xa9a1, 0x9e91, 0xc7c1, 0xf0f1, 0x7561, 0x4251, 0x1b01, 0x2c31,
+		0x4363, 0x7453, 0x2d03, 0x1a33, 0x9fa3, 0xa893, 0xf1c3, 0xc6f3,
+		0xeac2, 0xddf2, 0x84a2, 0xb392, 0x3602, 0x0132, 0x5862, 0x6f52,
+		0x86c6, 0xb1f6, 0xe8a6, 0xdf96, 0x5a06, 0x6d36, 0x3466, 0x0356,
+		0x2f67, 0x1857, 0x4107, 0x7637, 0xf3a7, 0xc497, 0x9dc7, 0xaaf7,
+		0xc5a5, 0xf295, 0xabc5, 0x9cf5, 0x1965, 0x2e55, 0x7705, 0x4035,
+		0x6c04, 0x5b34, 0x0264, 0x3554, 0xb0c4, 0x87f4, 0xdea4, 0xe994,
+		0x1dad, 0x2a9d, 0x73cd, 0x44fd, 0xc16d, 0xf65d, 0xaf0d, 0x983d,
+		0xb40c, 0x833c, 0xda6c, 0xed5c, 0x68cc, 0x5ffc, 0x06ac, 0x319c,
+		0x5ece, 0x69fe, 0x30ae, 0x079e, 0x820e, 0xb53e, 0xec6e, 0xdb5e,
+		0xf76f, 0xc05f, 0x990f, 0xae3f, 0x2baf, 0x1c9f, 0x45cf, 0x72ff,
+		0x9b6b, 0xac5b, 0xf50b, 0xc23b, 0x47ab, 0x709b, 0x29cb, 0x1efb,
+		0x32ca, 0x05fa, 0x5caa, 0x6b9a, 0xee0a, 0xd93a, 0x806a, 0xb75a,
+		0xd808, 0xef38, 0xb668, 0x8158, 0x04c8, 0x33f8, 0x6aa8, 0x5d98,
+		0x71a9, 0x4699, 0x1fc9, 0x28f9, 0xad69, 0x9a59, 0xc309, 0xf439,
+		0x3b5a, 0x0c6a, 0x553a, 0x620a, 0xe79a, 0xd0aa, 0x89fa, 0xbeca,
+		0x92fb, 0xa5cb, 0xfc9b, 0xcbab, 0x4e3b, 0x790b, 0x205b, 0x176b,
+		0x7839, 0x4f09, 0x1659, 0x2169, 0xa4f9, 0x93c9, 0xca99, 0xfda9,
+		0xd198, 0xe6a8, 0xbff8, 0x88c8, 0x0d58, 0x3a68, 0x6338, 0x5408,
+		0xbd9c, 0x8aac, 0xd3fc, 0xe4cc, 0x615c, 0x566c, 0x0f3c, 0x380c,
+		0x143d, 0x230d, 0x7a5d, 0x4d6d, 0xc8fd, 0xffcd, 0xa69d, 0x91ad,
+		0xfeff, 0xc9cf, 0x909f, 0xa7af, 0x223f, 0x150f, 0x4c5f, 0x7b6f,
+		0x575e, 0x606e, 0x393e, 0x0e0e, 0x8b9e, 0xbcae, 0xe5fe, 0xd2ce,
+		0x26f7, 0x11c7, 0x4897, 0x7fa7, 0xfa37, 0xcd07, 0x9457, 0xa367,
+		0x8f56, 0xb866, 0xe136, 0xd606, 0x5396, 0x64a6, 0x3df6, 0x0ac6,
+		0x6594, 0x52a4, 0x0bf4, 0x3cc4, 0xb954, 0x8e64, 0xd734, 0xe004,
+		0xcc35, 0xfb05, 0xa255, 0x9565, 0x10f5, 0x27c5, 0x7e95, 0x49a5,
+		0xa031, 0x9701, 0xce51, 0xf961, 0x7cf1, 0x4bc1, 0x1291, 0x25a1,
+		0x0990, 0x3ea0, 0x67f0, 0x50c0, 0xd550, 0xe260, 0xbb30, 0x8c00,
+		0xe352, 0xd462, 0x8d32, 0xba02, 0x3f92, 0x08a2, 0x51f2, 0x66c2,
+		0x4af3, 0x7dc3, 0x2493, 0x13a3, 0x9633, 0xa103, 0xf853, 0xcf63,
+	},
+	{
+		0x0000, 0x76b4, 0xed68, 0x9bdc, 0xcaf1, 0xbc45, 0x2799, 0x512d,
+		0x85c3, 0xf377, 0x68ab, 0x1e1f, 0x4f32, 0x3986, 0xa25a, 0xd4ee,
+		0x1ba7, 0x6d13, 0xf6cf, 0x807b, 0xd156, 0xa7e2, 0x3c3e, 0x4a8a,
+		0x9e64, 0xe8d0, 0x730c, 0x05b8, 0x5495, 0x2221, 0xb9fd, 0xcf49,
+		0x374e, 0x41fa, 0xda26, 0xac92, 0xfdbf, 0x8b0b, 0x10d7, 0x6663,
+		0xb28d, 0xc439, 0x5fe5, 0x2951, 0x787c, 0x0ec8, 0x9514, 0xe3a0,
+		0x2ce9, 0x5a5d, 0xc181, 0xb735, 0xe618, 0x90ac, 0x0b70, 0x7dc4,
+		0xa92a, 0xdf9e, 0x4442, 0x32f6, 0x63db, 0x156f, 0x8eb3, 0xf807,
+		0x6e9c, 0x1828, 0x83f4, 0xf540, 0xa46d, 0xd2d9, 0x4905, 0x3fb1,
+		0xeb5f, 0x9deb, 0x0637, 0x7083, 0x21ae, 0x571a, 0xccc6, 0xba72,
+		0x753b, 0x038f, 0x9853, 0xeee7, 0xbfca, 0xc97e, 0x52a2, 0x2416,
+		0xf0f8, 0x864c, 0x1d90, 0x6b24, 0x3a09, 0x4cbd, 0xd761, 0xa1d5,
+		0x59d2, 0x2f66, 0xb4ba, 0xc20e, 0x9323, 0xe597, 0x7e4b, 0x08ff,
+		0xdc11, 0xaaa5, 0x3179, 0x47cd, 0x16e0, 0x6054, 0xfb88, 0x8d3c,
+		0x4275, 0x34c1, 0xaf1d, 0xd9a9, 0x8884, 0xfe30, 0x65ec, 0x1358,
+		0xc7b6, 0xb102, 0x2ade, 0x5c6a, 0x0d47, 0x7bf3, 0xe02f, 0x969b,
+		0xdd38, 0xab8c, 0x3050, 0x46e4, 0x17c9, 0x617d, 0xfaa1, 0x8c15,
+		0x58fb, 0x2e4f, 0xb593, 0xc327, 0x920a, 0xe4be, 0x7f62, 0x09d6,
+		0xc69f, 0xb02b, 0x2bf7, 0x5d43, 0x0c6e, 0x7ada, 0xe106, 0x97b2,
+		0x435c, 0x35e8, 0xae34, 0xd880, 0x89ad, 0xff19, 0x64c5, 0x1271,
+		0xea76, 0x9cc2, 0x071e, 0x71aa, 0x2087, 0x5633, 0xcdef, 0xbb5b,
+		0x6fb5, 0x1901, 0x82dd, 0xf469, 0xa544, 0xd3f0, 0x482c, 0x3e98,
+		0xf1d1, 0x8765, 0x1cb9, 0x6a0d, 0x3b20, 0x4d94, 0xd648, 0xa0fc,
+		0x7412, 0x02a6, 0x997a, 0xefce, 0xbee3, 0xc857, 0x538b, 0x253f,
+		0xb3a4, 0xc510, 0x5ecc, 0x2878, 0x7955, 0x0fe1, 0x943d, 0xe289,
+		0x3667, 0x40d3, 0xdb0f, 0xadbb, 0xfc96, 0x8a22, 0x11fe, 0x674a,
+		0xa803, 0xdeb7, 0x456b, 0x33df, 0x62f2, 0x1446, 0x8f9a, 0xf92e,
+		0x2dc0, 0x5b74, 0xc0a8, 0xb61c, 0xe731, 0x9185, 0x0a59, 0x7ced,
+		0x84ea, 0xf25e, 0x6982, 0x1f36, 0x4e1b, 0x38af, 0xa373, 0xd5c7,
+		0x0129, 0x779d, 0xec41, 0x9af5, 0xcbd8, 0xbd6c, 0x26b0, 0x5004,
+		0x9f4d, 0xe9f9, 0x7225, 0x0491, 0x55bc, 0x2308, 0xb8d4, 0xce60,
+		0x1a8e, 0x6c3a, 0xf7e6, 0x8152, 0xd07f, 0xa6cb, 0x3d17, 0x4ba3,
+	},
+#endif
+#if CRC16_LOOKUP_SLICES > 4
+	{
+		0x0000, 0xaa51, 0x4483, 0xeed2, 0x8906, 0x2357, 0xcd85, 0x67d4,
+		0x022d, 0xa87c, 0x46ae, 0xecff, 0x8b2b, 0x217a, 0xcfa8, 0x65f9,
+		0x045a, 0xae0b, 0x40d9, 0xea88, 0x8d5c, 0x270d, 0xc9df, 0x638e,
+		0x0677, 0xac26, 0x42f4, 0xe8a5, 0x8f71, 0x2520, 0xcbf2, 0x61a3,
+		0x08b4, 0xa2e5, 0x4c37, 0xe666, 0x81b2, 0x2be3, 0xc531, 0x6f60,
+		0x0a99, 0xa0c8, 0x4e1a, 0xe44b, 0x839f, 0x29ce, 0xc71c, 0x6d4d,
+		0x0cee, 0xa6bf, 0x486d, 0xe23c, 0x85e8, 0x2fb9, 0xc16b, 0x6b3a,
+		0x0ec3, 0xa492, 0x4a40, 0xe011, 0x87c5, 0x2d94, 0xc346, 0x6917,
+		0x1168, 0xbb39, 0x55eb, 0xffba, 0x986e, 0x323f, 0xdced, 0x76bc,
+		0x1345, 0xb914, 0x57c6, 0xfd97, 0x9a43, 0x3012, 0xdec0, 0x7491,
+		0x1532, 0xbf63, 0x51b1, 0xfbe0, 0x9c34, 0x3665, 0xd8b7, 0x72e6,
+		0x171f, 0xbd4e, 0x539c, 0xf9cd, 0x9e19, 0x3448, 0xda9a, 0x70cb,
+		0x19dc, 0xb38d, 0x5d5f, 0xf70e, 0x90da, 0x3a8b, 0xd459, 0x7e08,
+		0x1bf1, 0xb1a0, 0x5f72, 0xf523, 0x92f7, 0x38a6, 0xd674, 0x7c25,
+		0x1d86, 0xb7d7, 0x5905, 0xf354, 0x9480, 0x3ed1, 0xd003, 0x7a52,
+		0x1fab, 0xb5fa, 0x5b28, 0xf179, 0x96ad, 0x3cfc, 0xd22e, 0x787f,
+		0x22d0, 0x8881, 0x6653, 0xcc02, 0xabd6, 0x0187, 0xef55, 0x4504,
+		0x20fd, 0x8aac, 0x647e, 0xce2f, 0xa9fb, 0x03aa, 0xed78, 0x4729,
+		0x268a, 0x8cdb, 0x6209, 0xc858, 0xaf8c, 0x05dd, 0xeb0f, 0x415e,
+		0x24a7, 0x8ef6, 0x6024, 0xca75, 0xada1, 0x07f0, 0xe922, 0x4373,
+		0x2a64, 0x8035, 0x6ee7, 0xc4b6, 0xa362, 0x0933, 0xe7e1, 0x4db0,
+		0x2849, 0x8218, 0x6cca, 0xc69b, 0xa14f, 0x0b1e, 0xe5cc, 0x4f9d,
+		0x2e3e, 0x846f, 0x6abd, 0xc0ec, 0xa738, 0x0d69, 0xe3bb, 0x49ea,
+		0x2c13, 0x8642, 0x6890, 0xc2c1, 0xa515, 0x0f44, 0xe196, 0x4bc7,
+		0x33b8, 0x99e9, 0x773b, 0xdd6a, 0xbabe, 0x10ef, 0xfe3d, 0x546c,
+		0x3195, 0x9bc4, 0x7516, 0xdf47, 0xb893, 0x12c2, 0xfc10, 0x5641,
+		0x37e2, 0x9db3, 0x7361, 0xd930, 0xbee4, 0x14b5, 0xfa67, 0x5036,
+		0x35cf, 0x9f9e, 0x714c, 0xdb1d, 0xbcc9, 0x1698, 0xf84a, 0x521b,
+		0x3b0c, 0x915d, 0x7f8f, 0xd5de, 0xb20a, 0x185b, 0xf689, 0x5cd8,
+		0x3921, 0x9370, 0x7da2, 0xd7f3, 0xb027, 0x1a76, 0xf4a4, 0x5ef5,
+		0x3f56, 0x9507, 0x7bd5, 0xd184, 0xb650, 0x1c01, 0xf2d3, 0x5882,
+		0x3d7b, 0x972a, 0x79f8, 0xd3a9, 0xb47d, 0x1e2c, 0xf0fe, 0x5aaf,
+	},
+	{
+		0x0000, 0x45a0, 0x8b40, 0xcee0, 0x06a1, 0x4301, 0x8de1, 0xc841,
+		0x0d42, 0x48e2, 0x8602, 0xc3a2, 0x0be3, 0x4e43, 0x80a3, 0xc503,
+		0x1a84, 0x5f24, 0x91c4, 0xd464, 0x1c25, 0x5985, 0x9765, 0xd2c5,
+		0x17c6, 0x5266, 0x9c86, 0xd926, 0x1167, 0x54c7, 0x9a27, 0xdf87,
+		0x3508, 0x70a8, 0xbe48, 0xfbe8, 0x33a9, 0x7609, 0xb8e9, 0xfd49,
+		0x384a, 0x7dea, 0xb30a, 0xf6aa, 0x3eeb, 0x7b4b, 0xb5ab, 0xf00b,
+		0x2f8c, 0x6a2c, 0xa4cc, 0xe16c, 0x292d, 0x6c8d, 0xa26d, 0xe7cd,
+		0x22ce, 0x676e, 0xa98e, 0xec2e, 0x246f, 0x61cf, 0xaf2f, 0xea8f,
+		0x6a10, 0x2fb0, 0xe150, 0xa4f0, 0x6cb1, 0x2911, 0xe7f1, 0xa251,
+		0x6752, 0x22f2, 0xec12, 0xa9b2, 0x61f3, 0x2453, 0xeab3, 0xaf13,
+		0x7094, 0x3534, 0xfbd4, 0xbe74, 0x7635, 0x3395, 0xfd75, 0xb8d5,
+		0x7dd6, 0x3876, 0xf696, 0xb336, 0x7b77, 0x3ed7, 0xf037, 0xb597,
+		0x5f18, 0x1ab8, 0xd458, 0x91f8, 0x59b9, 0x1c19, 0xd2f9, 0x9759,
+		0x525a, 0x17fa, 0xd91a, 0x9cba, 0x54fb, 0x115b, 0xdfbb, 0x9a1b,
+		0x459c, 0x003c, 0xcedc, 0x8b7c, 0x433d, 0x069d, 0xc87d, 0x8ddd,
+		0x48de, 0x0d7e, 0xc39e, 0x863e, 0x4e7f, 0x0bdf, 0xc53f, 0x809f,
+		0xd420, 0x9180, 0x5f60, 0x1ac0, 0xd281, 0x9721, 0x59c1, 0x1c61,
+		0xd962, 0x9cc2, 0x5222, 0x1782, 0xdfc3, 0x9a63, 0x5483, 0x1123,
+		0xcea4, 0x8b04, 0x45e4, 0x0044, 0xc805, 0x8da5, 0x4345, 0x06e5,
+		0xc3e6, 0x8646, 0x48a6, 0x0d06, 0xc547, 0x80e7, 0x4e07, 0x0ba7,
+		0xe128, 0xa488, 0x6a68, 0x2fc8, 0xe789, 0xa229, 0x6cc9, 0x2969,
+		0xec6a, 0xa9ca, 0x672a, 0x228a, 0xeacb, 0xaf6b, 0x618b, 0x242b,
+		0xfbac, 0xbe0c, 0x70ec, 0x354c, 0xfd0d, 0xb8ad, 0x764d, 0x33ed,
+		0xf6ee, 0xb34e, 0x7dae, 0x380e, 0xf04f, 0xb5ef, 0x7b0f, 0x3eaf,
+		0xbe30, 0xfb90, 0x3570, 0x70d0, 0xb891, 0xfd31, 0x33d1, 0x7671,
+		0xb372, 0xf6d2, 0x3832, 0x7d92, 0xb5d3, 0xf073, 0x3e93, 0x7b33,
+		0xa4b4, 0xe114, 0x2ff4, 0x6a54, 0xa215, 0xe7b5, 0x2955, 0x6cf5,
+		0xa9f6, 0xec56, 0x22b6, 0x6716, 0xaf57, 0xeaf7, 0x2417, 0x61b7,
+		0x8b38, 0xce98, 0x0078, 0x45d8, 0x8d99, 0xc839, 0x06d9, 0x4379,
+		0x867a, 0xc3da, 0x0d3a, 0x489a, 0x80db, 0xc57b, 0x0b9b, 0x4e3b,
+		0x91bc, 0xd41c, 0x1afc, 0x5f5c, 0x971d, 0xd2bd, 0x1c5d, 0x59fd,
+		0x9cfe, 0xd95e, 0x17be, 0x521e, 0x9a5f, 0xdfff, 0x111f, 0x54bf,
+	},
+	{
+		0x0000, 0xb861, 0x60e3, 0xd882, 0xc1c6, 0x79a7, 0xa125, 0x1944,
+		0x93ad, 0x2bcc, 0xf34e, 0x4b2f, 0x526b, 0xea0a, 0x3288, 0x8ae9,
+		0x377b, 0x8f1a, 0x5798, 0xeff9, 0xf6bd, 0x4edc, 0x965e, 0x2e3f,
+		0xa4d6, 0x1cb7, 0xc435, 0x7c54, 0x6510, 0xdd71, 0x05f3, 0xbd92,
+		0x6ef6, 0xd697, 0x0e15, 0xb674, 0xaf30, 0x1751, 0xcfd3, 0x77b2,
+		0xfd5b, 0x453a, 0x9db8, 0x25d9, 0x3c9d, 0x84fc, 0x5c7e, 0xe41f,
+		0x598d, 0xe1ec, 0x396e, 0x810f, 0x984b, 0x202a, 0xf8a8, 0x40c9,
+		0xca20, 0x7241, 0xaac3, 0x12a2, 0x0be6, 0xb387, 0x6b05, 0xd364,
+		0xddec, 0x658d, 0xbd0f, 0x056e, 0x1c2a, 0xa44b, 0x7cc9, 0xc4a8,
+		0x4e41, 0xf620, 0x2ea2, 0x96c3, 0x8f87, 0x37e6, 0xef64, 0x5705,
+		0xea97, 0x52f6, 0x8a74, 0x3215, 0x2b51, 0x9330, 0x4bb2, 0xf3d3,
+		0x793a, 0xc15b, 0x19d9, 0xa1b8, 0xb8fc, 0x009d, 0xd81f, 0x607e,
+		0xb31a, 0x0b7b, 0xd3f9, 0x6b98, 0x72dc, 0xcabd, 0x123f, 0xaa5e,
+		0x20b7, 0x98d6, 0x4054, 0xf835, 0xe171, 0x5910, 0x8192, 0x39f3,
+		0x8461, 0x3c00, 0xe482, 0x5ce3, 0x45a7, 0xfdc6, 0x2544, 0x9d25,
+		0x17cc, 0xafad, 0x772f, 0xcf4e, 0xd60a, 0x6e6b, 0xb6e9, 0x0e88,
+		0xabf9, 0x1398, 0xcb1a, 0x737b, 0x6a3f, 0xd25e, 0x0adc, 0xb2bd,
+		0x3854, 0x8035, 0x58b7, 0xe0d6, 0xf992, 0x41f3, 0x9971, 0x2110,
+		0x9c82, 0x24e3, 0xfc61, 0x4400, 0x5d44, 0xe525, 0x3da7, 0x85c6,
+		0x0f2f, 0xb74e, 0x6fcc, 0xd7ad, 0xcee9, 0x7688, 0xae0a, 0x166b,
+		0xc50f, 0x7d6e, 0xa5ec, 0x1d8d, 0x04c9, 0xbca8, 0x642a, 0xdc4b,
+		0x56a2, 0xeec3, 0x3641, 0x8e20, 0x9764, 0x2f05, 0xf787, 0x4fe6,
+		0xf274, 0x4a15, 0x9297, 0x2af6, 0x33b2, 0x8bd3, 0x5351, 0xeb30,
+		0x61d9, 0xd9b8, 0x013a, 0xb95b, 0xa01f, 0x187e, 0xc0fc, 0x789d,
+		0x7615, 0xce74, 0x16f6, 0xae97, 0xb7d3, 0x0fb2, 0xd730, 0x6f51,
+		0xe5b8, 0x5dd9, 0x855b, 0x3d3a, 0x247e, 0x9c1f, 0x449d, 0xfcfc,
+		0x416e, 0xf90f, 0x218d, 0x99ec, 0x80a8, 0x38c9, 0xe04b, 0x582a,
+		0xd2c3, 0x6aa2, 0xb220, 0x0a41, 0x1305, 0xab64, 0x73e6, 0xcb87,
+		0x18e3, 0xa082, 0x7800, 0xc061, 0xd925, 0x6144, 0xb9c6, 0x01a7,
+		0x8b4e, 0x332f, 0xebad, 0x53cc, 0x4a88, 0xf2e9, 0x2a6b, 0x920a,
+		0x2f98, 0x97f9, 0x4f7b, 0xf71a, 0xee5e, 0x563f, 0x8ebd, 0x36dc,
+		0xbc35, 0x0454, 0xdcd6, 0x64b7, 0x7df3, 0xc592, 0x1d10, 0xa571,
+	},
+	{
+		0x0000, 0x47d3, 0x8fa6, 0xc875, 0x0f6d, 0x48be, 0x80cb, 0xc718,
+		0x1eda, 0x5909, 0x917c, 0xd6af, 0x11b7, 0x5664, 0x9e11, 0xd9c2,
+		0x3db4, 0x7a67, 0xb212, 0xf5c1, 0x32d9, 0x750a, 0xbd7f, 0xfaac,
+		0x236e, 0x64bd, 0xacc8, 0xeb1b, 0x2c03, 0x6bd0, 0xa3a5, 0xe476,
+		0x7b68, 0x3cbb, 0xf4ce, 0xb31d, 0x7405, 0x33d6, 0xfba3, 0xbc70,
+		0x65b2, 0x2261, 0xea14, 0xadc7, 0x6adf, 0x2d0c, 0xe579, 0xa2aa,
+		0x46dc, 0x010f, 0xc97a, 0x8ea9, 0x49b1, 0x0e62, 0xc617, 0x81c4,
+		0x5806, 0x1fd5, 0xd7a0, 0x9073, 0x576b, 0x10b8, 0xd8cd, 0x9f1e,
+		0xf6d0, 0xb103, 0x7976, 0x3ea5, 0xf9bd, 0xbe6e, 0x761b, 0x31c8,
+		0xe80a, 0xafd9, 0x67ac, 0x207f, 0xe767, 0xa0b4, 0x68c1, 0x2f12,
+		0xcb64, 0x8cb7, 0x44c2, 0x0311, 0xc409, 0x83da, 0x4baf, 0x0c7c,
+		0xd5be, 0x926d, 0x5a18, 0x1dcb, 0xdad3, 0x9d00, 0x5575, 0x12a6,
+		0x8db8, 0xca6b, 0x021e, 0x45cd, 0x82d5, 0xc506, 0x0d73, 0x4aa0,
+		0x9362, 0xd4b1, 0x1cc4, 0x5b17, 0x9c0f, 0xdbdc, 0x13a9, 0x547a,
+		0xb00c, 0xf7df, 0x3faa, 0x7879, 0xbf61, 0xf8b2, 0x30c7, 0x7714,
+		0xaed6, 0xe905, 0x2170, 0x66a3, 0xa1bb, 0xe668, 0x2e1d, 0x69ce,
+		0xfd81, 0xba52, 0x7227, 0x35f4, 0xf2ec, 0xb53f, 0x7d4a, 0x3a99,
+		0xe35b, 0xa488, 0x6cfd, 0x2b2e, 0xec36, 0xabe5, 0x6390, 0x2443,
+		0xc035, 0x87e6, 0x4f93, 0x0840, 0xcf58, 0x888b, 0x40fe, 0x072d,
+		0xdeef, 0x993c, 0x5149, 0x169a, 0xd182, 0x9651, 0x5e24, 0x19f7,
+		0x86e9, 0xc13a, 0x094f, 0x4e9c, 0x8984, 0xce57, 0x0622, 0x41f1,
+		0x9833, 0xdfe0, 0x1795, 0x5046, 0x975e, 0xd08d, 0x18f8, 0x5f2b,
+		0xbb5d, 0xfc8e, 0x34fb, 0x7328, 0xb430, 0xf3e3, 0x3b96, 0x7c45,
+		0xa587, 0xe254, 0x2a21, 0x6df2, 0xaaea, 0xed39, 0x254c, 0x629f,
+		0x0b51, 0x4c82, 0x84f7, 0xc324, 0x043c, 0x43ef, 0x8b9a, 0xcc49,
+		0x158b, 0x5258, 0x9a2d, 0xddfe, 0x1ae6, 0x5d35, 0x9540, 0xd293,
+		0x36e5, 0x7136, 0xb943, 0xfe90, 0x3988, 0x7e5b, 0xb62e, 0xf1fd,
+		0x283f, 0x6fec, 0xa799, 0xe04a, 0x2752, 0x6081, 0xa8f4, 0xef27,
+		0x7039, 0x37ea, 0xff9f, 0xb84c, 0x7f54, 0x3887, 0xf0f2, 0xb721,
+		0x6ee3, 0x2930, 0xe145, 0xa696, 0x618e, 0x265d, 0xee28, 0xa9fb,
+		0x4d8d, 0x0a5e, 0xc22b, 0x85f8, 0x42e0, 0x0533, 0xcd46, 0x8a95,
+		0x5357, 0x1484, 0xdcf1, 0x9b22, 0x5c3a, 0x1be9, 0xd39c, 0x944f,
+	},
+#endif
+};
 
-		init = TRUE;
+static uint16_t NurCRC16Lookup(uint16_t crc, const uint8_t *buf, uint32_t len)
+{
+#if CRC16_LOOKUP_SLICES == 8
+	while (len >= 8) {
+		crc = crc16Table[7][buf[0] ^ (crc >> 8)] ^
+			  crc16Table[6][buf[1] ^ (crc & 0xFF)] ^
+			  crc16Table[5][buf[2]] ^
+			  crc16Table[4][buf[3]] ^
+			  crc16Table[3][buf[4]] ^
+			  crc16Table[2][buf[5]] ^
+			  crc16Table[1][buf[6]] ^
+			  crc16Table[0][buf[7]];
+		buf += 8;
+		len -= 8;
+	}
+#elif CRC16_LOOKUP_SLICES == 4
+	while (len >= 4) {
+		crc = crc16Table[3][buf[0] ^ (crc >> 8)] ^
+			  crc16Table[2][buf[1] ^ (crc & 0xFF)] ^
+			  crc16Table[1][buf[2]] ^
+			  crc16Table[0][buf[3]];
+		buf += 4;
+		len -= 4;
 	}
+#endif
 
 	while (len--) {
-		crc = (crc << 8) ^ crctable[(crc >> 8) ^ *buf++];
+		crc = (crc << 8) ^ crc16Table[0][(crc >> 8) ^ *buf++];
 	}
 	return crc;
 }
 
+#if defined(HAVE_CRC16_PCLMUL) && (defined(__x86_64__) || defined(_M_X64))
+
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Shorter buffers are faster with lookup
+#define CRC16_PCLMUL_MIN_LEN	64
+
+#ifdef __GNUC__
+#define CRC16_PCLMUL_TARGET __attribute__((target("pclmul,ssse3")))
+#else
+#define CRC16_PCLMUL_TARGET
+#endif
+
+static int Crc16HavePclmul(void)
+{
+#ifdef __GNUC__
+	return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+#else
+	// Concurrent first calls store the same value, no locking needed
+	static volatile int havePclmul = -1;
+	if (havePclmul < 0) {
+		int info[4];
+		__cpuid(info, 1);
+		havePclmul = ((info[2] & (1 << 1)) != 0 && (info[2] & (1 << 9)) != 0);
+	}
+	return havePclmul;
+#endif
+}
+
+// Multiply 128-bit block 'a' forward with constants 'k' and add block 'b'
+#define CRC16_FOLD(a, k, b) \
+	_mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128((a), (k), 0x11), _mm_clmulepi64_si128((a), (k), 0x00)), (b))
+
+#define CRC16_LOAD(p) _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p)), bswap)
+
+/*
+	Carry-less multiply folding. Buffer is treated as a big-endian polynomial and folded
+	128 bits at a time (four blocks in parallel) to a 128-bit remainder that is congruent
+	with the buffer modulo the CRC polynomial. The remainder and the tail are finished with lookup.
+	Fold constants are x^n mod 0x11021.
+*/
+CRC16_PCLMUL_TARGET
+static uint16_t NurCRC16Pclmul(uint16_t crc, const uint8_t *buf, uint32_t len)
+{
+	const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	const __m128i k128 = _mm_set_epi64x(0x650b /* x^192 */, 0xaefc /* x^128 */);
+	const __m128i k512 = _mm_set_epi64x(0x8832 /* x^576 */, 0x13fc /* x^512 */);
+	__m128i a0, a1, a2, a3;
+	uint8_t rem[16];
+
+	// Current CRC is added to the first 16 message bits
+	a0 = _mm_xor_si128(CRC16_LOAD(buf), _mm_set_epi64x((int64_t)((uint64_t)crc << 48), 0));
+	a1 = CRC16_LOAD(buf + 16);
+	a2 = CRC16_LOAD(buf + 32);
+	a3 = CRC16_LOAD(buf + 48);
+	buf += 64;
+	len -= 64;
+
+	while (len >= 64) {
+		a0 = CRC16_FOLD(a0, k512, CRC16_LOAD(buf));
+		a1 = CRC16_FOLD(a1, k512, CRC16_LOAD(buf + 16));
+		a2 = CRC16_FOLD(a2, k512, CRC16_LOAD(buf + 32));
+		a3 = CRC16_FOLD(a3, k512, CRC16_LOAD(buf + 48));
+		buf += 64;
+		len -= 64;
+	}
+
+	a1 = CRC16_FOLD(a0, k128, a1);
+	a2 = CRC16_FOLD(a1, k128, a2);
+	a3 = CRC16_FOLD(a2, k128, a3);
+
+	while (len >= 16) {
+		a3 = CRC16_FOLD(a3, k128, CRC16_LOAD(buf));
+		buf += 16;
+		len -= 16;
+	}
+
+	_mm_storeu_si128((__m128i *)rem, _mm_shuffle_epi8(a3, bswap));
+	crc = NurCRC16Lookup(0, rem, sizeof(rem));
+	return NurCRC16Lookup(crc, buf, len);
+}
+
+#endif	// PCLMUL
+
+static uint16_t NurCRC16(uint16_t crc, uint8_t *buf, uint32_t len)
+{
+#ifdef CRC16_PCLMUL_MIN_LEN
+	if (len >= CRC16_PCLMUL_MIN_LEN && Crc16HavePclmul()) {
+		return NurCRC16Pclmul(crc, buf, len);
+	}
+#endif
+	return NurCRC16Lookup(crc, buf, len);
+}
+
 #else
 
 // Inlining the update call.
@@ -238,28 +636,192 @@ static uint16_t NurCRC16(uint16_t crc, uint8_t *buf, uint32_t len)
 #define RxPayloadDataPtr	(RxHeaderDataPtr + (HDR_SIZE+1)) // + header + cmd
 #define RxPayloadLen		(RxHeaderPtr->payloadlen - 2 - 1 - 1) // - CRC - cmd - status
 
+// Smallest valid payload from module: cmd + status + CRC
+#define MIN_RX_PAYLOADLEN	4
+
 #define STATE_IDLE 			1
 #define STATE_HDR 			2
 #define STATE_PAYLOAD 		3
 #define STATE_PACKETREADY	4
 
-static uint8_t packetHandlerState = STATE_IDLE;
+#ifdef CONFIG_LINK_STATS
+#define STATS_ADD(field, n)	do { if (hNurApi->Stats) hNurApi->Stats->field += (n); } while (0)
+#else
+#define STATS_ADD(field, n)	do { } while (0)
+#endif
 
-int NurApiHandlePacketData(struct NUR_API_HANDLE *hNurApi, uint32_t *processPos, uint32_t *bytesToProcess)
+#ifdef CONFIG_XCH_TRACE
+#define XCH_TRACE(event, cmd, len, status)	do { if (hNurApi->XchTraceFunction) hNurApi->XchTraceFunction(hNurApi, event, cmd, len, status); } while (0)
+#else
+#define XCH_TRACE(event, cmd, len, status)	do { } while (0)
+#endif
+
+// Payload CRC is calculated while data arrives, validation at the end of the packet only compares
+static void StartRxPayloadCRC(struct NUR_API_HANDLE *hNurApi)
+{
+	hNurApi->RxPayloadCRC = CRC16_START;
+	hNurApi->RxPayloadCRCPos = HDR_SIZE;
+}
+
+static void UpdateRxPayloadCRC(struct NUR_API_HANDLE *hNurApi)
+{
+	// Last uint16_t of payload contains CRC16 calculated by module
+	uint32_t crcEnd = HDR_SIZE + RxHeaderPtr->payloadlen - 2;
+	uint32_t avail = (hNurApi->RxBufferUsed < crcEnd) ? hNurApi->RxBufferUsed : crcEnd;
+
+	if (avail > hNurApi->RxPayloadCRCPos)
+	{
+		hNurApi->RxPayloadCRC = NurCRC16(hNurApi->RxPayloadCRC, &hNurApi->RxBuffer[hNurApi->RxPayloadCRCPos], avail - hNurApi->RxPayloadCRCPos);
+		hNurApi->RxPayloadCRCPos = avail;
+	}
+}
+
+static uint8_t CalculateHeaderCheckSum(uint8_t *buf)
+{
+	int len = HDR_SIZE - 1;
+	uint8_t checksum = CS_STARTBYTE;
+	int i;
+	for (i=0; i<len; i++) {
+		checksum ^= buf[i];
+	}
+	return checksum;
+}
+
+// Discard 'count' bytes from the beginning of the RX buffer
+static void DiscardRxData(struct NUR_API_HANDLE *hNurApi, uint32_t count)
+{
+	uint32_t n;
+	uint32_t remaining = hNurApi->RxBufferUsed - count;
+
+	// Overlapping move towards buffer start, copy forward
+	for (n=0; n<remaining; n++) {
+		hNurApi->RxBuffer[n] = hNurApi->RxBuffer[count + n];
+	}
+	hNurApi->RxBufferUsed = remaining;
+}
+
+static int IsRxPayloadCRCValid(struct NUR_API_HANDLE *hNurApi)
+{
+	return hNurApi->RxPayloadCRC == BytesToWord(&RxPayloadCmdPtr[RxHeaderPtr->payloadlen-2]);
+}
+
+// Header checksum is valid and the packet fits in to the RX buffer
+static int IsRxHeaderValid(struct NUR_API_HANDLE *hNurApi)
+{
+	return CalculateHeaderCheckSum(RxHeaderDataPtr) == RxHeaderPtr->checksum &&
+		RxHeaderPtr->payloadlen >= MIN_RX_PAYLOADLEN &&
+		(uint32_t)(RxHeaderPtr->payloadlen + HDR_SIZE) <= hNurApi->RxBufferLen;
+}
+
+// Pass the first count bytes of RxBuffer to IgnoredByteHandler one at a time, as the byte-wise parser does
+static void ReportIgnoredBytes(struct NUR_API_HANDLE *hNurApi, uint32_t count)
 {
-	uint8_t *trBuf = hNurApi->TxBuffer;
+	uint32_t n;
+	uint32_t used = hNurApi->RxBufferUsed;
 
-	while ((*processPos) < (*bytesToProcess))
+	if (!hNurApi->IgnoredByteHandler)
+		return;
+	for (n = 0; n < count; n++)
 	{
-		hNurApi->RxBuffer[hNurApi->RxBufferUsed++] = trBuf[(*processPos)++];
+		// Already handled bytes can be overwritten
+		hNurApi->RxBuffer[0] = hNurApi->RxBuffer[n];
+		hNurApi->RxBufferUsed = 1;
+		hNurApi->IgnoredByteHandler(hNurApi);
+	}
+	hNurApi->RxBufferUsed = used;
+}
+
+/*
+	Invalid header or payload CRC at RxBuffer[0].
+	Bytes after the failed start marker may contain the next packet: a noise byte 0xA5 takes
+	the real header in to its "header", a dropped byte makes a packet end inside the next one.
+	Scan them for the next start marker and run header and payload checks again on what is
+	already buffered. Leaves the state for the next received byte, or STATE_PACKETREADY if
+	a complete packet was found. Scan starts at 'start'; zero when RxBuffer[0] was not tried yet.
+*/
+static void ResyncRxBuffer(struct NUR_API_HANDLE *hNurApi, uint32_t start)
+{
+	for (;;)
+	{
+		while (start < hNurApi->RxBufferUsed && hNurApi->RxBuffer[start] != PACKET_START) {
+			start++;
+		}
+		ReportIgnoredBytes(hNurApi, start);
+		DiscardRxData(hNurApi, start);
+		STATS_ADD(BytesIgnored, start);
+
+		if (hNurApi->RxBufferUsed == 0) {
+			hNurApi->RxPacketState = STATE_IDLE;
+			return;
+		}
+
+		hNurApi->RxPacketState = STATE_HDR;
+		if (hNurApi->RxBufferUsed < HDR_SIZE)
+			return;
+		start = 1;
+		if (!IsRxHeaderValid(hNurApi)) {
+			STATS_ADD(HeaderErrors, 1);
+			continue;
+		}
+
+		hNurApi->RxPacketState = STATE_PAYLOAD;
+		StartRxPayloadCRC(hNurApi);
+		UpdateRxPayloadCRC(hNurApi);
+		if (hNurApi->RxBufferUsed < (uint32_t)(RxHeaderPtr->payloadlen + HDR_SIZE))
+			return;
+		if (!IsRxPayloadCRCValid(hNurApi)) {
+			STATS_ADD(CrcErrors, 1);
+			continue;
+		}
+
+		hNurApi->RxPacketState = STATE_PACKETREADY;
+		hNurApi->respLen = RxHeaderPtr->payloadlen-1-1-2; // - cmd - status - CRC
+		hNurApi->resp = (struct NUR_CMD_RESP *)RxPayloadCmdPtr;
+		return;
+	}
+}
+
+static int HandlePacketData(struct NUR_API_HANDLE *hNurApi, const uint8_t *trBuf, uint32_t *processPos, uint32_t *bytesToProcess)
+{
+	uint32_t startPos = *processPos;
+	uint32_t packetLen, giveBack;
+
+	if (hNurApi->RxPacketState == STATE_PACKETREADY)
+	{
+		// Previous packet was found by resync and had data after it, handle that first
+		DiscardRxData(hNurApi, RxHeaderPtr->payloadlen + HDR_SIZE);
+		ResyncRxBuffer(hNurApi, 0);
+	}
+
+	while (hNurApi->RxPacketState != STATE_PACKETREADY && (*processPos) < (*bytesToProcess))
+	{
+		if (hNurApi->RxPacketState == STATE_PAYLOAD)
+		{
+			// Take as much of the payload as available at once
+			uint32_t copyLen = (RxHeaderPtr->payloadlen + HDR_SIZE) - hNurApi->RxBufferUsed;
+			if (copyLen > (*bytesToProcess) - (*processPos))
+				copyLen = (*bytesToProcess) - (*processPos);
+
+			nurMemcpy(&hNurApi->RxBuffer[hNurApi->RxBufferUsed], &trBuf[*processPos], copyLen);
+			hNurApi->RxBufferUsed += copyLen;
+			(*processPos) += copyLen;
+		}
+		else
+		{
+			hNurApi->RxBuffer[hNurApi->RxBufferUsed++] = trBuf[(*processPos)++];
+		}
 
-		switch (packetHandlerState)
+		switch (hNurApi->RxPacketState)
 		{
+		default:
+			// Zero initialized handle, start from idle
+			hNurApi->RxPacketState = STATE_IDLE;
+			// Fall through
 		case STATE_IDLE:
 			if (hNurApi->RxBuffer[0] == 0xA5)
 			{
 				// Got header marker
-				packetHandlerState = STATE_HDR;
+				hNurApi->RxPacketState = STATE_HDR;
 			}
 			else
 			{
@@ -267,6 +829,7 @@ int NurApiHandlePacketData(struct NUR_API_HANDLE *hNurApi, uint32_t *processPos,
 			    if (hNurApi->IgnoredByteHandler) {
 			        hNurApi->IgnoredByteHandler(hNurApi);
 			    }
+				STATS_ADD(BytesIgnored, 1);
 				hNurApi->RxBufferUsed = 0;
 			}
 			break;
@@ -275,46 +838,33 @@ int NurApiHandlePacketData(struct NUR_API_HANDLE *hNurApi, uint32_t *processPos,
 			// Wait for header completely received
 			if (hNurApi->RxBufferUsed == HDR_SIZE)
 			{
-				// Calculate header checksum
-				uint8_t headerChecksum = 0xFF;
-				headerChecksum ^= (	hNurApi->RxBuffer[0] ^
-									hNurApi->RxBuffer[1] ^
-									hNurApi->RxBuffer[2] ^
-									hNurApi->RxBuffer[3] ^
-									hNurApi->RxBuffer[4]);
-
-				// Validate checksum
-				if (headerChecksum == RxHeaderPtr->checksum)
+				// Validate checksum and make sure the packet fits in to the RX buffer
+				if (IsRxHeaderValid(hNurApi))
 				{
 					// Valid header received, go to payload state
-					packetHandlerState = STATE_PAYLOAD;
+					hNurApi->RxPacketState = STATE_PAYLOAD;
+					StartRxPayloadCRC(hNurApi);
 				}
 				else
 				{
-					// Invalid header checksum, return to idle..
-					hNurApi->RxBufferUsed = 0;
-					packetHandlerState = STATE_IDLE;
+					// Invalid header checksum or too long packet, rescan header bytes
+					STATS_ADD(HeaderErrors, 1);
+					ResyncRxBuffer(hNurApi, 1);
 				}
 			}
 			break;
 
 		case STATE_PAYLOAD:
+			UpdateRxPayloadCRC(hNurApi);
+
 			// Wait for packet completely received
 			if (hNurApi->RxBufferUsed == (uint32_t)(RxHeaderPtr->payloadlen + HDR_SIZE))
 			{
-				uint16_t calcCRC = 0xFFFF;
-				uint16_t packetCRC = 0;
-				uint8_t *payloadBuffer = RxPayloadCmdPtr;
-
-				// Calculate payload CRC, last uint16_t contains CRC16 calculated by module
-				calcCRC = NurCRC16(calcCRC, payloadBuffer, RxHeaderPtr->payloadlen - 2);
-
 				// Validate CRC
-				packetCRC = BytesToWord(&payloadBuffer[RxHeaderPtr->payloadlen-2]);
-				if (packetCRC == calcCRC)
+				if (IsRxPayloadCRCValid(hNurApi))
 				{
 					// Payload valid, we're ready
-					packetHandlerState = STATE_PACKETREADY;
+					hNurApi->RxPacketState = STATE_PACKETREADY;
 
 					// Store response info
 					hNurApi->respLen = RxHeaderPtr->payloadlen-1-1-2; // - cmd - status - CRC
@@ -322,9 +872,9 @@ int NurApiHandlePacketData(struct NUR_API_HANDLE *hNurApi, uint32_t *processPos,
 				}
 				else
 				{
-					// Invalid payload CRC, return to idle..
-					hNurApi->RxBufferUsed = 0;
-					packetHandlerState = STATE_IDLE;
+					// Invalid payload CRC, rescan packet bytes
+					STATS_ADD(CrcErrors, 1);
+					ResyncRxBuffer(hNurApi, 1);
 				}
 			}
 			break;
@@ -333,31 +883,148 @@ int NurApiHandlePacketData(struct NUR_API_HANDLE *hNurApi, uint32_t *processPos,
 			// Packet ready, buffer data
 			break;
 		}
-
-		if (packetHandlerState == STATE_PACKETREADY)
-			break;
 	}
 
-	if (packetHandlerState == STATE_PACKETREADY)
+	if (hNurApi->RxPacketState == STATE_PACKETREADY)
 	{
-		// Packet ready, return to idle
-		hNurApi->RxBufferUsed = 0;
-		packetHandlerState = STATE_IDLE;
+		// Packet found by resync may be followed by more data: bytes from this call are
+		// given back to the caller, older ones are kept in RxBuffer for the next call
+		packetLen = RxHeaderPtr->payloadlen + HDR_SIZE;
+		giveBack = hNurApi->RxBufferUsed - packetLen;
+		if (giveBack > (*processPos) - startPos)
+			giveBack = (*processPos) - startPos;
+		(*processPos) -= giveBack;
+		hNurApi->RxBufferUsed -= giveBack;
+		STATS_ADD(BytesIn, (*processPos) - startPos);
+
+		if (hNurApi->RxBufferUsed == packetLen)
+		{
+			// Packet ready, return to idle
+			hNurApi->RxBufferUsed = 0;
+			hNurApi->RxPacketState = STATE_IDLE;
+		}
 		return STATE_PACKETREADY;
 	}
 
-	return packetHandlerState;
+	STATS_ADD(BytesIn, (*processPos) - startPos);
+	return hNurApi->RxPacketState;
 }
 
-static uint8_t CalculateHeaderCheckSum(uint8_t *buf)
+int NurApiHandlePacketData(struct NUR_API_HANDLE *hNurApi, uint32_t *processPos, uint32_t *bytesToProcess)
 {
-	int len = HDR_SIZE - 1;
-	uint8_t checksum = CS_STARTBYTE;
-	int i;
-	for (i=0; i<len; i++) {
-		checksum ^= buf[i];
+	return HandlePacketData(hNurApi, hNurApi->TxBuffer, processPos, bytesToProcess);
+}
+
+/*
+	Zero-copy packet handler.
+	Transport has read data directly to RxBuffer, RxBufferUsed tells how much data there is.
+	Scans the buffer for a complete packet in place; payload is never copied.
+	Previously returned ready packet is discarded from the buffer on next call.
+*/
+static void ReleaseRxPacket(struct NUR_API_HANDLE *hNurApi)
+{
+	if (hNurApi->RxPacketState == STATE_PACKETREADY)
+	{
+		// Remove previously handled packet, keep data received after it
+		DiscardRxData(hNurApi, RxHeaderPtr->payloadlen + HDR_SIZE);
+		hNurApi->RxPacketState = STATE_IDLE;
+	}
+}
+
+int NurApiHandleRxBufferData(struct NUR_API_HANDLE *hNurApi)
+{
+	uint32_t packetLen;
+
+	ReleaseRxPacket(hNurApi);
+
+	for (;;)
+	{
+		switch (hNurApi->RxPacketState)
+		{
+		default:
+			// Zero initialized handle, start from idle
+			hNurApi->RxPacketState = STATE_IDLE;
+			// Fall through
+		case STATE_IDLE:
+			{
+				uint32_t start = 0;
+
+				// Scan for header marker
+				while (start < hNurApi->RxBufferUsed && hNurApi->RxBuffer[start] != PACKET_START) {
+					start++;
+				}
+
+				if (start > 0)
+				{
+					// Pass data to IgnoredByteHandler and discard
+					ReportIgnoredBytes(hNurApi, start);
+					DiscardRxData(hNurApi, start);
+					STATS_ADD(BytesIgnored, start);
+				}
+
+				if (hNurApi->RxBufferUsed == 0) {
+					return STATE_IDLE;
+				}
+
+				// Got header marker
+				hNurApi->RxPacketState = STATE_HDR;
+			}
+			break;
+
+		case STATE_HDR:
+			// Wait for header completely received
+			if (hNurApi->RxBufferUsed < HDR_SIZE) {
+				return STATE_HDR;
+			}
+
+			if (IsRxHeaderValid(hNurApi))
+			{
+				// Valid header received, go to payload state
+				hNurApi->RxPacketState = STATE_PAYLOAD;
+				StartRxPayloadCRC(hNurApi);
+			}
+			else
+			{
+				// Invalid header checksum or too long packet, discard start marker only
+				// and rescan the rest for next header
+				ReportIgnoredBytes(hNurApi, 1);
+				DiscardRxData(hNurApi, 1);
+				STATS_ADD(HeaderErrors, 1);
+				STATS_ADD(BytesIgnored, 1);
+				hNurApi->RxPacketState = STATE_IDLE;
+			}
+			break;
+
+		case STATE_PAYLOAD:
+			UpdateRxPayloadCRC(hNurApi);
+
+			// Wait for packet completely received
+			packetLen = RxHeaderPtr->payloadlen + HDR_SIZE;
+			if (hNurApi->RxBufferUsed < packetLen) {
+				return STATE_PAYLOAD;
+			}
+
+			if (IsRxPayloadCRCValid(hNurApi))
+			{
+				// Payload valid, we're ready
+				hNurApi->RxPacketState = STATE_PACKETREADY;
+
+				// Store response info
+				hNurApi->respLen = RxHeaderPtr->payloadlen-1-1-2; // - cmd - status - CRC
+				hNurApi->resp = (struct NUR_CMD_RESP *)RxPayloadCmdPtr;
+				return STATE_PACKETREADY;
+			}
+
+			// Invalid payload CRC, discard start marker only; the claimed packet may
+			// contain the next header if bytes were lost
+			ReportIgnoredBytes(hNurApi, 1);
+			DiscardRxData(hNurApi, 1);
+			STATS_ADD(CrcErrors, 1);
+			STATS_ADD(BytesIgnored, 1);
+			hNurApi->RxPacketState = STATE_IDLE;
+			break;
+		}
 	}
-	return checksum;
 }
 
 int NURAPICONV NurApiSetupPacket(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, uint16_t flags, uint16_t *packetLen)
@@ -390,113 +1057,1274 @@ int NURAPICONV NurApiSetupPacket(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, ui
 	return NUR_SUCCESS;
 }
 
-int NURAPICONV NurApiXchPacket(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, int timeout)
+/*
+	Write all segments to transport. Transport may write less than requested;
+	rest is written on next round. Fails with NUR_ERROR_TR_TIMEOUT if no progress is made within timeout.
+	Segment array is modified.
+*/
+static int TransportWrite(struct NUR_API_HANDLE *hNurApi, struct NUR_IOVEC *iov, int iovCnt, int timeout)
 {
 	int error;
-    uint32_t processPos = 0;
-    uint32_t bytesRead = 0;
-	int packetState = STATE_IDLE;
-	uint16_t packetLen;
-	//uint8_t tmpRxBuf[32];
+	int stallRounds = 0;
+	uint32_t written;
+	uint32_t stallTick = 0;
 
-	if (cmd != 0)
+	while (iovCnt > 0)
 	{
-	    uint32_t bytesOutput = 0;
-		error = NurApiSetupPacket(hNurApi, cmd, payloadLen, 0, &packetLen);
-		if (error != NUR_SUCCESS)
-			return error;		
+		if (iov->len == 0) {
+			// Skip empty segment
+			iov++;
+			iovCnt--;
+			continue;
+		}
 
-		// Write packet to module
-		// TODO: Handle fragmented write
-		error = hNurApi->TransportWriteDataFunction(hNurApi, hNurApi->TxBuffer, packetLen, &bytesOutput);
+		written = 0;
+		if (hNurApi->TransportWriteVecFunction) {
+			error = hNurApi->TransportWriteVecFunction(hNurApi, iov, iovCnt, &written);
+		} else {
+			error = hNurApi->TransportWriteDataFunction(hNurApi, (uint8_t *)iov->data, iov->len, &written);
+		}
 		if (error != NUR_SUCCESS)
 			return error;
-	}
 
-WAITMORE:
-    if (processPos == bytesRead) {
-        packetHandlerState = STATE_IDLE;
-        packetState = STATE_IDLE;
-        hNurApi->RxBufferUsed = 0;
-        processPos = bytesRead = 0;
-    }
+		if (written == 0)
+		{
+			// No progress, transport is busy
+			if (hNurApi->GetTickCountFunction) {
+				if (stallRounds++ == 0)
+					stallTick = hNurApi->GetTickCountFunction(hNurApi);
+				else if ((int32_t)(hNurApi->GetTickCountFunction(hNurApi) - stallTick) >= timeout)
+					return NUR_ERROR_TR_TIMEOUT;
+			} else if (stallRounds++ >= timeout) {
+				return NUR_ERROR_TR_TIMEOUT;
+			}
+			continue;
+		}
+		stallRounds = 0;
+		STATS_ADD(BytesOut, written);
 
-	// Wait and read response from module
-	// NurApiHandlePacketData() function handles fragmented packet validation
-	while (timeout-- > 0)
-	{
-		// Read data
-	    if (processPos == bytesRead)
-	    {
-	        // Buffer completely consumed or empty, read more
-			processPos = 0;
-			error = hNurApi->TransportReadDataFunction(hNurApi, hNurApi->TxBuffer, hNurApi->TxBufferLen, &bytesRead);
-            if (error != NUR_SUCCESS && error != NUR_ERROR_TR_TIMEOUT) {
-                // Transport error
-                return error;
-            }
-	    } else {
-	        // Buffer has still some unprocessed data
-	    }
-
-		if (processPos < bytesRead)
+		// Skip written data
+		while (written > 0)
 		{
-			// Handle incoming data.
-			// NOTE: Data may come in pieces and received buffer may contain unsolicited messages
-			packetState = NurApiHandlePacketData(hNurApi, &processPos, &bytesRead);
-			if (packetState == STATE_PACKETREADY)
-			{
-				// We're done
-				break;
+			if (written >= iov->len) {
+				written -= iov->len;
+				iov++;
+				iovCnt--;
+			} else {
+				iov->data += written;
+				iov->len -= written;
+				written = 0;
 			}
 		}
 	}
 
-	if (packetState != STATE_PACKETREADY || timeout <= 0)
-	{
-		// Packet was not ready within timeout
-		return NUR_ERROR_TR_TIMEOUT;
+	return NUR_SUCCESS;
+}
+
+/*
+	Milliseconds since the command in flight was written.
+	With GetTickCountFunction this is wall-clock time,
+	otherwise each wait round counts as one millisecond.
+*/
+static int32_t XchElapsed(struct NUR_API_HANDLE *hNurApi, struct NUR_XCH_SLOT *slot)
+{
+	if (hNurApi->GetTickCountFunction) {
+		return (int32_t)(hNurApi->GetTickCountFunction(hNurApi) - slot->StartTick);
 	}
+	return hNurApi->XchRoundCount - slot->StartRound;
+}
 
-	if (RxHeaderPtr->flags & PACKET_FLAG_ACK)
-    {
-	    // ACK requested by NUR
-	    uint32_t bytesOutput = 0;
-        uint8_t ackBuf[] = { 0xA5, 0x03, 0x00, 0x00, 0x00, 0x59, 0x02, 0xB2, 0xC1 };
-        error = hNurApi->TransportWriteDataFunction(hNurApi, ackBuf, sizeof(ackBuf), &bytesOutput);
-        if (error != NUR_SUCCESS)
-            return error;
-    }
+// Milliseconds left until the deadline of command in flight, 0 when expired
+static int XchTimeLeft(struct NUR_API_HANDLE *hNurApi, struct NUR_XCH_SLOT *slot)
+{
+	int32_t elapsed = XchElapsed(hNurApi, slot);
 
-	if (RxHeaderPtr->flags & PACKET_FLAG_UNSOL)
+	return (elapsed < slot->Timeout) ? (slot->Timeout - elapsed) : 0;
+}
+
+#ifdef CONFIG_LINK_STATS
+// Statistics entry of command; new commands take free entries, the rest go to Other
+static struct NUR_CMD_STATS *CmdStats(struct NUR_LINK_STATS *stats, uint8_t cmd)
+{
+	int i;
+
+	for (i = 0; i < NUR_STATS_CMDS; i++)
 	{
-	    // Unsolicited message received
-		if (hNurApi->UnsolEventHandler)
-		{
-			hNurApi->UnsolEventHandler(hNurApi);
+		if (stats->Cmds[i].Cmd == cmd)
+			return &stats->Cmds[i];
+		if (stats->Cmds[i].Cmd == 0) {
+			stats->Cmds[i].Cmd = cmd;
+			return &stats->Cmds[i];
 		}
 	}
+	return &stats->Other;
+}
 
-	if (cmd == 0)
+static void XchUpdateStats(struct NUR_API_HANDLE *hNurApi, struct NUR_XCH_SLOT *slot, int error)
+{
+	struct NUR_CMD_STATS *cs;
+	int32_t elapsed;
+	int bucket = 0;
+
+	if (slot->Cmd == 0)
+		return;	// Waiting for any packet, not a command
+
+	cs = CmdStats(hNurApi->Stats, slot->Cmd);
+	if (error == NUR_ERROR_TR_TIMEOUT)
 	{
-		// Waiting for unsolicited event's only, return now
-		return 0;
+		cs->Timeouts++;
+		hNurApi->Stats->Timeouts++;
 	}
-
-	// Make sure packet is meant for us
-	if (hNurApi->resp->cmd != cmd)
+	else if (error >= NUR_ERROR_INVALID_HANDLE)
+	{
+		// Failed read or write itself is counted where it happens
+		cs->TransportErrors++;
+	}
+	else
 	{
-		if (!(RxHeaderPtr->flags & PACKET_FLAG_UNSOL) && hNurApi->UnexpectedCmdHandler) {
-	        // Packet is not unsolicited message and response is not meant for this cmd.
-			// Pass to unexpected packet handler
-		    hNurApi->UnexpectedCmdHandler(hNurApi);
+		// Response received; log2 bucket of round-trip time
+		cs->Count++;
+		if (error != NUR_SUCCESS)
+			cs->Errors++;
+
+		elapsed = XchElapsed(hNurApi, slot);
+		while (elapsed > 0 && bucket < NUR_STATS_HIST_BUCKETS - 1) {
+			elapsed >>= 1;
+			bucket++;
 		}
-		// Wait for more (or process remaining)
-		goto WAITMORE;
+		cs->LatencyHist[bucket]++;
+	}
+}
+
+int NURAPICONV NurApiGetLinkStats(struct NUR_API_HANDLE *hNurApi, struct NUR_LINK_STATS *snapshot)
+{
+	if (!hNurApi->Stats || !snapshot)
+		return NUR_ERROR_INVALID_PARAMETER;
+
+	nurMemcpy(snapshot, hNurApi->Stats, sizeof(*snapshot));
+	return NUR_SUCCESS;
+}
+
+void NURAPICONV NurApiResetLinkStats(struct NUR_API_HANDLE *hNurApi)
+{
+	if (hNurApi->Stats)
+		nurMemset(hNurApi->Stats, 0, sizeof(*hNurApi->Stats));
+}
+#endif
+
+/*
+	Remove command from the window and notify the owner.
+	Returns TRUE if it was a synchronous exchange.
+*/
+static int XchComplete(struct NUR_API_HANDLE *hNurApi, int idx, int error)
+{
+	pXchCompleteFunction completeFn = hNurApi->XchSlots[idx].CompleteFunction;
+	uint8_t cmd = hNurApi->XchSlots[idx].Cmd;
+
+#ifdef CONFIG_LINK_STATS
+	if (hNurApi->Stats)
+		XchUpdateStats(hNurApi, &hNurApi->XchSlots[idx], error);
+#endif
+	if (cmd != 0) {
+		// Response data is valid unless the exchange failed in the API
+		XCH_TRACE(NUR_XCH_TRACE_END, cmd, (error == NUR_ERROR_TR_TIMEOUT || error >= NUR_ERROR_INVALID_HANDLE) ? 0 : hNurApi->respLen, error);
 	}
 
-	// Succeeded!
-	return hNurApi->resp->status;
+	hNurApi->XchPending--;
+	for (; idx < hNurApi->XchPending; idx++) {
+		hNurApi->XchSlots[idx] = hNurApi->XchSlots[idx + 1];
+	}
+	hNurApi->XchError = error;
+
+	// Callback may start a new exchange
+	if (completeFn) {
+		completeFn(hNurApi, cmd, error);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+// Complete all commands in flight with error
+static void XchCompleteAll(struct NUR_API_HANDLE *hNurApi, int error)
+{
+	while (hNurApi->XchPending)
+		XchComplete(hNurApi, 0, error);
+}
+
+// Complete commands whose deadline has passed, and count the wait round
+static void XchExpire(struct NUR_API_HANDLE *hNurApi)
+{
+	int idx = 0;
+
+	while (idx < hNurApi->XchPending)
+	{
+		if (XchTimeLeft(hNurApi, &hNurApi->XchSlots[idx]) == 0) {
+			// Response was not received within timeout
+			XchComplete(hNurApi, idx, NUR_ERROR_TR_TIMEOUT);
+		} else {
+			idx++;
+		}
+	}
+	hNurApi->XchRoundCount++;
+}
+
+#ifdef CONFIG_UNSOL_QUEUE
+
+#ifndef NUR_RELEASE_FENCE
+#if defined(__GNUC__)
+#define NUR_RELEASE_FENCE()	__atomic_thread_fence(__ATOMIC_RELEASE)
+#define NUR_ACQUIRE_FENCE()	__atomic_thread_fence(__ATOMIC_ACQUIRE)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+// x86 / x64 do not reorder stores with stores or loads with loads; compiler barrier is enough
+#define NUR_RELEASE_FENCE()	_ReadWriteBarrier()
+#define NUR_ACQUIRE_FENCE()	_ReadWriteBarrier()
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+#include <intrin.h>
+// ARM reorders both; data memory barrier over the inner shareable domain
+#define NUR_RELEASE_FENCE()	__dmb(_ARM64_BARRIER_ISH)
+#define NUR_ACQUIRE_FENCE()	__dmb(_ARM64_BARRIER_ISH)
+#elif defined(_MSC_VER) && defined(_M_ARM)
+#include <intrin.h>
+#define NUR_RELEASE_FENCE()	__dmb(_ARM_BARRIER_ISH)
+#define NUR_ACQUIRE_FENCE()	__dmb(_ARM_BARRIER_ISH)
+#elif defined(_MSC_VER)
+#include <windows.h>
+// Other targets: full barrier
+#define NUR_RELEASE_FENCE()	MemoryBarrier()
+#define NUR_ACQUIRE_FENCE()	MemoryBarrier()
+#else
+#error "Define NUR_RELEASE_FENCE() and NUR_ACQUIRE_FENCE() in NurApiConfig.h"
+#endif
+#endif
+
+// Slot: uint16_t length, uint16_t header flags, packet from cmd on
+#define UNSOL_SLOT_HDR				4
+#define UNSOL_SLOT_STRIDE(slotSize)	((UNSOL_SLOT_HDR + (uint32_t)(slotSize) + 3) & ~3UL)
+
+int NURAPICONV NurApiUnsolQueueInit(struct NUR_UNSOL_QUEUE *q, uint8_t *storage, uint32_t storageSize, uint16_t slotSize)
+{
+	uint32_t stride = UNSOL_SLOT_STRIDE(slotSize);
+	uint32_t count = 2;
+
+	if (!q || !storage || slotSize < 2)
+		return NUR_ERROR_INVALID_PARAMETER;
+	if (storageSize / stride < count)
+		return NUR_ERROR_BUFFER_TOO_SMALL;
+
+	while (storageSize / stride >= count * 2)
+		count *= 2;
+
+	nurMemset(q, 0, sizeof(*q));
+	q->Storage = storage;
+	q->SlotCount = count;
+	q->SlotSize = slotSize;
+
+	return NUR_SUCCESS;
+}
+
+int NURAPICONV NurApiUnsolQueuePeek(struct NUR_UNSOL_QUEUE *q, struct NUR_CMD_RESP **resp, uint32_t *respLen, uint16_t *flags)
+{
+	uint32_t tail = q->Tail;
+	uint8_t *slot;
+
+	if (q->Head == tail)
+		return NUR_ERROR_NO_PAYLOAD;
+
+	// Slot contents are read after seeing the new head
+	NUR_ACQUIRE_FENCE();
+
+	slot = q->Storage + (tail & (q->SlotCount - 1)) * UNSOL_SLOT_STRIDE(q->SlotSize);
+	*resp = (struct NUR_CMD_RESP *)(slot + UNSOL_SLOT_HDR);
+	*respLen = BytesToWord(slot) - 2;	// - cmd - status
+	if (flags)
+		*flags = BytesToWord(slot + 2);
+
+	return NUR_SUCCESS;
+}
+
+void NURAPICONV NurApiUnsolQueuePop(struct NUR_UNSOL_QUEUE *q)
+{
+	// Slot is read completely before producer may reuse it
+	NUR_RELEASE_FENCE();
+	q->Tail = q->Tail + 1;
+}
+
+// Copy received unsolicited packet to queue (producer side)
+static void UnsolQueuePut(struct NUR_API_HANDLE *hNurApi)
+{
+	struct NUR_UNSOL_QUEUE *q = hNurApi->UnsolQueue;
+	uint32_t len = hNurApi->respLen + 2;	// + cmd + status
+	uint32_t head = q->Head;
+	uint32_t depth;
+	uint8_t *slot;
+
+	if (len > q->SlotSize) {
+		q->DroppedTooLong++;
+		return;
+	}
+
+	depth = head - q->Tail;
+	if (depth >= q->SlotCount) {
+		q->DroppedFull++;
+		return;
+	}
+	// Slot is written after seeing it released
+	NUR_ACQUIRE_FENCE();
+
+	slot = q->Storage + (head & (q->SlotCount - 1)) * UNSOL_SLOT_STRIDE(q->SlotSize);
+	PacketWordPos(slot, (uint16_t)len, 0);
+	PacketWordPos(slot, RxHeaderPtr->flags, 2);
+	nurMemcpy(slot + UNSOL_SLOT_HDR, RxPayloadCmdPtr, len);
+
+	// Publish slot contents before the new head
+	NUR_RELEASE_FENCE();
+	q->Head = head + 1;
+
+	q->Queued++;
+	if (depth + 1 > q->MaxDepth)
+		q->MaxDepth = depth + 1;
+}
+
+#endif
+
+#if defined(CONFIG_TAG_TABLE) || defined(CONFIG_PRESENCE)
+
+#if (NUR_TAGTABLE_MAX_EPC % 4) != 0 || NUR_TAGTABLE_MAX_EPC < 12
+#error "NUR_TAGTABLE_MAX_EPC must be a multiple of 4, at least 12"
+#endif
+
+// 32-bit mix (lowbias32); spreads serial numbers in the last EPC bytes over all slot bits
+static uint32_t TagHashMix(uint32_t h)
+{
+	h ^= h >> 16;
+	h *= 0x7FEB352DUL;
+	h ^= h >> 15;
+	h *= 0x846CA68BUL;
+	h ^= h >> 16;
+	return h ? h : 1;	// Zero marks an empty slot
+}
+
+// 96-bit EPC, the common case: three words, no loop
+#define TagHash96(w)	TagHashMix(((w)[0] * 0x9E3779B1UL) ^ ((w)[1] * 0x85EBCA77UL) ^ ((w)[2] * 0xC2B2AE3DUL) ^ 12)
+
+static uint32_t TagHash(const uint32_t *words, uint8_t epcLen)
+{
+	uint32_t h = epcLen;
+	int n, count = (epcLen + 3) / 4;
+
+	if (epcLen == 12)
+		return TagHash96(words);
+
+	for (n = 0; n < count; n++)
+		h = (h ^ words[n]) * 0x9E3779B1UL + (h >> 15);
+	return TagHashMix(h);
+}
+
+// EPC as zero padded words, as stored in struct NUR_TAG_ENTRY
+static void TagKey(uint32_t *words, const uint8_t *epc, uint8_t epcLen)
+{
+	words[(epcLen - 1) / 4] = 0;
+	nurMemcpy(words, epc, epcLen);
+}
+
+#endif
+
+#ifdef CONFIG_TAG_TABLE
+
+static struct NUR_TAG_ENTRY *TagTableLookup(struct NUR_TAG_TABLE *t, const uint32_t *words, uint8_t epcLen, uint32_t hash)
+{
+	uint32_t idx = hash & t->SlotMask;
+	struct NUR_TAG_ENTRY *e;
+
+	if (epcLen == 12)
+	{
+		for (;; idx = (idx + 1) & t->SlotMask)
+		{
+			e = &t->Slots[idx];
+			if (e->Hash == 0)
+				return e;
+			if (e->Hash == hash && e->EpcLen == 12 &&
+				e->Epc.Words[0] == words[0] && e->Epc.Words[1] == words[1] && e->Epc.Words[2] == words[2])
+				return e;
+		}
+	}
+
+	for (;; idx = (idx + 1) & t->SlotMask)
+	{
+		e = &t->Slots[idx];
+		if (e->Hash == 0)
+			return e;
+		if (e->Hash == hash && e->EpcLen == epcLen)
+		{
+			int n, count = (epcLen + 3) / 4;
+			for (n = 0; n < count && e->Epc.Words[n] == words[n]; n++)
+				;
+			if (n == count)
+				return e;
+		}
+	}
+}
+
+int NURAPICONV NurApiTagTableInit(struct NUR_TAG_TABLE *t, struct NUR_TAG_ENTRY *slots, uint32_t slotCount)
+{
+	uint32_t count = 4;
+
+	if (!t || !slots)
+		return NUR_ERROR_INVALID_PARAMETER;
+	if (slotCount < count)
+		return NUR_ERROR_BUFFER_TOO_SMALL;
+
+	while (slotCount / 2 >= count)
+		count *= 2;
+
+	nurMemset(t, 0, sizeof(*t));
+	t->Slots = slots;
+	t->SlotMask = count - 1;
+	t->MaxCount = count - count / 4;
+	NurApiTagTableClear(t);
+
+	return NUR_SUCCESS;
+}
+
+void NURAPICONV NurApiTagTableClear(struct NUR_TAG_TABLE *t)
+{
+	uint32_t idx;
+
+	for (idx = 0; idx <= t->SlotMask; idx++)
+		t->Slots[idx].Hash = 0;
+	t->Count = 0;
+}
+
+int NURAPICONV NurApiTagTableAdd(struct NUR_TAG_TABLE *t, struct NUR_IDBUFFER_ENTRY *tag, uint32_t now, struct NUR_TAG_ENTRY **entry)
+{
+	uint32_t words[NUR_TAGTABLE_MAX_EPC / 4];
+	uint32_t hash;
+	struct NUR_TAG_ENTRY *e;
+
+	if (entry)
+		*entry = NULL;
+	if (tag->epcLen == 0 || tag->epcLen > NUR_TAGTABLE_MAX_EPC) {
+		t->Dropped++;
+		return NUR_ERROR_INVALID_LENGTH;
+	}
+
+	TagKey(words, tag->epcData, tag->epcLen);
+	hash = TagHash(words, tag->epcLen);
+	e = TagTableLookup(t, words, tag->epcLen, hash);
+
+	if (e->Hash == 0)
+	{
+		if (t->Count >= t->MaxCount) {
+			t->Dropped++;
+			return NUR_ERROR_BUFFER_TOO_SMALL;
+		}
+		nurMemset(e, 0, sizeof(*e));
+		nurMemcpy(e->Epc.Words, words, ((tag->epcLen + 3) / 4) * 4);
+		e->Hash = hash;
+		e->EpcLen = tag->epcLen;
+		e->FirstSeen = now;
+		e->MaxRssi = tag->rssi;
+		t->Count++;
+	}
+
+	e->LastSeen = now;
+	e->ReadCount++;
+	e->RssiSum += tag->rssi;
+	if (tag->rssi > e->MaxRssi)
+		e->MaxRssi = tag->rssi;
+	e->LastAntenna = tag->antennaId;
+
+	if (entry)
+		*entry = e;
+	return NUR_SUCCESS;
+}
+
+struct NUR_TAG_ENTRY * NURAPICONV NurApiTagTableFind(struct NUR_TAG_TABLE *t, const uint8_t *epc, uint8_t epcLen)
+{
+	uint32_t words[NUR_TAGTABLE_MAX_EPC / 4];
+	struct NUR_TAG_ENTRY *e;
+
+	if (epcLen == 0 || epcLen > NUR_TAGTABLE_MAX_EPC)
+		return NULL;
+
+	TagKey(words, epc, epcLen);
+	e = TagTableLookup(t, words, epcLen, TagHash(words, epcLen));
+	return e->Hash ? e : NULL;
+}
+
+int NURAPICONV NurApiTagTableRemove(struct NUR_TAG_TABLE *t, struct NUR_TAG_ENTRY *entry)
+{
+	uint32_t hole, idx, home;
+
+	if (entry < t->Slots || entry > &t->Slots[t->SlotMask] || entry->Hash == 0)
+		return NUR_ERROR_INVALID_PARAMETER;
+
+	// Backward shift: move later entries of the probe run into the hole when their home slot allows
+	hole = (uint32_t)(entry - t->Slots);
+	for (idx = (hole + 1) & t->SlotMask; t->Slots[idx].Hash != 0; idx = (idx + 1) & t->SlotMask)
+	{
+		home = t->Slots[idx].Hash & t->SlotMask;
+		if (((idx - home) & t->SlotMask) >= ((idx - hole) & t->SlotMask))
+		{
+			t->Slots[hole] = t->Slots[idx];
+			hole = idx;
+		}
+	}
+	t->Slots[hole].Hash = 0;
+	t->Count--;
+
+	return NUR_SUCCESS;
+}
+
+#endif
+
+#ifdef CONFIG_TAG_ARENA
+
+#define TAG_RECORD_SIZE(bytes)	((sizeof(struct NUR_TAG_RECORD) + (uint32_t)(bytes) + 3) & ~3UL)
+
+int NURAPICONV NurApiTagArenaInit(struct NUR_TAG_ARENA *a, uint8_t *storage, uint32_t storageSize)
+{
+	if (!a || !storage || ((uintptr_t)storage & 3) != 0)
+		return NUR_ERROR_INVALID_PARAMETER;
+	if (storageSize < TAG_RECORD_SIZE(0))
+		return NUR_ERROR_BUFFER_TOO_SMALL;
+
+	nurMemset(a, 0, sizeof(*a));
+	a->Storage = storage;
+	a->Size = storageSize & ~3UL;
+
+	return NUR_SUCCESS;
+}
+
+void NURAPICONV NurApiTagArenaReset(struct NUR_TAG_ARENA *a)
+{
+	a->Used = 0;
+	a->Count = 0;
+}
+
+int NURAPICONV NurApiTagArenaAdd(struct NUR_TAG_ARENA *a, struct NUR_IDBUFFER_ENTRY *tag, struct NUR_TAG_RECORD **record)
+{
+	uint32_t bytes = (uint32_t)tag->epcLen + tag->dataLen;
+	uint32_t size = TAG_RECORD_SIZE(bytes);
+	struct NUR_TAG_RECORD *rec;
+
+	if (record)
+		*record = NULL;
+	if (size > a->Size - a->Used) {
+		a->Dropped++;
+		return NUR_ERROR_BUFFER_TOO_SMALL;
+	}
+
+	rec = (struct NUR_TAG_RECORD *)(a->Storage + a->Used);
+	rec->freq = tag->freq;
+	rec->timestamp = tag->timestamp;
+	rec->pc = tag->pc;
+	rec->rssi = tag->rssi;
+	rec->scaledRssi = tag->scaledRssi;
+	rec->channel = tag->channel;
+	rec->antennaId = tag->antennaId;
+	rec->epcLen = tag->epcLen;
+	rec->dataLen = tag->dataLen;
+	rec->size = (uint16_t)size;
+	// Inventory read data follows EPC in the response too
+	nurMemcpy(NUR_TAG_RECORD_EPC(rec), tag->epcData, bytes);
+
+	a->Used += size;
+	a->Count++;
+	if (a->Used > a->HighWater)
+		a->HighWater = a->Used;
+	if (a->Count > a->HighWaterCount)
+		a->HighWaterCount = a->Count;
+
+	if (record)
+		*record = rec;
+	return NUR_SUCCESS;
+}
+
+struct NUR_TAG_RECORD * NURAPICONV NurApiTagArenaNext(struct NUR_TAG_ARENA *a, struct NUR_TAG_RECORD *record)
+{
+	uint32_t pos = record ? (uint32_t)((uint8_t *)record - a->Storage) + record->size : 0;
+
+	return (pos < a->Used) ? (struct NUR_TAG_RECORD *)(a->Storage + pos) : NULL;
+}
+
+#endif
+
+#ifdef CONFIG_PRESENCE
+
+#if NUR_PRESENCE_WHEEL_SLOTS < 4
+#error "NUR_PRESENCE_WHEEL_SLOTS must be at least 4"
+#endif
+
+#define PRESENCE_NONE	0xFFFFFFFFUL
+
+static struct NUR_PRESENCE_TAG *PresenceLookup(struct NUR_PRESENCE *p, const uint32_t *words, uint8_t epcLen, uint32_t hash)
+{
+	struct NUR_PRESENCE_TAG *e;
+	uint32_t idx;
+	int n, count = (epcLen + 3) / 4;
+
+	for (idx = p->Buckets[hash & p->BucketMask]; idx != PRESENCE_NONE; idx = e->HashNext)
+	{
+		e = &p->Tags[idx];
+		if (e->Hash == hash && e->EpcLen == epcLen)
+		{
+			for (n = 0; n < count && e->Epc.Words[n] == words[n]; n++)
+				;
+			if (n == count)
+				return e;
+		}
+	}
+	return NULL;
+}
+
+// Put tag to the wheel slot that is checked first at or after its departure time
+static void PresenceSchedule(struct NUR_PRESENCE *p, uint32_t idx)
+{
+	struct NUR_PRESENCE_TAG *e = &p->Tags[idx];
+	int32_t d = (int32_t)(e->LastSeen + p->Timeout - p->TickEnd);
+	uint32_t ahead = (d < 0) ? 0 : 1 + (uint32_t)d / p->Tick;
+	uint32_t slot;
+
+	// Farther than the wheel reaches (read time ahead of Advance): checked again when the slot comes around
+	if (ahead > NUR_PRESENCE_WHEEL_SLOTS - 1)
+		ahead = NUR_PRESENCE_WHEEL_SLOTS - 1;
+
+	slot = (p->WheelPos + ahead) % NUR_PRESENCE_WHEEL_SLOTS;
+	e->WheelNext = p->Wheel[slot];
+	p->Wheel[slot] = idx;
+}
+
+static void PresenceArrive(struct NUR_PRESENCE *p, struct NUR_PRESENCE_TAG *e, struct NUR_IDBUFFER_ENTRY *tag, uint32_t t)
+{
+	e->Arrived = t;
+	e->LastSeen = t;
+	e->ReadCount = 1;
+	e->LastRssi = tag->rssi;
+	e->MaxRssi = tag->rssi;
+	e->LastAntenna = tag->antennaId;
+	p->Arrivals++;
+	if (p->EventFunction)
+		p->EventFunction(p, e, NUR_PRESENCE_ARRIVE);
+}
+
+static void PresenceDepart(struct NUR_PRESENCE *p, struct NUR_PRESENCE_TAG *e)
+{
+	p->Departures++;
+	if (p->EventFunction)
+		p->EventFunction(p, e, NUR_PRESENCE_DEPART);
+}
+
+// Check tags of a wheel slot: depart those not read for Timeout, reschedule the rest.
+// Reads only update LastSeen, so a tag read often is moved once per Timeout, not on every read.
+static void PresenceCheck(struct NUR_PRESENCE *p, uint32_t list, uint32_t now)
+{
+	struct NUR_PRESENCE_TAG *e;
+	uint32_t idx, *link;
+
+	while (list != PRESENCE_NONE)
+	{
+		idx = list;
+		e = &p->Tags[idx];
+		list = e->WheelNext;
+
+		if ((int32_t)(now - (e->LastSeen + p->Timeout)) < 0) {
+			PresenceSchedule(p, idx);
+			continue;
+		}
+
+		PresenceDepart(p, e);
+
+		for (link = &p->Buckets[e->Hash & p->BucketMask]; *link != idx; link = &p->Tags[*link].HashNext)
+			;
+		*link = e->HashNext;
+		e->EpcLen = 0;
+		e->HashNext = p->FreeTag;
+		p->FreeTag = idx;
+		p->Count--;
+	}
+}
+
+int NURAPICONV NurApiPresenceInit(struct NUR_PRESENCE *p, struct NUR_PRESENCE_TAG *tags, uint32_t tagCount, uint32_t *buckets, uint32_t bucketCount, uint32_t timeout, uint32_t now)
+{
+	uint32_t count = 1;
+
+	if (!p || !tags || !buckets || tagCount == 0 || tagCount >= PRESENCE_NONE || timeout == 0 || timeout > 0x7FFFFFFFUL)
+		return NUR_ERROR_INVALID_PARAMETER;
+	if (bucketCount < count)
+		return NUR_ERROR_BUFFER_TOO_SMALL;
+
+	while (bucketCount / 2 >= count)
+		count *= 2;
+
+	nurMemset(p, 0, sizeof(*p));
+	p->Tags = tags;
+	p->TagCount = tagCount;
+	p->Buckets = buckets;
+	p->BucketMask = count - 1;
+	p->Timeout = timeout;
+	p->Tick = (timeout + NUR_PRESENCE_WHEEL_SLOTS - 3) / (NUR_PRESENCE_WHEEL_SLOTS - 2);
+	p->TickEnd = now + p->Tick;
+	NurApiPresenceClear(p);
+
+	return NUR_SUCCESS;
+}
+
+void NURAPICONV NurApiPresenceClear(struct NUR_PRESENCE *p)
+{
+	uint32_t idx;
+
+	for (idx = 0; idx <= p->BucketMask; idx++)
+		p->Buckets[idx] = PRESENCE_NONE;
+	for (idx = 0; idx < NUR_PRESENCE_WHEEL_SLOTS; idx++)
+		p->Wheel[idx] = PRESENCE_NONE;
+	for (idx = 0; idx < p->TagCount; idx++) {
+		p->Tags[idx].EpcLen = 0;
+		p->Tags[idx].HashNext = idx + 1;
+	}
+	p->Tags[p->TagCount - 1].HashNext = PRESENCE_NONE;
+	p->FreeTag = 0;
+	p->Count = 0;
+}
+
+int NURAPICONV NurApiPresenceUpdate(struct NUR_PRESENCE *p, struct NUR_IDBUFFER_ENTRY *tag, uint32_t now)
+{
+	uint32_t words[NUR_TAGTABLE_MAX_EPC / 4];
+	uint32_t hash, idx, t;
+	struct NUR_PRESENCE_TAG *e;
+
+	if (tag->epcLen == 0 || tag->epcLen > NUR_TAGTABLE_MAX_EPC) {
+		p->Dropped++;
+		return NUR_ERROR_INVALID_LENGTH;
+	}
+
+	t = (p->Flags & NUR_PRESENCE_MODULE_TIME) ? now + tag->timestamp : now;
+	TagKey(words, tag->epcData, tag->epcLen);
+	hash = TagHash(words, tag->epcLen);
+	e = PresenceLookup(p, words, tag->epcLen, hash);
+
+	if (e)
+	{
+		if ((int32_t)(t - (e->LastSeen + p->Timeout)) >= 0) {
+			// Gone for Timeout before NurApiPresenceAdvance() got to it; keeps its wheel slot
+			PresenceDepart(p, e);
+			PresenceArrive(p, e, tag, t);
+			return NUR_SUCCESS;
+		}
+		if ((int32_t)(t - e->LastSeen) > 0)
+			e->LastSeen = t;
+		e->ReadCount++;
+		e->LastRssi = tag->rssi;
+		if (tag->rssi > e->MaxRssi)
+			e->MaxRssi = tag->rssi;
+		e->LastAntenna = tag->antennaId;
+		return NUR_SUCCESS;
+	}
+
+	idx = p->FreeTag;
+	if (idx == PRESENCE_NONE) {
+		p->Dropped++;
+		return NUR_ERROR_BUFFER_TOO_SMALL;
+	}
+	e = &p->Tags[idx];
+	p->FreeTag = e->HashNext;
+
+	nurMemcpy(e->Epc.Words, words, ((tag->epcLen + 3) / 4) * 4);
+	e->Hash = hash;
+	e->EpcLen = tag->epcLen;
+	e->HashNext = p->Buckets[hash & p->BucketMask];
+	p->Buckets[hash & p->BucketMask] = idx;
+	p->Count++;
+
+	PresenceArrive(p, e, tag, t);
+	PresenceSchedule(p, idx);
+
+	return NUR_SUCCESS;
+}
+
+void NURAPICONV NurApiPresenceAdvance(struct NUR_PRESENCE *p, uint32_t now)
+{
+	uint32_t list, idx, slot;
+
+	if ((int32_t)(now - p->TickEnd) < 0)
+		return;
+
+	if ((now - p->TickEnd) / p->Tick >= NUR_PRESENCE_WHEEL_SLOTS)
+	{
+		// Whole wheel passed since last call: check all tags once and restart the wheel from now
+		list = PRESENCE_NONE;
+		for (slot = 0; slot < NUR_PRESENCE_WHEEL_SLOTS; slot++)
+		{
+			while ((idx = p->Wheel[slot]) != PRESENCE_NONE) {
+				p->Wheel[slot] = p->Tags[idx].WheelNext;
+				p->Tags[idx].WheelNext = list;
+				list = idx;
+			}
+		}
+		p->TickEnd = now + p->Tick;
+		PresenceCheck(p, list, now);
+		return;
+	}
+
+	while ((int32_t)(now - p->TickEnd) >= 0)
+	{
+		list = p->Wheel[p->WheelPos];
+		p->Wheel[p->WheelPos] = PRESENCE_NONE;
+		p->WheelPos = (p->WheelPos + 1) % NUR_PRESENCE_WHEEL_SLOTS;
+		p->TickEnd += p->Tick;
+		PresenceCheck(p, list, now);
+	}
+}
+
+struct NUR_PRESENCE_TAG * NURAPICONV NurApiPresenceFind(struct NUR_PRESENCE *p, const uint8_t *epc, uint8_t epcLen)
+{
+	uint32_t words[NUR_TAGTABLE_MAX_EPC / 4];
+
+	if (epcLen == 0 || epcLen > NUR_TAGTABLE_MAX_EPC)
+		return NULL;
+
+	TagKey(words, epc, epcLen);
+	return PresenceLookup(p, words, epcLen, TagHash(words, epcLen));
+}
+
+#endif
+
+#ifdef CONFIG_INVENTORY_STREAM
+int NURAPICONV ParseIdBuffer(struct NUR_API_HANDLE *hNurApi, pFetchTagsFunction tagFunc, uint8_t *buffer, uint32_t bufferLen, int32_t includeMeta, int32_t includeIrData);
+
+// Notification sent by the module for the running stream
+#define InvStreamNotifyCmd(st)	((st)->ExParams ? NUR_NOTIFY_INVENTORYEX : NUR_NOTIFY_INVENTORY)
+
+/*
+	Tag callback of a notification: counts every tag and passes it to TagFunction unless the stream
+	is paused or TagFunction refused an earlier tag of the same notification.
+*/
+static int InvStreamTag(struct NUR_API_HANDLE *hNurApi, struct NUR_IDBUFFER_ENTRY *tag)
+{
+	struct NUR_INVENTORY_STREAM *st = hNurApi->InvStream;
+
+	st->TagsFound++;
+	if (st->Refused || st->State == NUR_INVSTREAM_PAUSE || st->State == NUR_INVSTREAM_PAUSING || st->State == NUR_INVSTREAM_PAUSED)
+	{
+		st->TagsDropped++;
+	}
+	else if (st->TagFunction(hNurApi, tag) != NUR_SUCCESS)
+	{
+		// Consumer is full: rest of the tags are lost, stop the stream until it is resumed
+		st->Refused = TRUE;
+		st->TagsDropped++;
+		if (st->State == NUR_INVSTREAM_RUNNING || st->State == NUR_INVSTREAM_START) {
+			st->State = NUR_INVSTREAM_PAUSE;
+			st->Pauses++;
+		}
+	}
+	else
+	{
+		st->Tags++;
+	}
+	return NUR_SUCCESS;
+}
+
+/*
+	Inventory stream notification: stopped, roundsDone, collisions (u16), Q, then tags as in NUR_CMD_GETMETABUF.
+	Same for NUR_NOTIFY_INVENTORY and NUR_NOTIFY_INVENTORYEX.
+	Tags are parsed once, in place from the RX buffer; the API does not copy or queue them.
+*/
+static void InvStreamNotify(struct NUR_API_HANDLE *hNurApi)
+{
+	struct NUR_INVENTORY_STREAM *st = hNurApi->InvStream;
+	uint8_t *data = hNurApi->resp->rawdata;
+	uint32_t len = RxPayloadLen;
+	int irData = (RxHeaderPtr->flags & PACKET_FLAG_IRDATA) != 0;
+
+	if (len < 5)
+		return;
+
+	st->Notifications++;
+	st->RoundsDone = data[1];
+	st->Collisions = (uint16_t)(data[2] | (data[3] << 8));
+	st->Q = data[4];
+
+	st->TagsFound = 0;
+	st->Refused = FALSE;
+	ParseIdBuffer(hNurApi, InvStreamTag, data + 5, len - 5, TRUE, irData);
+	if (st->RoundFunction)
+		st->RoundFunction(hNurApi, st);
+
+	if (data[0])
+	{
+		// Module stopped the stream (e.g. stream timeout)
+		if (st->State == NUR_INVSTREAM_RUNNING) {
+			st->State = NUR_INVSTREAM_START;
+			st->Restarts++;
+		}
+		else if (st->State == NUR_INVSTREAM_PAUSE) {
+			st->State = NUR_INVSTREAM_PAUSED;
+		}
+	}
+}
+#endif
+
+// hNurApi->FetchRange, see NurApiFetchTagsChunked()
+#define FETCH_RANGE_UNKNOWN	0
+#define FETCH_RANGE_NO		1
+#define FETCH_RANGE_YES		2
+
+/*
+	Handle one received packet (hNurApi->resp).
+	Returns TRUE if the packet completed a synchronous exchange; response must then be left untouched.
+*/
+static int XchDispatchPacket(struct NUR_API_HANDLE *hNurApi)
+{
+	int idx;
+
+	STATS_ADD(PacketsIn, 1);
+
+	if (RxHeaderPtr->flags & PACKET_FLAG_ACK)
+	{
+		// ACK requested by NUR
+		static const uint8_t ackBuf[] = { 0xA5, 0x03, 0x00, 0x00, 0x00, 0x59, 0x02, 0xB2, 0xC1 };
+		struct NUR_IOVEC iov = { ackBuf, sizeof(ackBuf) };
+		int error = TransportWrite(hNurApi, &iov, 1, DEF_TIMEOUT);
+		if (error != NUR_SUCCESS && hNurApi->XchPending)
+		{
+			return XchComplete(hNurApi, 0, error);
+		}
+	}
+
+	if (RxHeaderPtr->flags & PACKET_FLAG_UNSOL)
+	{
+		// Unsolicited message received
+		STATS_ADD(UnsolPackets, 1);
+		if (hNurApi->resp->cmd == NUR_NOTIFY_BOOT)
+		{
+			// Module restarted, maybe with other firmware
+			hNurApi->FetchRange = FETCH_RANGE_UNKNOWN;
+		}
+#ifdef CONFIG_INVENTORY_STREAM
+		if (hNurApi->InvStream && hNurApi->resp->cmd == InvStreamNotifyCmd(hNurApi->InvStream))
+		{
+			InvStreamNotify(hNurApi);
+		}
+		else
+#endif
+#ifdef CONFIG_UNSOL_QUEUE
+		if (hNurApi->UnsolQueue)
+		{
+			UnsolQueuePut(hNurApi);
+		}
+		else
+#endif
+		if (hNurApi->UnsolEventHandler)
+		{
+			hNurApi->UnsolEventHandler(hNurApi);
+		}
+	}
+
+	// Module answers in order; response belongs to the oldest command with the same cmd.
+	// Zero cmd is waiting for unsolicited event's only, any packet completes it.
+	for (idx = 0; idx < hNurApi->XchPending; idx++)
+	{
+		if (hNurApi->XchSlots[idx].Cmd == 0)
+			return XchComplete(hNurApi, idx, NUR_SUCCESS);
+		if (hNurApi->XchSlots[idx].Cmd == hNurApi->resp->cmd)
+			return XchComplete(hNurApi, idx, hNurApi->resp->status);
+	}
+
+	if (!(RxHeaderPtr->flags & PACKET_FLAG_UNSOL)) {
+		// Packet is not unsolicited message and nobody is waiting for this cmd.
+		// Pass to unexpected packet handler
+		STATS_ADD(UnexpectedPackets, 1);
+		if (hNurApi->UnexpectedCmdHandler)
+			hNurApi->UnexpectedCmdHandler(hNurApi);
+	}
+	// Wait for more
+	return FALSE;
+}
+
+// Parse and dispatch packets in RX buffer (zero-copy mode)
+static void XchProcessRxBuffer(struct NUR_API_HANDLE *hNurApi)
+{
+	while (NurApiHandleRxBufferData(hNurApi) == STATE_PACKETREADY)
+	{
+		if (XchDispatchPacket(hNurApi))
+			break;
+	}
+}
+
+// Send command and add it to the window. NULL completeFn marks the synchronous exchange of NurApiXchPacketVec().
+static int XchStartVec(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, const struct NUR_IOVEC *extPayload, int extCnt, int timeout, pXchCompleteFunction completeFn)
+{
+	int error;
+	int i, iovCnt = 0;
+	uint32_t totalLen = payloadLen;
+	uint16_t payloadCRC;
+	struct NUR_IOVEC iov[NUR_MAX_IOVEC];
+	struct NUR_XCH_SLOT *slot;
+
+	if (hNurApi->XchPending >= NUR_XCH_WINDOW || hNurApi->XchInPoll) {
+		// Window is full, or received data in TxBuffer is still being handled
+		return NUR_ERROR_NOT_READY;
+	}
+
+	if (extCnt < 0 || extCnt > NUR_MAX_IOVEC - 2)
+		return NUR_ERROR_INVALID_PARAMETER;
+
+	if (cmd != 0)
+	{
+		for (i = 0; i < extCnt; i++)
+			totalLen += extPayload[i].len;
+
+		// Setup packet header
+		TxHeaderPtr->start = PACKET_START;
+		TxHeaderPtr->flags = 0;
+		TxHeaderPtr->payloadlen = (uint16_t)(totalLen + 1 + 2); // + cmd + CRC
+
+		if (totalLen + 1 + 2 > NUR_MAX_SEND_SZ)
+			return NUR_ERROR_PACKET_TOO_LONG;
+
+		TxHeaderPtr->checksum = CalculateHeaderCheckSum(TxHeaderDataPtr);
+		TxPayloadCmdPtr[0] = cmd;
+
+		// CRC for whole payload, including CMD and caller's segments
+		payloadCRC = NurCRC16(CRC16_START, TxPayloadCmdPtr, payloadLen + 1);
+		for (i = 0; i < extCnt; i++)
+			payloadCRC = NurCRC16(payloadCRC, (uint8_t *)extPayload[i].data, extPayload[i].len);
+
+		// Header, cmd and payload in TxBuffer, caller's segments and CRC (stored after payload in TxBuffer)
+		PacketWordPos(TxPayloadDataPtr, payloadCRC, payloadLen);
+		iov[iovCnt].data = hNurApi->TxBuffer;
+		iov[iovCnt++].len = HDR_SIZE + 1 + payloadLen;
+		for (i = 0; i < extCnt; i++)
+			iov[iovCnt++] = extPayload[i];
+		iov[iovCnt].data = TxPayloadDataPtr + payloadLen;
+		iov[iovCnt++].len = 2;
+
+		// Write packet to module
+		XCH_TRACE(NUR_XCH_TRACE_BEGIN, cmd, totalLen, NUR_SUCCESS);
+		error = TransportWrite(hNurApi, iov, iovCnt, timeout);
+		XCH_TRACE(NUR_XCH_TRACE_SENT, cmd, totalLen, error);
+		if (error != NUR_SUCCESS) {
+			STATS_ADD(TransportErrors, 1);
+			return error;
+		}
+		STATS_ADD(PacketsOut, 1);
+	}
+
+	slot = &hNurApi->XchSlots[hNurApi->XchPending++];
+	slot->CompleteFunction = completeFn;
+	slot->Cmd = cmd;
+	slot->Timeout = timeout;
+	slot->StartRound = hNurApi->XchRoundCount;
+	slot->StartTick = hNurApi->GetTickCountFunction ? hNurApi->GetTickCountFunction(hNurApi) : 0;
+
+	return NUR_SUCCESS;
+}
+
+int NURAPICONV NurApiXchStartVec(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, const struct NUR_IOVEC *extPayload, int extCnt, int timeout, pXchCompleteFunction completeFn)
+{
+	// Without callback the response would end the read loop of a synchronous call
+	if (completeFn == NULL)
+		return NUR_ERROR_INVALID_PARAMETER;
+
+	return XchStartVec(hNurApi, cmd, payloadLen, extPayload, extCnt, timeout, completeFn);
+}
+
+int NURAPICONV NurApiXchStart(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, int timeout, pXchCompleteFunction completeFn)
+{
+	return NurApiXchStartVec(hNurApi, cmd, payloadLen, NULL, 0, timeout, completeFn);
+}
+
+int NURAPICONV NurApiXchFeed(struct NUR_API_HANDLE *hNurApi, const uint8_t *data, uint32_t dataLen, uint32_t *bytesUsed)
+{
+	uint32_t processPos = 0;
+
+	XCH_TRACE(NUR_XCH_TRACE_RX, 0, dataLen, NUR_SUCCESS);
+
+	if (hNurApi->Flags & NUR_HANDLE_FLAG_ZEROCOPY_RX)
+	{
+		// Append to RX buffer, unless the data was read there already
+		if (data != hNurApi->RxBuffer + hNurApi->RxBufferUsed)
+		{
+			// Previous packet is removed before appending
+			ReleaseRxPacket(hNurApi);
+			if (dataLen > hNurApi->RxBufferLen - hNurApi->RxBufferUsed)
+				dataLen = hNurApi->RxBufferLen - hNurApi->RxBufferUsed;
+			nurMemcpy(hNurApi->RxBuffer + hNurApi->RxBufferUsed, data, dataLen);
+		}
+		hNurApi->RxBufferUsed += dataLen;
+		STATS_ADD(BytesIn, dataLen);
+		XchProcessRxBuffer(hNurApi);
+		processPos = dataLen;
+	}
+	else
+	{
+		while (processPos < dataLen)
+		{
+			if (HandlePacketData(hNurApi, data, &processPos, &dataLen) == STATE_PACKETREADY)
+			{
+				if (XchDispatchPacket(hNurApi))
+					break;
+			}
+		}
+	}
+
+	if (bytesUsed)
+		*bytesUsed = processPos;
+
+	return NUR_SUCCESS;
+}
+
+// One transport read that may block up to readTimeout ms, all received data is handled. Returns read result.
+static int XchReadFeed(struct NUR_API_HANDLE *hNurApi, uint32_t readTimeout)
+{
+	int error;
+	uint32_t bytesRead = 0;
+
+	hNurApi->TransportReadTimeout = readTimeout;
+
+	if (hNurApi->Flags & NUR_HANDLE_FLAG_ZEROCOPY_RX)
+	{
+		// Previous packet is removed to make room
+		ReleaseRxPacket(hNurApi);
+		error = hNurApi->TransportReadDataFunction(hNurApi, hNurApi->RxBuffer + hNurApi->RxBufferUsed, hNurApi->RxBufferLen - hNurApi->RxBufferUsed, &bytesRead);
+		if (error == NUR_SUCCESS)
+			NurApiXchFeed(hNurApi, hNurApi->RxBuffer + hNurApi->RxBufferUsed, bytesRead, NULL);
+	}
+	else
+	{
+		error = hNurApi->TransportReadDataFunction(hNurApi, hNurApi->TxBuffer, hNurApi->TxBufferLen, &bytesRead);
+		if (error == NUR_SUCCESS)
+		{
+			// TxBuffer must not be overwritten by callbacks until all data is handled
+			hNurApi->XchInPoll = TRUE;
+			NurApiXchFeed(hNurApi, hNurApi->TxBuffer, bytesRead, NULL);
+			hNurApi->XchInPoll = FALSE;
+		}
+	}
+
+	return error;
+}
+
+int NURAPICONV NurApiXchPoll(struct NUR_API_HANDLE *hNurApi)
+{
+	// Do not block, read only what is already available
+	int error = XchReadFeed(hNurApi, 0);
+
+	if (error != NUR_SUCCESS && error != NUR_ERROR_TR_TIMEOUT)
+	{
+		// Transport error
+		STATS_ADD(TransportErrors, 1);
+		XchCompleteAll(hNurApi, error);
+		return error;
+	}
+
+	XchExpire(hNurApi);
+
+	return hNurApi->XchPending ? NUR_ERROR_NOT_READY : NUR_SUCCESS;
+}
+
+/*
+	Milliseconds left until the nearest deadline of commands in flight, 0 when expired.
+	Counted in wall-clock time with GetTickCountFunction, otherwise in wait rounds.
+*/
+int NURAPICONV NurApiXchTimeLeft(struct NUR_API_HANDLE *hNurApi)
+{
+	int idx, left, minLeft = -1;
+
+	for (idx = 0; idx < hNurApi->XchPending; idx++)
+	{
+		left = XchTimeLeft(hNurApi, &hNurApi->XchSlots[idx]);
+		if (minLeft < 0 || left < minLeft)
+			minLeft = left;
+	}
+	return minLeft;
+}
+
+int NURAPICONV NurApiXchPacketVec(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, const struct NUR_IOVEC *extPayload, int extCnt, int timeout)
+{
+	int error;
+    uint32_t processPos = 0;
+    uint32_t bytesRead = 0;
+	uint32_t bytesUsed;
+	int timeLeft;
+
+	if (hNurApi->XchPending) {
+		// Asynchronous exchange in progress
+		return NUR_ERROR_NOT_READY;
+	}
+
+	// Drop any data left from previous exchange
+	hNurApi->RxPacketState = STATE_IDLE;
+	hNurApi->RxBufferUsed = 0;
+
+	error = XchStartVec(hNurApi, cmd, payloadLen, extPayload, extCnt, timeout, NULL);
+	if (error != NUR_SUCCESS)
+		return error;
+
+	// Wait and read response from module
+	while (hNurApi->XchPending)
+	{
+		XchExpire(hNurApi);
+		if (!hNurApi->XchPending)
+		{
+			// Packet was not ready within timeout
+			break;
+		}
+		timeLeft = XchTimeLeft(hNurApi, &hNurApi->XchSlots[0]);
+
+		// Transport may block this long waiting for data
+		hNurApi->TransportReadTimeout = hNurApi->GetTickCountFunction ? (uint32_t)timeLeft : 1;
+
+		if (hNurApi->Flags & NUR_HANDLE_FLAG_ZEROCOPY_RX)
+		{
+			// Handle data already in RX buffer first; it may contain more than one packet
+			XchProcessRxBuffer(hNurApi);
+			if (!hNurApi->XchPending)
+				break;
+
+			// Read data directly after already received data
+			bytesRead = 0;
+			error = hNurApi->TransportReadDataFunction(hNurApi, hNurApi->RxBuffer + hNurApi->RxBufferUsed, hNurApi->RxBufferLen - hNurApi->RxBufferUsed, &bytesRead);
+			if (error == NUR_SUCCESS) {
+				NurApiXchFeed(hNurApi, hNurApi->RxBuffer + hNurApi->RxBufferUsed, bytesRead, NULL);
+			}
+		}
+		else
+		{
+			// Read data
+			if (processPos == bytesRead)
+			{
+				// Buffer completely consumed or empty, read more
+				processPos = 0;
+				bytesRead = 0;
+				error = hNurApi->TransportReadDataFunction(hNurApi, hNurApi->TxBuffer, hNurApi->TxBufferLen, &bytesRead);
+			}
+
+			if (processPos < bytesRead)
+			{
+				// Handle incoming data.
+				// NOTE: Data may come in pieces and received buffer may contain unsolicited messages
+				NurApiXchFeed(hNurApi, hNurApi->TxBuffer + processPos, bytesRead - processPos, &bytesUsed);
+				processPos += bytesUsed;
+			}
+		}
+
+		if (error != NUR_SUCCESS && error != NUR_ERROR_TR_TIMEOUT) {
+			// Transport error; completion traces the end of the exchange
+			STATS_ADD(TransportErrors, 1);
+			XchCompleteAll(hNurApi, error);
+			return error;
+		}
+	}
+
+	return hNurApi->XchError;
+}
+
+int NURAPICONV NurApiXchPacket(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, int timeout)
+{
+	return NurApiXchPacketVec(hNurApi, cmd, payloadLen, NULL, 0, timeout);
 }
 
 int NURAPICONV NurApiPing(struct NUR_API_HANDLE *hNurApi)
@@ -706,6 +2534,128 @@ int NURAPICONV NurApiGetBaudrate(struct NUR_API_HANDLE *hNurApi)
 	return NurApiXchPacket(hNurApi, NUR_CMD_SETBDR, 0, DEF_TIMEOUT);
 }
 
+uint32_t NURAPICONV NurApiBaudrateToBps(uint8_t setting)
+{
+	switch (setting)
+	{
+	case NUR_BR_115200: return 115200;
+	case NUR_BR_230400: return 230400;
+	case NUR_BR_500000: return 500000;
+	case NUR_BR_1000000: return 1000000;
+	case NUR_BR_1500000: return 1500000;
+	case NUR_BR_38400: return 38400;
+	default: return 0;
+	}
+}
+
+// Baudrate settings from slowest to fastest
+static const uint8_t BaudrateOrder[] = {
+	NUR_BR_38400, NUR_BR_115200, NUR_BR_230400, NUR_BR_500000, NUR_BR_1000000, NUR_BR_1500000
+};
+
+// Short timeout, a command lost at wrong or unreliable baudrate must not stall negotiation
+#define NEGOTIATE_TIMEOUT	500
+#define NEGOTIATE_RETRIES	3
+
+// Ping and full module setup read, both directions checked by packet CRC; any failure fails the burst
+static int BaudrateBurst(struct NUR_API_HANDLE *hNurApi, int burst)
+{
+	int error = NUR_SUCCESS;
+	int i;
+
+	for (i = 0; i < burst && error == NUR_SUCCESS; i++)
+	{
+		error = NurApiXchPacket(hNurApi, NUR_CMD_PING, 0, NEGOTIATE_TIMEOUT);
+		if (error == NUR_SUCCESS && (hNurApi->respLen != 2 || hNurApi->resp->ping.status[0] != 'O' || hNurApi->resp->ping.status[1] != 'K'))
+			error = NUR_ERROR_INVALID_PACKET;
+		if (error == NUR_SUCCESS)
+		{
+			PacketDwordPos(TxPayloadDataPtr, NUR_SETUP_ALL, 0);
+			error = NurApiXchPacket(hNurApi, NUR_CMD_LOADSETUP2, 4, NEGOTIATE_TIMEOUT);
+		}
+	}
+	return error;
+}
+
+// Module answers SETBDR at the old baudrate and then switches
+static int SwitchBaudrate(struct NUR_API_HANDLE *hNurApi, uint8_t setting, pSetHostBaudrateFunction setHostFn)
+{
+	int error;
+
+	TxPayloadDataPtr[0] = setting;
+	error = NurApiXchPacket(hNurApi, NUR_CMD_SETBDR, 1, NEGOTIATE_TIMEOUT);
+	if (error != NUR_SUCCESS)
+		return error;
+	return setHostFn(hNurApi, NurApiBaudrateToBps(setting));
+}
+
+// Get module and host back to last good setting after failed step.
+// Host is at the failed baudrate if the module acknowledged the switch, otherwise still at the good one.
+static int RestoreBaudrate(struct NUR_API_HANDLE *hNurApi, uint8_t good, uint8_t failed, pSetHostBaudrateFunction setHostFn)
+{
+	int error = NUR_ERROR_TR_TIMEOUT;
+	int retry;
+
+	for (retry = 0; retry < NEGOTIATE_RETRIES; retry++)
+	{
+		// Response may be lost on unreliable link, module switches anyway
+		TxPayloadDataPtr[0] = good;
+		NurApiXchPacket(hNurApi, NUR_CMD_SETBDR, 1, NEGOTIATE_TIMEOUT);
+
+		error = setHostFn(hNurApi, NurApiBaudrateToBps(good));
+		if (error == NUR_SUCCESS)
+			error = NurApiXchPacket(hNurApi, NUR_CMD_PING, 0, NEGOTIATE_TIMEOUT);
+		if (error == NUR_SUCCESS)
+			break;
+
+		// Module did not get the command, try again at the failed baudrate
+		setHostFn(hNurApi, NurApiBaudrateToBps(failed));
+	}
+	return error;
+}
+
+int NURAPICONV NurApiNegotiateBaudrate(struct NUR_API_HANDLE *hNurApi, uint32_t maxBaudrate, int burst, pSetHostBaudrateFunction setHostFn, uint8_t *setting)
+{
+	uint8_t good;
+	int cur, i, error;
+
+	if (!setHostFn || burst < 1)
+		return NUR_ERROR_INVALID_PARAMETER;
+
+	// Setting in use, host port is open at it
+	error = NurApiGetBaudrate(hNurApi);
+	if (error != NUR_SUCCESS)
+		return error;
+	good = hNurApi->resp->baudrate.setting;
+
+	for (cur = 0; cur < (int)sizeof(BaudrateOrder) && BaudrateOrder[cur] != good; cur++)
+		;
+	if (cur == (int)sizeof(BaudrateOrder))
+		return NUR_ERROR_NOT_SUPPORTED;
+
+	for (i = cur + 1; i < (int)sizeof(BaudrateOrder) && NurApiBaudrateToBps(BaudrateOrder[i]) <= maxBaudrate; i++)
+	{
+		error = SwitchBaudrate(hNurApi, BaudrateOrder[i], setHostFn);
+		if (error == NUR_SUCCESS)
+		{
+			// First exchange may see bytes sent during the switch
+			NurApiXchPacket(hNurApi, NUR_CMD_PING, 0, NEGOTIATE_TIMEOUT);
+			error = BaudrateBurst(hNurApi, burst);
+		}
+		if (error != NUR_SUCCESS)
+		{
+			// Faster settings will not do better
+			error = RestoreBaudrate(hNurApi, good, BaudrateOrder[i], setHostFn);
+			break;
+		}
+		good = BaudrateOrder[i];
+	}
+
+	if (setting)
+		*setting = good;
+	return error;
+}
+
 int NURAPICONV NurApiGetFWINFO(struct NUR_API_HANDLE *hNurApi, char *buf, uint16_t buflen)
 {
 	int error = NurApiXchPacket(hNurApi, NUR_CMD_GETFWINFO, 0, DEF_TIMEOUT);
@@ -895,8 +2845,8 @@ int NURAPICONV NurApiInventory(struct NUR_API_HANDLE *hNurApi,
 	return NurApiXchPacket(hNurApi, NUR_CMD_INVENTORY, payloadSize, DEF_LONG_TIMEOUT);
 }
 
-int NURAPICONV NurApiInventoryEx(struct NUR_API_HANDLE *hNurApi,
-								 struct NUR_CMD_INVENTORYEX_PARAMS *params)
+// Serialize NUR_CMD_INVENTORYEX parameters to TX buffer, filters without unused mask bytes
+static uint16_t InventoryExPayload(struct NUR_API_HANDLE *hNurApi, struct NUR_CMD_INVENTORYEX_PARAMS *params)
 {
 	uint16_t payloadSize = params ? sizeof(struct NUR_CMD_INVENTORYEX_PARAMS) : 0;
 	if (payloadSize > 0) {
@@ -914,6 +2864,13 @@ int NURAPICONV NurApiInventoryEx(struct NUR_API_HANDLE *hNurApi,
 			payloadSize += copySize;
 		}
 	}
+	return payloadSize;
+}
+
+int NURAPICONV NurApiInventoryEx(struct NUR_API_HANDLE *hNurApi,
+								 struct NUR_CMD_INVENTORYEX_PARAMS *params)
+{
+	uint16_t payloadSize = InventoryExPayload(hNurApi, params);
 	return NurApiXchPacket(hNurApi, NUR_CMD_INVENTORYEX, payloadSize, DEF_LONG_TIMEOUT);
 }
 
@@ -936,6 +2893,198 @@ int NURAPICONV NurApiSetInventoryReadConfig(struct NUR_API_HANDLE *hNurApi,
 	return NurApiXchPacket(hNurApi, NUR_CMD_INVENTORYREAD, payloadSize, DEF_TIMEOUT);
 }
 
+#ifdef CONFIG_INVENTORY_STREAM
+// Completion of stream start / stop sent from NurApiInventoryStreamPoll() or InvStreamStop()
+static void InvStreamCommandComplete(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, int error)
+{
+	struct NUR_INVENTORY_STREAM *st = hNurApi->InvStream;
+
+	if (!st)
+		return;
+	if (error != NUR_SUCCESS && st->Error == NUR_SUCCESS)
+		st->Error = error;
+
+	if (cmd == NUR_CMD_STOPALLCONT && st->State == NUR_INVSTREAM_PAUSING)
+		st->State = NUR_INVSTREAM_PAUSED;
+	else if (cmd != NUR_CMD_STOPALLCONT && error != NUR_SUCCESS && st->State == NUR_INVSTREAM_RUNNING)
+		st->State = NUR_INVSTREAM_START;	// Try again on next poll
+}
+
+static int InvStreamSendStart(struct NUR_API_HANDLE *hNurApi, struct NUR_INVENTORY_STREAM *st)
+{
+	uint16_t payloadSize;
+
+	if (st->ExParams)
+	{
+		// Caller's flags are kept, stream flag is set only in the TX buffer
+		payloadSize = InventoryExPayload(hNurApi, st->ExParams);
+		TxPayloadDataPtr[0] |= NUR_INVEX_FLAGS_STREAM;
+		return NurApiXchStart(hNurApi, NUR_CMD_INVENTORYEX, payloadSize, DEF_TIMEOUT, InvStreamCommandComplete);
+	}
+
+	payloadSize = st->HasParams ? sizeof(st->Params) : 0;
+	if (payloadSize > 0) {
+		nurMemcpy(TxPayloadDataPtr, &st->Params, payloadSize);
+	}
+	return NurApiXchStart(hNurApi, NUR_CMD_INVENTORYSTREAM, payloadSize, DEF_TIMEOUT, InvStreamCommandComplete);
+}
+
+// Wait for commands in flight. Unlike NurApiXchPacket(), data received after a response is not dropped.
+static int XchWaitAll(struct NUR_API_HANDLE *hNurApi)
+{
+	int error, left;
+
+	while (hNurApi->XchPending)
+	{
+		left = NurApiXchTimeLeft(hNurApi);
+		error = XchReadFeed(hNurApi, hNurApi->GetTickCountFunction ? (uint32_t)left : 1);
+		if (error != NUR_SUCCESS && error != NUR_ERROR_TR_TIMEOUT) {
+			STATS_ADD(TransportErrors, 1);
+			XchCompleteAll(hNurApi, error);
+			return error;
+		}
+		XchExpire(hNurApi);
+	}
+	return NUR_SUCCESS;
+}
+
+// Stop: tags of notifications received until the stop response are still delivered
+static int InvStreamStop(struct NUR_API_HANDLE *hNurApi)
+{
+	struct NUR_INVENTORY_STREAM *st = hNurApi->InvStream;
+	int error;
+
+	st->State = NUR_INVSTREAM_STOPPING;
+	st->Error = NUR_SUCCESS;
+
+	error = XchWaitAll(hNurApi);
+	if (error == NUR_SUCCESS)
+		error = NurApiXchStart(hNurApi, NUR_CMD_STOPALLCONT, 1, DEF_TIMEOUT, InvStreamCommandComplete);
+	if (error == NUR_SUCCESS)
+		error = XchWaitAll(hNurApi);
+	if (error == NUR_SUCCESS)
+		error = st->Error;
+
+	st->State = NUR_INVSTREAM_IDLE;
+	hNurApi->InvStream = NULL;
+	return error;
+}
+
+static int InvStreamStart(struct NUR_API_HANDLE *hNurApi, struct NUR_INVENTORY_STREAM *stream)
+{
+	int error;
+
+	stream->Error = NUR_SUCCESS;
+
+	// Notifications may follow the response in the same read
+	stream->State = NUR_INVSTREAM_RUNNING;
+	hNurApi->InvStream = stream;
+
+	error = InvStreamSendStart(hNurApi, stream);
+	if (error == NUR_SUCCESS)
+		error = XchWaitAll(hNurApi);
+	if (error == NUR_SUCCESS)
+		error = stream->Error;
+
+	if (error != NUR_SUCCESS) {
+		stream->State = NUR_INVSTREAM_IDLE;
+		hNurApi->InvStream = NULL;
+	}
+	return error;
+}
+
+int NURAPICONV NurApiStartInventoryStream(struct NUR_API_HANDLE *hNurApi, struct NUR_INVENTORY_STREAM *stream, struct NUR_CMD_INVENTORY_PARAMS *params)
+{
+	if (!stream || !stream->TagFunction || hNurApi->InvStream)
+		return NUR_ERROR_INVALID_PARAMETER;
+	if (hNurApi->XchPending)
+		return NUR_ERROR_NOT_READY;
+
+	stream->ExParams = NULL;
+	stream->HasParams = (params != NULL);
+	if (params) {
+		stream->Params = *params;
+	}
+	return InvStreamStart(hNurApi, stream);
+}
+
+int NURAPICONV NurApiStartInventoryEx(struct NUR_API_HANDLE *hNurApi, struct NUR_INVENTORY_STREAM *stream, struct NUR_CMD_INVENTORYEX_PARAMS *params)
+{
+	if (!stream || !stream->TagFunction || !params || params->filterCount > NUR_MAX_FILTERS || hNurApi->InvStream)
+		return NUR_ERROR_INVALID_PARAMETER;
+	if (hNurApi->XchPending)
+		return NUR_ERROR_NOT_READY;
+
+	stream->ExParams = params;
+	stream->HasParams = TRUE;
+	return InvStreamStart(hNurApi, stream);
+}
+
+int NURAPICONV NurApiInventoryStreamPoll(struct NUR_API_HANDLE *hNurApi, int timeout)
+{
+	struct NUR_INVENTORY_STREAM *st = hNurApi->InvStream;
+	int error, left;
+
+	if (!st)
+		return NUR_ERROR_INVALID_PARAMETER;
+
+	// Commands asked for by notifications are sent here, outside of packet handling
+	if (!hNurApi->XchPending)
+	{
+		if (st->State == NUR_INVSTREAM_START)
+		{
+			st->State = NUR_INVSTREAM_RUNNING;
+			error = InvStreamSendStart(hNurApi, st);
+			if (error != NUR_SUCCESS) {
+				st->State = NUR_INVSTREAM_START;
+				return error;
+			}
+		}
+		else if (st->State == NUR_INVSTREAM_PAUSE)
+		{
+			st->State = NUR_INVSTREAM_PAUSING;
+			error = NurApiXchStart(hNurApi, NUR_CMD_STOPALLCONT, 1, DEF_TIMEOUT, InvStreamCommandComplete);
+			if (error != NUR_SUCCESS) {
+				st->State = NUR_INVSTREAM_PAUSE;
+				return error;
+			}
+		}
+	}
+
+	// Wait for data, but not past the deadline of a command in flight
+	left = NurApiXchTimeLeft(hNurApi);
+	if (left >= 0 && left < timeout)
+		timeout = left;
+
+	error = XchReadFeed(hNurApi, hNurApi->GetTickCountFunction ? (uint32_t)timeout : 1);
+	if (error != NUR_SUCCESS && error != NUR_ERROR_TR_TIMEOUT) {
+		STATS_ADD(TransportErrors, 1);
+		XchCompleteAll(hNurApi, error);
+		return error;
+	}
+	XchExpire(hNurApi);
+
+	error = st->Error;
+	st->Error = NUR_SUCCESS;
+	return error;
+}
+
+int NURAPICONV NurApiInventoryStreamResume(struct NUR_API_HANDLE *hNurApi)
+{
+	struct NUR_INVENTORY_STREAM *st = hNurApi->InvStream;
+
+	if (!st)
+		return NUR_ERROR_INVALID_PARAMETER;
+	if (st->State == NUR_INVSTREAM_PAUSE)
+		st->State = NUR_INVSTREAM_RUNNING;	// Stop was not sent yet
+	else if (st->State == NUR_INVSTREAM_PAUSED)
+		st->State = NUR_INVSTREAM_START;
+	else if (st->State == NUR_INVSTREAM_PAUSING)
+		return NUR_ERROR_NOT_READY;
+	return NUR_SUCCESS;
+}
+#endif
+
 int NURAPICONV NurApiClearTags(struct NUR_API_HANDLE *hNurApi)
 {
 	return NurApiXchPacket(hNurApi, NUR_CMD_CLEARIDBUF, 0, DEF_TIMEOUT);
@@ -943,6 +3092,10 @@ int NURAPICONV NurApiClearTags(struct NUR_API_HANDLE *hNurApi)
 
 int NURAPICONV NurApiStopContinuous(struct NUR_API_HANDLE *hNurApi)
 {
+#ifdef CONFIG_INVENTORY_STREAM
+	if (hNurApi->InvStream)
+		return InvStreamStop(hNurApi);
+#endif
 	return NurApiXchPacket(hNurApi, NUR_CMD_STOPALLCONT, 1, DEF_TIMEOUT);
 }
 
@@ -950,6 +3103,7 @@ int NURAPICONV NurApiSetCustomHoptableEx(struct NUR_API_HANDLE *hNurApi,
 										struct NUR_CUSTOMHOP_PARAMS_EX *params)
 {
 	uint16_t payloadSize;
+	struct NUR_IOVEC iov;
 
 	if	(params->count == 0 ||
 		params->count > NUR_MAX_CUSTOM_FREQS ||
@@ -962,10 +3116,11 @@ int NURAPICONV NurApiSetCustomHoptableEx(struct NUR_API_HANDLE *hNurApi,
 
 	payloadSize = sizeof(struct NUR_CUSTOMHOP_PARAMS_EX);
 	payloadSize -= (NUR_MAX_CUSTOM_FREQS*sizeof(uint32_t) - params->count*sizeof(uint32_t));
-	if (payloadSize > 0) {
-		nurMemcpy(TxPayloadDataPtr, params, payloadSize);
-	}
-	return NurApiXchPacket(hNurApi, NUR_CMD_CUSTOMHOP_EX, payloadSize, DEF_TIMEOUT);
+
+	// Table is sent directly from caller's memory
+	iov.data = (const uint8_t *)params;
+	iov.len = payloadSize;
+	return NurApiXchPacketVec(hNurApi, NUR_CMD_CUSTOMHOP_EX, 0, &iov, 1, DEF_TIMEOUT);
 }
 
 int NURAPICONV NurApiGetCustomHoptableEx(struct NUR_API_HANDLE *hNurApi)
@@ -1116,6 +3271,129 @@ int NURAPICONV ParseIdBuffer(struct NUR_API_HANDLE *hNurApi, pFetchTagsFunction
 	return received;
 }
 
+#ifdef CONFIG_TAG_BATCH
+/*
+	Same block layout as ParseIdBuffer: length, [rssi, scaledRssi, timestamp, freq, (dataLen), pc, channel], antenna id, EPC (+ data).
+	First pass follows the block lengths and fills EpcOffset / EpcLen; each requested metadata column is then
+	filled in its own loop at a fixed distance before the EPC. Little endian fields are read byte by byte,
+	so no packed struct or unaligned access is needed.
+*/
+int NURAPICONV NurApiParseIdBufferBatch(struct NUR_TAG_BATCH *batch, const uint8_t *buffer, uint32_t bufferLen, int32_t includeMeta, int32_t includeIrData)
+{
+	uint16_t *off = batch->EpcOffset;
+	uint32_t pos = 0;
+	uint32_t n = 0, count;
+	uint8_t blockLen, epcLen, dataLen;
+	int ir;			// dataLen byte before pc
+	int meta;		// metadata bytes before antenna id
+
+	if (includeIrData)
+		includeMeta = TRUE;
+	ir = includeIrData ? 1 : 0;
+	meta = includeMeta ? (11 + ir) : 0;
+
+	batch->Buffer = buffer;
+	batch->Count = 0;
+	if (!off || !batch->EpcLen)
+		return 0;
+
+	// EpcOffset is 16 bits
+	if (bufferLen > 0xFFFF)
+		bufferLen = 0xFFFF;
+
+	while (pos < bufferLen && n < batch->Capacity)
+	{
+		blockLen = buffer[pos];
+		if (blockLen == 0)
+			break;
+		// Truncated or malformed block: stop, metadata loops below read only before the EPC of whole blocks
+		if (blockLen < 1 + meta || blockLen > bufferLen - pos - 1)
+			break;
+		epcLen = (uint8_t)(blockLen - 1 - meta);
+		if (ir)
+		{
+			// Inventory read data follows EPC inside the block
+			dataLen = buffer[pos + meta - 3];
+			if (dataLen > epcLen)
+				break;
+			epcLen -= dataLen;
+		}
+		// EPC after length byte, metadata and antenna id
+		off[n] = (uint16_t)(pos + 2 + meta);
+		batch->EpcLen[n] = epcLen;
+		pos += 1 + blockLen;
+		n++;
+	}
+	batch->Count = count = n;
+
+	// Metadata columns by distance before EPC: rssi -12-ir, scaledRssi -11-ir, timestamp -10-ir, freq -8-ir, (dataLen -4-ir), pc -4, channel -2, antenna id -1
+	if (ir)
+	{
+		if (batch->DataLen)
+			for (n = 0; n < count; n++)
+				batch->DataLen[n] = buffer[off[n] - 5];
+	}
+	else if (batch->DataLen)
+	{
+		nurMemset(batch->DataLen, 0, count);
+	}
+
+	if (batch->AntennaId)
+		for (n = 0; n < count; n++)
+			batch->AntennaId[n] = buffer[off[n] - 1];
+
+	if (!includeMeta)
+		return (int)count;
+
+	if (batch->Rssi)
+		for (n = 0; n < count; n++)
+			batch->Rssi[n] = (int8_t)buffer[off[n] - 12 - ir];
+	if (batch->ScaledRssi)
+		for (n = 0; n < count; n++)
+			batch->ScaledRssi[n] = buffer[off[n] - 11 - ir];
+	if (batch->Timestamp)
+		for (n = 0; n < count; n++) {
+			const uint8_t *b = &buffer[off[n] - 10 - ir];
+			batch->Timestamp[n] = (uint16_t)(b[0] | (b[1] << 8));
+		}
+	if (batch->Freq)
+		for (n = 0; n < count; n++) {
+			const uint8_t *b = &buffer[off[n] - 8 - ir];
+			batch->Freq[n] = (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+		}
+	if (batch->Pc)
+		for (n = 0; n < count; n++) {
+			const uint8_t *b = &buffer[off[n] - 4];
+			batch->Pc[n] = (uint16_t)(b[0] | (b[1] << 8));
+		}
+	if (batch->Channel)
+		for (n = 0; n < count; n++)
+			batch->Channel[n] = buffer[off[n] - 2];
+
+	return (int)count;
+}
+
+int NURAPICONV NurApiFetchTagsBatch(struct NUR_API_HANDLE *hNurApi, int32_t includeMeta, int32_t clearModuleTags, struct NUR_TAG_BATCH *batch)
+{
+	int error;
+	uint16_t payloadSize = 0;
+
+	batch->Count = 0;
+	if (clearModuleTags) {
+		TxPayloadDataPtr[0] = 0x1; // Clear id buffer
+		payloadSize = 1;
+	}
+
+	error = NurApiXchPacket(hNurApi, includeMeta ? NUR_CMD_GETMETABUF : NUR_CMD_GETIDBUF, payloadSize, DEF_TIMEOUT);
+	if (error == NUR_SUCCESS)
+	{
+		NurApiParseIdBufferBatch(batch, hNurApi->resp->rawdata, RxPayloadLen, includeMeta, (RxHeaderPtr->flags & PACKET_FLAG_IRDATA) != 0);
+	}
+
+	return error;
+}
+#endif
+
 int NURAPICONV NurApiFetchTags(struct NUR_API_HANDLE *hNurApi, int32_t includeMeta, int32_t clearModuleTags, int *tagsReceived, pFetchTagsFunction tagFunc)
 {
 	int error;
@@ -1155,6 +3433,126 @@ int NURAPICONV NurApiFetchTagAt(struct NUR_API_HANDLE *hNurApi, int32_t includeM
 	return error;
 }
 
+// Tag block in NUR_CMD_GETMETABUF / NUR_CMD_GETIDBUF response without EPC: length, [rssi .. channel], antenna id
+#define FETCH_TAG_OVERHEAD(meta)	((meta) ? 13 : 2)
+
+// Tags of maxEpcLen bytes (and maxDataLen bytes of inventory read data) that fit in one response in RxBuffer
+static int FetchChunkSize(struct NUR_API_HANDLE *hNurApi, int32_t includeMeta, int maxEpcLen, int maxDataLen)
+{
+	uint32_t room, tagSize;
+
+	if (maxEpcLen <= 0 || maxEpcLen > NUR_MAX_EPC_LENGTH_EX)
+		maxEpcLen = NUR_MAX_EPC_LENGTH_EX;
+	if (maxDataLen > 0) {
+		// Inventory read data: metadata is always included, dataLen byte and data follow EPC
+		tagSize = FETCH_TAG_OVERHEAD(TRUE) + 1 + maxEpcLen + maxDataLen;
+	} else {
+		tagSize = FETCH_TAG_OVERHEAD(includeMeta) + maxEpcLen;
+	}
+	// Block length is one byte
+	if (tagSize > 256)
+		tagSize = 256;
+
+	// Header, then cmd, status, data and CRC-16
+	room = (hNurApi->RxBufferLen > HDR_SIZE) ? hNurApi->RxBufferLen - HDR_SIZE : 0;
+	if (room > NUR_MAX_RCV_SZ)
+		room = NUR_MAX_RCV_SZ;
+	room = (room > 4) ? room - 4 : 0;
+
+	return (room >= 2 * tagSize) ? (int)(room / tagSize) : 1;
+}
+
+// Request tags first .. first + count - 1; single index form for one tag
+static int FetchTagRange(struct NUR_API_HANDLE *hNurApi, int32_t includeMeta, int first, int count, int timeout)
+{
+	uint16_t payloadSize = 0;
+
+	PacketDword(TxPayloadDataPtr, first, &payloadSize);
+	if (count > 1) {
+		PacketDword(TxPayloadDataPtr, count, &payloadSize);
+	}
+	return NurApiXchPacket(hNurApi, includeMeta ? NUR_CMD_GETMETABUF : NUR_CMD_GETIDBUF, payloadSize, timeout);
+}
+
+// Probe answer is two tags; a module that ignores the payload may send a whole buffer that does not fit
+#define FETCH_PROBE_TIMEOUT	500
+
+// Tag callback of NurApiFetchTagsChunked(): stops the parse when FetchTagFunction refuses a tag
+static int FetchChunkTag(struct NUR_API_HANDLE *hNurApi, struct NUR_IDBUFFER_ENTRY *tag)
+{
+	if (hNurApi->FetchTagFunction && hNurApi->FetchTagFunction(hNurApi, tag) != NUR_SUCCESS)
+	{
+		hNurApi->FetchRefused = TRUE;
+		return NUR_ERROR_GENERAL;
+	}
+	return NUR_SUCCESS;
+}
+
+int NURAPICONV NurApiFetchTagsChunked(struct NUR_API_HANDLE *hNurApi, int32_t includeMeta, int tagCount, int maxEpcLen, int maxDataLen, int *tagsReceived, pFetchTagsFunction tagFunc)
+{
+	int error = NUR_SUCCESS;
+	int chunk = FetchChunkSize(hNurApi, includeMeta, maxEpcLen, maxDataLen);
+	int first = 0, received = 0;
+	int probe = FALSE;
+	int count, got;
+
+	if (chunk > 1 && tagCount > 1)
+	{
+		if (hNurApi->FetchRange == FETCH_RANGE_UNKNOWN)
+			probe = TRUE;
+		else if (hNurApi->FetchRange == FETCH_RANGE_NO)
+			chunk = 1;
+	}
+
+	hNurApi->FetchTagFunction = tagFunc;
+	hNurApi->FetchRefused = FALSE;
+
+	while (first < tagCount)
+	{
+		/*
+			Capability probe: first request asks for tags 0 and 1 as a range. Whatever the module answers
+			starts at tag 0, so the tags are passed on as they are: two tags means range fetch works;
+			one tag (count ignored), more (payload ignored) or an error means it does not.
+		*/
+		count = (tagCount - first < chunk) ? tagCount - first : chunk;
+		if (probe && count > 2)
+			count = 2;
+
+		error = FetchTagRange(hNurApi, includeMeta, first, count, probe ? FETCH_PROBE_TIMEOUT : DEF_TIMEOUT);
+		if (error != NUR_SUCCESS && probe)
+		{
+			hNurApi->FetchRange = FETCH_RANGE_NO;
+			chunk = 1;
+			probe = FALSE;
+			continue;
+		}
+		if (error != NUR_SUCCESS)
+			break;
+
+		got = ParseIdBuffer(hNurApi, FetchChunkTag, hNurApi->resp->rawdata, RxPayloadLen, includeMeta, (RxHeaderPtr->flags & PACKET_FLAG_IRDATA) != 0);
+		received += got;
+
+		// Empty response or tagFunc wants no more
+		if (got == 0 || hNurApi->FetchRefused)
+			break;
+
+		if (probe)
+		{
+			hNurApi->FetchRange = (got == count) ? FETCH_RANGE_YES : FETCH_RANGE_NO;
+			if (got != count)
+				chunk = 1;
+			probe = FALSE;
+		}
+		first += got;
+	}
+
+	hNurApi->FetchTagFunction = NULL;
+	if (tagsReceived)
+		*tagsReceived = received;
+
+	return error;
+}
+
 int NURAPICONV NurApiTraceTag(struct NUR_API_HANDLE *hNurApi, struct NUR_CMD_TRACETAG_PARAMS *params)
 {
 	int error;
@@ -532,6 +532,15 @@ enum NUR_FILTER_ACTION
 	NUR_FACTION_7,		/**< Matching tags: do nothing. Non-matching: negate SL or invert inventoried session flag (A->B, B->A). */
 };
 
+/** Flags of struct NUR_CMD_INVENTORYEX_PARAMS.
+ * @sa NurApiInventoryEx(), NurApiStartInventoryEx()
+ */
+enum NUR_INVEX_FLAGS
+{
+	NUR_INVEX_FLAGS_NONE = 0,
+	NUR_INVEX_FLAGS_STREAM = (1<<0)	/**< Run continuously, tags are sent in NUR_NOTIFY_INVENTORYEX notifications. Set by NurApiStartInventoryEx(). */
+};
+
 /**
  * Defines inventory read type.
  * @sa NurApiConfigInventoryRead()
@@ -845,13 +854,351 @@ enum NUR_ERRORCODES
 
 struct NUR_API_HANDLE;
 
+/**
+ * Flags for struct NUR_API_HANDLE Flags member.
+ */
+enum NUR_HANDLE_FLAGS
+{
+	NUR_HANDLE_FLAG_ZEROCOPY_RX = (1<<0),	/**< Transport reads directly to RxBuffer and packets are parsed in place. TxBuffer is then used for sending only. */
+};
+
 typedef int (*pTransportReadDataFunction)(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesRead);
 typedef int (*pTransportWriteDataFunction)(struct NUR_API_HANDLE *hNurApi, uint8_t *buffer, uint32_t bufferLen, uint32_t *bytesWritten);
 
+/** Data segment for scatter-gather write, see TransportWriteVecFunction. */
+struct NUR_IOVEC
+{
+	const uint8_t *data;
+	uint32_t len;
+};
+
+/** Maximum number of segments in one packet write: header, caller payload segments and CRC. */
+#define NUR_MAX_IOVEC	8
+
+typedef int (*pTransportWriteVecFunction)(struct NUR_API_HANDLE *hNurApi, const struct NUR_IOVEC *iov, int iovCnt, uint32_t *bytesWritten);
+
 typedef void (*pUnsolEventHandler)(struct NUR_API_HANDLE *hNurApi);
 
+/** Returns monotonic millisecond tick count. Wrap around is allowed. */
+typedef uint32_t (*pGetTickCountFunction)(struct NUR_API_HANDLE *hNurApi);
+
+/** Sets host port to baudrate in bps, see NurApiNegotiateBaudrate(). Reopen the port if it cannot be changed in place. */
+typedef int (*pSetHostBaudrateFunction)(struct NUR_API_HANDLE *hNurApi, uint32_t baudrate);
+
+/** Called when an exchange started with NurApiXchStart() completes. Response is in hNurApi->resp and valid only during the call. */
+typedef void (*pXchCompleteFunction)(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, int error);
+
+/** Exchange trace events, see hNurApi->XchTraceFunction. */
+enum NUR_XCH_TRACE_EVENT
+{
+	NUR_XCH_TRACE_BEGIN = 1,	/**< Command is about to be written. len is command data length. */
+	NUR_XCH_TRACE_SENT,			/**< Command written. status is the write result; on error the exchange ends here. */
+	NUR_XCH_TRACE_RX,			/**< Received data passed to the parser. cmd is 0, len is byte count. */
+	NUR_XCH_TRACE_END			/**< Command completed. len is response data length, status is module status or API error. */
+};
+
+/** Called at exchange trace events, see enum NUR_XCH_TRACE_EVENT. Take the timestamp in the callback. */
+typedef void (*pXchTraceFunction)(struct NUR_API_HANDLE *hNurApi, int event, uint8_t cmd, uint32_t len, int status);
+
+#ifndef NUR_XCH_WINDOW
+#define NUR_XCH_WINDOW	4
+#endif
+
+/** One command in flight, see NurApiXchStart(). */
+struct NUR_XCH_SLOT
+{
+	pXchCompleteFunction CompleteFunction;
+	uint8_t Cmd;
+	int Timeout;
+	int StartRound;
+	uint32_t StartTick;
+};
+
 typedef int (*pFetchTagsFunction)(struct NUR_API_HANDLE *hNurApi, struct NUR_IDBUFFER_ENTRY *tag);
 
+/**
+ * Queue of unsolicited packets, see NurApiUnsolQueueInit().
+ * Single producer (the thread doing I/O on the handle) and single consumer; no locks.
+ * Memory is given by the application and the queue never allocates: packets that do not fit are dropped and counted.
+ */
+struct NUR_UNSOL_QUEUE
+{
+	uint8_t *Storage;
+	uint32_t SlotCount;			/* Power of two */
+	uint16_t SlotSize;			/* Largest stored packet: cmd, status and data */
+
+	volatile uint32_t Head;		/* Written by producer only */
+	volatile uint32_t Tail;		/* Written by consumer only */
+
+	/* Statistics, written by producer only */
+	volatile uint32_t Queued;			/* Packets queued in total */
+	volatile uint32_t DroppedFull;		/* Packets dropped because the queue was full */
+	volatile uint32_t DroppedTooLong;	/* Packets dropped because they were longer than SlotSize */
+	volatile uint32_t MaxDepth;			/* Most packets in queue at once */
+};
+
+#ifndef NUR_TAGTABLE_MAX_EPC
+#define NUR_TAGTABLE_MAX_EPC	32
+#endif
+
+/** One tag in struct NUR_TAG_TABLE. Slot is in use when Hash is non-zero. */
+struct NUR_TAG_ENTRY
+{
+	union {
+		uint8_t Bytes[NUR_TAGTABLE_MAX_EPC];
+		uint32_t Words[NUR_TAGTABLE_MAX_EPC / 4];	/* Zero padded after EpcLen bytes */
+	} Epc;
+	uint32_t Hash;
+	uint32_t FirstSeen;		/* 'now' of first NurApiTagTableAdd() */
+	uint32_t LastSeen;		/* 'now' of last NurApiTagTableAdd() */
+	uint32_t ReadCount;
+	int32_t RssiSum;		/* Mean RSSI is RssiSum / ReadCount */
+	int8_t MaxRssi;
+	uint8_t LastAntenna;
+	uint8_t EpcLen;
+};
+
+/**
+ * EPC deduplication table, see NurApiTagTableInit(). Open addressing over slots given by the application,
+ * so the capacity is fixed when the slot array is declared and the table never allocates.
+ */
+struct NUR_TAG_TABLE
+{
+	struct NUR_TAG_ENTRY *Slots;
+	uint32_t SlotMask;			/* Slot count - 1, slot count is a power of two */
+	uint32_t MaxCount;			/* 3/4 of slots, to keep probe sequences short */
+	uint32_t Count;				/* Unique tags in table */
+	uint32_t Dropped;			/* Adds refused because table was full or EPC too long */
+};
+
+/**
+ * Tag copied to struct NUR_TAG_ARENA. EPC and inventory read data follow the record inline,
+ * see NUR_TAG_RECORD_EPC() and NUR_TAG_RECORD_DATA().
+ */
+struct NUR_TAG_RECORD
+{
+	uint32_t freq;
+	uint16_t timestamp;
+	uint16_t pc;
+	int8_t rssi;
+	uint8_t scaledRssi;
+	uint8_t channel;
+	uint8_t antennaId;
+	uint8_t epcLen;
+	uint8_t dataLen;		/* Inventory read data after EPC, 0 without inventory read */
+	uint16_t size;			/* Record size in arena, including EPC, data and padding */
+};
+
+/** EPC bytes of a struct NUR_TAG_RECORD. */
+#define NUR_TAG_RECORD_EPC(rec)		((uint8_t *)(rec) + sizeof(struct NUR_TAG_RECORD))
+/** Inventory read data bytes of a struct NUR_TAG_RECORD. */
+#define NUR_TAG_RECORD_DATA(rec)	(NUR_TAG_RECORD_EPC(rec) + (rec)->epcLen)
+
+/**
+ * Tag record arena, see NurApiTagArenaInit(). Tags are copied out of RxBuffer into contiguous records
+ * in application memory, so they stay valid over later commands until the arena is reset.
+ */
+struct NUR_TAG_ARENA
+{
+	uint8_t *Storage;
+	uint32_t Size;
+	uint32_t Used;			/* Bytes used by records */
+	uint32_t Count;			/* Records since last reset */
+	uint32_t HighWater;		/* Most bytes used at once since init */
+	uint32_t HighWaterCount;	/* Most records at once since init */
+	uint32_t Dropped;		/* Tags that did not fit, since init */
+};
+
+/**
+ * Tags of one response as columns (struct of arrays), see NurApiParseIdBufferBatch().
+ * Column arrays are given by the application, each with Capacity elements. EpcOffset and EpcLen are required,
+ * other columns left NULL are not filled.
+ * Tag n's EPC is EpcLen[n] bytes at Buffer + EpcOffset[n], followed by DataLen[n] bytes of inventory read data.
+ */
+struct NUR_TAG_BATCH
+{
+	uint32_t Capacity;
+	uint32_t Count;				/* Tags in columns after parse */
+	const uint8_t *Buffer;		/* Parsed buffer, e.g. response in RxBuffer: valid until the next command */
+
+	int8_t *Rssi;
+	uint8_t *ScaledRssi;
+	uint16_t *Timestamp;
+	uint32_t *Freq;
+	uint16_t *Pc;
+	uint8_t *Channel;
+	uint8_t *AntennaId;
+	uint16_t *EpcOffset;
+	uint8_t *EpcLen;
+	uint8_t *DataLen;
+};
+
+#ifndef NUR_PRESENCE_WHEEL_SLOTS
+#define NUR_PRESENCE_WHEEL_SLOTS	64
+#endif
+
+/** Presence events, see pPresenceEventFunction. */
+enum NUR_PRESENCE_EVENT
+{
+	NUR_PRESENCE_ARRIVE = 1,	/**< First read of a tag that was not present */
+	NUR_PRESENCE_DEPART			/**< Tag not read for Timeout */
+};
+
+/** Presence flags, struct NUR_PRESENCE Flags. */
+enum NUR_PRESENCE_FLAGS
+{
+	NUR_PRESENCE_HOST_TIME = 0,			/**< 'now' given to NurApiPresenceUpdate() is the read time */
+	NUR_PRESENCE_MODULE_TIME = (1<<0)	/**< Read time is 'now' + NUR_IDBUFFER_ENTRY.timestamp: module milliseconds from the start of the inventory */
+};
+
+/** Tag in struct NUR_PRESENCE, present while EpcLen is non-zero. Departs when not read from LastSeen to LastSeen + Timeout. */
+struct NUR_PRESENCE_TAG
+{
+	union {
+		uint8_t Bytes[NUR_TAGTABLE_MAX_EPC];
+		uint32_t Words[NUR_TAGTABLE_MAX_EPC / 4];	/* Zero padded after EpcLen bytes */
+	} Epc;
+	uint32_t Hash;
+	uint32_t HashNext;		/* Next tag index in hash bucket or free list */
+	uint32_t WheelNext;		/* Next tag index in timing wheel slot */
+	uint32_t Arrived;		/* Read time of arrival */
+	uint32_t LastSeen;		/* Latest read time */
+	uint32_t ReadCount;		/* Reads since arrival */
+	int8_t LastRssi;
+	int8_t MaxRssi;
+	uint8_t LastAntenna;
+	uint8_t EpcLen;
+};
+
+struct NUR_PRESENCE;
+
+/** Called on tag state changes, see enum NUR_PRESENCE_EVENT. On NUR_PRESENCE_DEPART tag is freed, or reused for a new arrival, after the call. */
+typedef void (*pPresenceEventFunction)(struct NUR_PRESENCE *p, struct NUR_PRESENCE_TAG *tag, int event);
+
+/**
+ * Tag presence tracker, see NurApiPresenceInit(). Tags are kept in application memory with a chained hash index,
+ * so a read costs one lookup. Departures are found with a timing wheel of NUR_PRESENCE_WHEEL_SLOTS slots of Tick time units:
+ * a tag is checked when its slot comes around, not on every read or by scanning all tags.
+ */
+struct NUR_PRESENCE
+{
+	pPresenceEventFunction EventFunction;
+	void *UserData;
+	uint32_t Flags;				/* enum NUR_PRESENCE_FLAGS */
+
+	uint32_t Timeout;			/* Departure timeout in time units */
+	uint32_t Tick;				/* Wheel slot length, departures are reported at most this late */
+
+	struct NUR_PRESENCE_TAG *Tags;
+	uint32_t TagCount;
+	uint32_t *Buckets;
+	uint32_t BucketMask;		/* Bucket count - 1, bucket count is a power of two */
+	uint32_t FreeTag;			/* Head of free tag list */
+
+	uint32_t WheelPos;			/* Slot checked when time reaches TickEnd */
+	uint32_t TickEnd;
+	uint32_t Wheel[NUR_PRESENCE_WHEEL_SLOTS];	/* Heads of tag lists */
+
+	uint32_t Count;				/* Tags present */
+	uint32_t Arrivals;
+	uint32_t Departures;
+	uint32_t Dropped;			/* Reads not tracked: no free tag or EPC longer than NUR_TAGTABLE_MAX_EPC */
+};
+
+/** Inventory stream states, see struct NUR_INVENTORY_STREAM. */
+enum NUR_INVSTREAM_STATE
+{
+	NUR_INVSTREAM_IDLE = 0,		/**< Not started or stopped */
+	NUR_INVSTREAM_RUNNING,		/**< Module is streaming */
+	NUR_INVSTREAM_START,		/**< Module stopped the stream or resumed; next poll restarts it */
+	NUR_INVSTREAM_PAUSE,		/**< TagFunction refused a tag; next poll stops the stream */
+	NUR_INVSTREAM_PAUSING,		/**< Stop sent for pause */
+	NUR_INVSTREAM_PAUSED,		/**< Stopped until NurApiInventoryStreamResume() */
+	NUR_INVSTREAM_STOPPING		/**< NurApiStopContinuous() in progress */
+};
+
+struct NUR_INVENTORY_STREAM;
+
+/** Called for each inventory stream notification after its tags are passed to TagFunction and its fields are updated. */
+typedef void (*pInvStreamRoundFunction)(struct NUR_API_HANDLE *hNurApi, struct NUR_INVENTORY_STREAM *stream);
+
+/**
+ * Inventory stream, see NurApiStartInventoryStream() and NurApiStartInventoryEx(). In application memory; zero initialize and set TagFunction.
+ * Tags are passed to TagFunction straight from the received notification, so memory use is bounded by
+ * the RX buffer and what the application does with the tags.
+ */
+struct NUR_INVENTORY_STREAM
+{
+	/* Called for each tag from the thread doing I/O. Return non-zero when the tag cannot be taken (back-pressure):
+	   rest of the notification is dropped and the stream is paused until NurApiInventoryStreamResume(). */
+	pFetchTagsFunction TagFunction;
+	/* Optional, per round statistics (TagsFound, RoundsDone, Collisions, Q) as they arrive */
+	pInvStreamRoundFunction RoundFunction;
+	void *UserData;
+
+	volatile uint8_t State;		/* enum NUR_INVSTREAM_STATE */
+	uint8_t HasParams;
+	struct NUR_CMD_INVENTORY_PARAMS Params;
+	struct NUR_CMD_INVENTORYEX_PARAMS *ExParams;	/* Set by NurApiStartInventoryEx() */
+	int Error;					/* First error of start / stop sent in the background */
+
+	uint32_t Notifications;		/* Inventory notifications received */
+	uint32_t Tags;				/* Tags passed to TagFunction and taken */
+	uint32_t TagsDropped;		/* Tags refused by TagFunction, or received while paused */
+	uint32_t Pauses;			/* Times the stream was paused for back-pressure */
+	uint32_t Restarts;			/* Times the stream was restarted after the module stopped it */
+
+	/* From the last notification */
+	uint16_t TagsFound;
+	uint8_t RoundsDone;
+	uint16_t Collisions;
+	uint8_t Q;
+
+	uint8_t Refused;			/* Internal: TagFunction refused a tag of the notification being parsed */
+};
+
+/** Number of latency histogram buckets in struct NUR_CMD_STATS. */
+#define NUR_STATS_HIST_BUCKETS	16
+/** Number of different commands with own statistics in struct NUR_LINK_STATS. */
+#define NUR_STATS_CMDS			16
+
+/** Per command statistics, see struct NUR_LINK_STATS. */
+struct NUR_CMD_STATS
+{
+	uint8_t Cmd;			/* Command, zero for unused entry */
+	uint32_t Count;			/* Responses received */
+	uint32_t Errors;		/* Responses with error status */
+	uint32_t Timeouts;		/* No response within timeout */
+	uint32_t TransportErrors;	/* Completed with transport error */
+	/* Round-trip time in milliseconds: bucket 0 is 0 ms, bucket n is 2^(n-1) .. 2^n-1 ms,
+	   last bucket is everything above. Without GetTickCountFunction, wait rounds are counted. */
+	uint32_t LatencyHist[NUR_STATS_HIST_BUCKETS];
+};
+
+/**
+ * Host side link statistics, see hNurApi->Stats and NurApiGetLinkStats().
+ * Byte counters can be reconciled with NUR_DIAG_REPORT from NurApiDiagGetReport():
+ * BytesOut is the module's bytesIn and BytesIn is the module's bytesOut, allowing for
+ * traffic before statistics were attached. Module's bytesIgnored counts the other direction (host to module).
+ */
+struct NUR_LINK_STATS
+{
+	uint32_t BytesIn;			/* Bytes received from module */
+	uint32_t BytesOut;			/* Bytes sent to module */
+	uint32_t BytesIgnored;		/* Received bytes that were not part of a valid packet */
+	uint32_t PacketsIn;			/* Valid packets received */
+	uint32_t PacketsOut;		/* Commands sent */
+	uint32_t HeaderErrors;		/* Start marker followed by invalid header */
+	uint32_t CrcErrors;			/* Valid header, invalid payload CRC */
+	uint32_t UnsolPackets;		/* Unsolicited packets received */
+	uint32_t UnexpectedPackets;	/* Responses nobody was waiting for */
+	uint32_t Timeouts;			/* Commands without response within timeout */
+	uint32_t TransportErrors;	/* Failed transport reads and writes */
+
+	struct NUR_CMD_STATS Cmds[NUR_STATS_CMDS];	/* First NUR_STATS_CMDS different commands, in order seen */
+	struct NUR_CMD_STATS Other;					/* Rest of the commands */
+};
+
 struct NUR_API_HANDLE
 {
 	void *UserData;
@@ -880,8 +1227,85 @@ struct NUR_API_HANDLE
 
 	uint32_t respLen;
 	struct NUR_CMD_RESP *resp;
+
+	/*
+		Packet parser state. Kept per handle so that several modules can be driven
+		concurrently, one thread per handle. Zero initialize the handle before first use.
+	*/
+	uint8_t RxPacketState;
+	/* Running CRC of received payload and RxBuffer position it has been calculated up to. */
+	uint16_t RxPayloadCRC;
+	uint32_t RxPayloadCRCPos;
+
+	/* Handle flags, see enum NUR_HANDLE_FLAGS. */
+	uint32_t Flags;
+
+	/*
+		Clock:
+		Optional monotonic millisecond clock. When set, all timeouts are real deadlines in milliseconds.
+		When not set, each transport read is counted as one millisecond.
+	*/
+	pGetTickCountFunction GetTickCountFunction;
+
+	/*
+		Set by the API before each transport read: milliseconds left until the current deadline.
+		Transport read may block up to this long waiting for data, and should return as soon as any data is available.
+	*/
+	uint32_t TransportReadTimeout;
+
+	/*
+		Optional scatter-gather write. When set, packets are written with this instead of TransportWriteDataFunction,
+		header, payload and CRC as separate segments. Both write functions may write less than requested and return
+		the count in bytesWritten; the API writes the rest.
+	*/
+	pTransportWriteVecFunction TransportWriteVecFunction;
+
+	/*
+		Optional queue for unsolicited packets. When set, unsolicited packets are copied to the queue
+		instead of calling UnsolEventHandler, so a slow handler does not delay the command in flight.
+	*/
+	struct NUR_UNSOL_QUEUE *UnsolQueue;
+
+	/*
+		Optional link statistics (CONFIG_LINK_STATS). Point to zero initialized struct to start counting.
+		Updated from the thread doing I/O on the handle.
+	*/
+	struct NUR_LINK_STATS *Stats;
+
+	/*
+		Optional exchange tracing (CONFIG_XCH_TRACE). Called when each command is written, when data is
+		received and when each command completes, from the thread doing I/O on the handle. Keep it short.
+	*/
+	pXchTraceFunction XchTraceFunction;
+
+	/*
+		Inventory stream in progress (CONFIG_INVENTORY_STREAM), set by NurApiStartInventoryStream().
+		Its notifications are handled by the API and not passed to UnsolEventHandler or UnsolQueue.
+	*/
+	struct NUR_INVENTORY_STREAM *InvStream;
+
+	/*
+		Range fetch state of NurApiFetchTagsChunked(). Managed by the API.
+		FetchRange caches whether the module answers range requests: zero (not probed yet) after zero
+		initialization, e.g. when connecting, and again after NUR_NOTIFY_BOOT.
+	*/
+	pFetchTagsFunction FetchTagFunction;
+	uint8_t FetchRefused;
+	uint8_t FetchRange;
+
+	/*
+		Exchange state, see NurApiXchStart(). Managed by the API.
+	*/
+	struct NUR_XCH_SLOT XchSlots[NUR_XCH_WINDOW];	/* Oldest first */
+	uint8_t XchPending;		/* Number of commands in flight */
+	uint8_t XchInPoll;
+	int XchRoundCount;
+	int XchError;
 };
 
+/** Pointer to command payload in TX buffer. Fill before NurApiXchPacket() or NurApiXchStart(). */
+#define NUR_TX_PAYLOAD(hApi)	((hApi)->TxBuffer + sizeof(struct NUR_HEADER) + 1)
+
 #ifdef HAVE_ERROR_MESSAGES
 NUR_API const char * NURAPICONV NurApiGetErrorMessage(int error);
 #endif
@@ -889,6 +1313,287 @@ NUR_API const char * NURAPICONV NurApiGetErrorMessage(int error);
 NUR_API int NURAPICONV NurApiSetupPacket(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, uint16_t flags, uint16_t *packetLen);
 NUR_API int NURAPICONV NurApiXchPacket(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, int timeout);
 
+/** @fn int NurApiXchStart(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, int timeout, pXchCompleteFunction completeFn)
+ *
+ * Send command to module without waiting for the response.
+ * Received data is then passed to NurApiXchFeed() or read with NurApiXchPoll();
+ * completeFn is called when the response arrives or the timeout expires.
+ * Up to NUR_XCH_WINDOW commands can be in flight per handle (pipelining). Responses are matched
+ * to commands in the order the commands were sent. All synchronous functions use this internally.
+ * TxBuffer can be reused as soon as this function returns.
+ *
+ * @param hNurApi		Handle to valid NurApi.
+ * @param cmd			Command. Payload must be in NUR_TX_PAYLOAD(hNurApi). Zero waits for any packet without sending.
+ * @param payloadLen	Payload length in bytes.
+ * @param timeout		Response timeout in milliseconds.
+ * @param completeFn	Completion callback, must not be NULL. Called with the response status, or error code.
+ *
+ * @return	Zero when command was sent. NUR_ERROR_NOT_READY if the window is full, NUR_ERROR_INVALID_PARAMETER if completeFn is NULL.
+ */
+NUR_API int NURAPICONV NurApiXchStart(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, int timeout, pXchCompleteFunction completeFn);
+
+/** @fn int NurApiXchStartVec(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, const struct NUR_IOVEC *extPayload, int extCnt, int timeout, pXchCompleteFunction completeFn)
+ *
+ * As NurApiXchStart(), but payload continues from caller's memory: first payloadLen bytes from
+ * NUR_TX_PAYLOAD(hNurApi), then extPayload segments. Segments are not copied to TxBuffer, so
+ * large payloads do not need to be staged there. Segment memory is not used after the function returns.
+ *
+ * @param hNurApi		Handle to valid NurApi.
+ * @param cmd			Command.
+ * @param payloadLen	Payload length in TxBuffer in bytes, may be zero.
+ * @param extPayload	Payload segments following payload in TxBuffer.
+ * @param extCnt		Number of segments, at most NUR_MAX_IOVEC-2.
+ * @param timeout		Response timeout in milliseconds.
+ * @param completeFn	Completion callback, must not be NULL.
+ *
+ * @return	Zero when command was sent.
+ */
+NUR_API int NURAPICONV NurApiXchStartVec(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, const struct NUR_IOVEC *extPayload, int extCnt, int timeout, pXchCompleteFunction completeFn);
+
+/** @fn int NurApiXchPacketVec(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, const struct NUR_IOVEC *extPayload, int extCnt, int timeout)
+ *
+ * Blocking version of NurApiXchStartVec(), see NurApiXchPacket().
+ */
+NUR_API int NURAPICONV NurApiXchPacketVec(struct NUR_API_HANDLE *hNurApi, uint8_t cmd, uint16_t payloadLen, const struct NUR_IOVEC *extPayload, int extCnt, int timeout);
+
+/** @fn int NurApiXchFeed(struct NUR_API_HANDLE *hNurApi, const uint8_t *data, uint32_t dataLen, uint32_t *bytesUsed)
+ *
+ * Pass received data to packet handler. Complete packets are dispatched to the pending exchange,
+ * UnsolEventHandler or UnexpectedCmdHandler. Can be called whether an exchange is pending or not.
+ *
+ * @param hNurApi		Handle to valid NurApi.
+ * @param data			Received data.
+ * @param dataLen		Number of bytes in data.
+ * @param bytesUsed		Optional, number of bytes handled.
+ *
+ * @return	Zero when succeeded.
+ */
+NUR_API int NURAPICONV NurApiXchFeed(struct NUR_API_HANDLE *hNurApi, const uint8_t *data, uint32_t dataLen, uint32_t *bytesUsed);
+
+/** @fn int NurApiXchPoll(struct NUR_API_HANDLE *hNurApi)
+ *
+ * Read available data from transport without blocking (TransportReadTimeout is 0),
+ * handle it and complete pending exchanges with NUR_ERROR_TR_TIMEOUT if their deadline has passed.
+ * Without NUR_HANDLE_FLAG_ZEROCOPY_RX data is received into TxBuffer; completion callbacks called
+ * from here cannot start new commands (NUR_ERROR_NOT_READY). Start them after this function returns.
+ *
+ * @param hNurApi		Handle to valid NurApi.
+ *
+ * @return	Zero when no exchange is pending, NUR_ERROR_NOT_READY while pending, or transport error.
+ */
+NUR_API int NURAPICONV NurApiXchPoll(struct NUR_API_HANDLE *hNurApi);
+
+/** @fn int NurApiXchTimeLeft(struct NUR_API_HANDLE *hNurApi)
+ *
+ * @param hNurApi		Handle to valid NurApi.
+ *
+ * @return	Milliseconds left of pending exchange timeout, 0 when expired, -1 if no exchange is pending.
+ */
+NUR_API int NURAPICONV NurApiXchTimeLeft(struct NUR_API_HANDLE *hNurApi);
+
+/** @fn int NurApiGetLinkStats(struct NUR_API_HANDLE *hNurApi, struct NUR_LINK_STATS *snapshot)
+ *
+ * Copy link statistics. Counters are not locked: a copy taken from another thread than the one doing I/O
+ * may mix counters from slightly different moments, but each counter is consistent on 32-bit or wider targets.
+ * Available with CONFIG_LINK_STATS (NurApiConfig.h).
+ *
+ * @param hNurApi		Handle to valid NurApi with Stats set.
+ * @param snapshot		Receives copy of hNurApi->Stats.
+ *
+ * @return	Zero when succeeded, NUR_ERROR_INVALID_PARAMETER if statistics are not attached.
+ */
+NUR_API int NURAPICONV NurApiGetLinkStats(struct NUR_API_HANDLE *hNurApi, struct NUR_LINK_STATS *snapshot);
+
+/** @fn void NurApiResetLinkStats(struct NUR_API_HANDLE *hNurApi)
+ *
+ * Zero all link statistics. Call from the thread doing I/O on the handle.
+ */
+NUR_API void NURAPICONV NurApiResetLinkStats(struct NUR_API_HANDLE *hNurApi);
+
+/** @fn int NurApiUnsolQueueInit(struct NUR_UNSOL_QUEUE *q, uint8_t *storage, uint32_t storageSize, uint16_t slotSize)
+ *
+ * Initialize unsolicited packet queue in application memory. Set hNurApi->UnsolQueue to use it.
+ * Available with CONFIG_UNSOL_QUEUE (NurApiConfig.h).
+ * Packets are taken out with NurApiUnsolQueuePeek() and NurApiUnsolQueuePop() from one consumer thread,
+ * while the API fills the queue from the thread that reads the transport.
+ * When the queue is full, new packets are dropped.
+ *
+ * @param q				Queue to initialize.
+ * @param storage		Slot memory. Uses the largest power of two number of slots that fits, at least two.
+ * @param storageSize	Size of storage in bytes.
+ * @param slotSize		Largest packet to store (cmd, status and data), e.g. NUR_MAX_RCV_SZ for any packet.
+ *						Each slot takes slotSize + 4 bytes, rounded up to multiple of four.
+ *
+ * @return	Zero when succeeded, NUR_ERROR_BUFFER_TOO_SMALL if less than two slots fit.
+ */
+NUR_API int NURAPICONV NurApiUnsolQueueInit(struct NUR_UNSOL_QUEUE *q, uint8_t *storage, uint32_t storageSize, uint16_t slotSize);
+
+/** @fn int NurApiUnsolQueuePeek(struct NUR_UNSOL_QUEUE *q, struct NUR_CMD_RESP **resp, uint32_t *respLen, uint16_t *flags)
+ *
+ * Get oldest packet in queue without removing it. Packet stays valid until NurApiUnsolQueuePop().
+ *
+ * @param q				Queue.
+ * @param resp			Receives packet; resp->cmd is the notification type, data is in resp union.
+ * @param respLen		Receives data length, without cmd and status (as hNurApi->respLen).
+ * @param flags			Optional, receives packet header flags, e.g. PACKET_FLAG_IRDATA.
+ *
+ * @return	Zero when packet was returned, NUR_ERROR_NO_PAYLOAD if queue is empty.
+ */
+NUR_API int NURAPICONV NurApiUnsolQueuePeek(struct NUR_UNSOL_QUEUE *q, struct NUR_CMD_RESP **resp, uint32_t *respLen, uint16_t *flags);
+
+/** @fn void NurApiUnsolQueuePop(struct NUR_UNSOL_QUEUE *q)
+ *
+ * Remove packet returned by NurApiUnsolQueuePeek().
+ */
+NUR_API void NURAPICONV NurApiUnsolQueuePop(struct NUR_UNSOL_QUEUE *q);
+
+/** @fn int NurApiTagTableInit(struct NUR_TAG_TABLE *t, struct NUR_TAG_ENTRY *slots, uint32_t slotCount)
+ *
+ * Initialize EPC deduplication table in application memory, e.g. a static array of slots.
+ * Largest power of two slots not above slotCount are used; up to 3/4 of them can hold tags.
+ * Available with CONFIG_TAG_TABLE (NurApiConfig.h).
+ *
+ * @param t			Table to initialize.
+ * @param slots		Slot storage, kept in use by the table.
+ * @param slotCount	Number of slots in storage, at least 4.
+ *
+ * @return	Zero when succeeded, error code otherwise.
+ */
+NUR_API int NURAPICONV NurApiTagTableInit(struct NUR_TAG_TABLE *t, struct NUR_TAG_ENTRY *slots, uint32_t slotCount);
+
+/** @fn void NurApiTagTableClear(struct NUR_TAG_TABLE *t)
+ *
+ * Remove all tags.
+ */
+NUR_API void NURAPICONV NurApiTagTableClear(struct NUR_TAG_TABLE *t);
+
+/** @fn int NurApiTagTableAdd(struct NUR_TAG_TABLE *t, struct NUR_IDBUFFER_ENTRY *tag, uint32_t now, struct NUR_TAG_ENTRY **entry)
+ *
+ * Add a read of tag, e.g. from pFetchTagsFunction or inventory stream TagFunction. EPC is copied, so tag may point into RxBuffer.
+ * New tags get FirstSeen = now; read count, RSSI and last antenna are updated for all.
+ *
+ * @param t			Table.
+ * @param tag		Tag read.
+ * @param now		Time of the read in any unit, e.g. milliseconds from GetTickCountFunction.
+ * @param entry		Table entry of the tag, may be NULL. ReadCount is 1 for a new tag.
+ *
+ * @return	Zero when succeeded, NUR_ERROR_BUFFER_TOO_SMALL when table is full, NUR_ERROR_INVALID_LENGTH when EPC is longer than NUR_TAGTABLE_MAX_EPC.
+ */
+NUR_API int NURAPICONV NurApiTagTableAdd(struct NUR_TAG_TABLE *t, struct NUR_IDBUFFER_ENTRY *tag, uint32_t now, struct NUR_TAG_ENTRY **entry);
+
+/** @fn struct NUR_TAG_ENTRY *NurApiTagTableFind(struct NUR_TAG_TABLE *t, const uint8_t *epc, uint8_t epcLen)
+ *
+ * Find tag by EPC.
+ *
+ * @return	Table entry, NULL if not found. Valid until the table is next changed.
+ */
+NUR_API struct NUR_TAG_ENTRY * NURAPICONV NurApiTagTableFind(struct NUR_TAG_TABLE *t, const uint8_t *epc, uint8_t epcLen);
+
+/** @fn int NurApiTagTableRemove(struct NUR_TAG_TABLE *t, struct NUR_TAG_ENTRY *entry)
+ *
+ * Remove tag from table. Other entries may move to fill its slot, so entry pointers taken before are not valid after.
+ * To remove while iterating over Slots, go from the first slot up and check the current slot again after a removal;
+ * entries that wrap around the end may then be seen twice.
+ *
+ * @return	Zero when succeeded, NUR_ERROR_INVALID_PARAMETER if entry is not in use in table.
+ */
+NUR_API int NURAPICONV NurApiTagTableRemove(struct NUR_TAG_TABLE *t, struct NUR_TAG_ENTRY *entry);
+
+/** @fn int NurApiTagArenaInit(struct NUR_TAG_ARENA *a, uint8_t *storage, uint32_t storageSize)
+ *
+ * Initialize tag record arena in application memory. Available with CONFIG_TAG_ARENA (NurApiConfig.h).
+ * In pFetchTagsFunction or stream TagFunction, call NurApiTagArenaAdd() for the tag; after the fetch, go through
+ * the records with NurApiTagArenaNext() and call NurApiTagArenaReset() before the next inventory cycle.
+ *
+ * @param a				Arena to initialize.
+ * @param storage		Record storage, 4 byte aligned; kept in use by the arena.
+ * @param storageSize	Size of storage in bytes. A 12 byte EPC takes 28 bytes.
+ *
+ * @return	Zero when succeeded, error code otherwise.
+ */
+NUR_API int NURAPICONV NurApiTagArenaInit(struct NUR_TAG_ARENA *a, uint8_t *storage, uint32_t storageSize);
+
+/** @fn void NurApiTagArenaReset(struct NUR_TAG_ARENA *a)
+ *
+ * Remove all records at once. High-water marks and Dropped are kept.
+ */
+NUR_API void NURAPICONV NurApiTagArenaReset(struct NUR_TAG_ARENA *a);
+
+/** @fn int NurApiTagArenaAdd(struct NUR_TAG_ARENA *a, struct NUR_IDBUFFER_ENTRY *tag, struct NUR_TAG_RECORD **record)
+ *
+ * Copy tag with its metadata, EPC and inventory read data to a new record.
+ *
+ * @param a			Arena.
+ * @param tag		Tag, e.g. as given to pFetchTagsFunction.
+ * @param record	New record, may be NULL.
+ *
+ * @return	Zero when succeeded, NUR_ERROR_BUFFER_TOO_SMALL when the arena is full.
+ */
+NUR_API int NURAPICONV NurApiTagArenaAdd(struct NUR_TAG_ARENA *a, struct NUR_IDBUFFER_ENTRY *tag, struct NUR_TAG_RECORD **record);
+
+/** @fn struct NUR_TAG_RECORD *NurApiTagArenaNext(struct NUR_TAG_ARENA *a, struct NUR_TAG_RECORD *record)
+ *
+ * Iterate records in the order they were added.
+ *
+ * @param a			Arena.
+ * @param record	Previous record, NULL for the first one.
+ *
+ * @return	Next record, NULL after the last one.
+ */
+NUR_API struct NUR_TAG_RECORD * NURAPICONV NurApiTagArenaNext(struct NUR_TAG_ARENA *a, struct NUR_TAG_RECORD *record);
+
+/** @fn int NurApiPresenceInit(struct NUR_PRESENCE *p, struct NUR_PRESENCE_TAG *tags, uint32_t tagCount, uint32_t *buckets, uint32_t bucketCount, uint32_t timeout, uint32_t now)
+ *
+ * Initialize tag presence tracker in application memory. Available with CONFIG_PRESENCE (NurApiConfig.h).
+ * Set EventFunction and Flags after this. After each inventory, pass the fetched tags to NurApiPresenceUpdate()
+ * (e.g. from pFetchTagsFunction) and then call NurApiPresenceAdvance() to report departures.
+ * Time can be in any unit that wraps at 2^32, e.g. milliseconds from GetTickCountFunction; with NUR_PRESENCE_MODULE_TIME milliseconds.
+ *
+ * @param p				Tracker to initialize.
+ * @param tags			Tag storage, kept in use by the tracker. Most tags present at once.
+ * @param tagCount		Number of tags in storage.
+ * @param buckets		Hash index storage, kept in use. Largest power of two not above bucketCount is used, e.g. tagCount.
+ * @param bucketCount	Number of buckets in storage, at least 1.
+ * @param timeout		Time without reads after which a tag departs.
+ * @param now			Current time.
+ *
+ * @return	Zero when succeeded, error code otherwise.
+ */
+NUR_API int NURAPICONV NurApiPresenceInit(struct NUR_PRESENCE *p, struct NUR_PRESENCE_TAG *tags, uint32_t tagCount, uint32_t *buckets, uint32_t bucketCount, uint32_t timeout, uint32_t now);
+
+/** @fn void NurApiPresenceClear(struct NUR_PRESENCE *p)
+ *
+ * Remove all tags without departure events.
+ */
+NUR_API void NURAPICONV NurApiPresenceClear(struct NUR_PRESENCE *p);
+
+/** @fn int NurApiPresenceUpdate(struct NUR_PRESENCE *p, struct NUR_IDBUFFER_ENTRY *tag, uint32_t now)
+ *
+ * Add a read of tag. A tag that was not present arrives; a present tag whose timeout passed before this read
+ * departs and arrives again, even if NurApiPresenceAdvance() has not reported it yet.
+ *
+ * @param p		Tracker.
+ * @param tag	Tag read, e.g. as given to pFetchTagsFunction.
+ * @param now	Read time; with NUR_PRESENCE_MODULE_TIME the time the inventory started, tag->timestamp is added.
+ *
+ * @return	Zero when succeeded, NUR_ERROR_BUFFER_TOO_SMALL when all tags are in use, NUR_ERROR_INVALID_LENGTH when EPC is longer than NUR_TAGTABLE_MAX_EPC.
+ */
+NUR_API int NURAPICONV NurApiPresenceUpdate(struct NUR_PRESENCE *p, struct NUR_IDBUFFER_ENTRY *tag, uint32_t now);
+
+/** @fn void NurApiPresenceAdvance(struct NUR_PRESENCE *p, uint32_t now)
+ *
+ * Report departures of tags not read since now - Timeout, up to Tick late. Checks only the wheel slots passed since the last call.
+ */
+NUR_API void NURAPICONV NurApiPresenceAdvance(struct NUR_PRESENCE *p, uint32_t now);
+
+/** @fn struct NUR_PRESENCE_TAG *NurApiPresenceFind(struct NUR_PRESENCE *p, const uint8_t *epc, uint8_t epcLen)
+ *
+ * Find present tag by EPC.
+ *
+ * @return	Tag, NULL if not present. Valid until it departs.
+ */
+NUR_API struct NUR_PRESENCE_TAG * NURAPICONV NurApiPresenceFind(struct NUR_PRESENCE *p, const uint8_t *epc, uint8_t epcLen);
+
 NUR_API int NURAPICONV NurApiPing(struct NUR_API_HANDLE *hNurApi);
 NUR_API int NURAPICONV NurApiWaitEvent(struct NUR_API_HANDLE *hNurApi, int timeout);
 NUR_API int NURAPICONV NurApiGetReaderInfo(struct NUR_API_HANDLE *hNurApi);
@@ -897,6 +1602,30 @@ NUR_API int NURAPICONV NurApiGetRegionInfo(struct NUR_API_HANDLE *hNurApi, uint8
 NUR_API int NURAPICONV NurApiStoreCurrentSetup(struct NUR_API_HANDLE *hNurApi, uint8_t flags);
 NUR_API int NURAPICONV NurApiSetBaudrate(struct NUR_API_HANDLE *hNurApi, uint8_t setting);
 NUR_API int NURAPICONV NurApiGetBaudrate(struct NUR_API_HANDLE *hNurApi);
+
+/** @fn uint32_t NurApiBaudrateToBps(uint8_t setting)
+ *
+ * Bits per second of baudrate setting (enum NUR_BAUDRATE), zero for unknown setting.
+ */
+NUR_API uint32_t NURAPICONV NurApiBaudrateToBps(uint8_t setting);
+
+/** @fn int NurApiNegotiateBaudrate(struct NUR_API_HANDLE *hNurApi, uint32_t maxBaudrate, int burst, pSetHostBaudrateFunction setHostFn, uint8_t *setting)
+ *
+ * Step module and host port up to the fastest baudrate that passes a test burst.
+ * Starting from the setting in use, each faster setting up to maxBaudrate is tried in turn: module is switched
+ * with NUR_CMD_SETBDR, host port with setHostFn, and 'burst' pings and full module setup reads must all succeed.
+ * On the first failure module and host are returned to the last good setting and faster settings are not tried.
+ * The setting is not stored in the module, use NurApiStoreCurrentSetup(NUR_STORE_BAUDRATE) to keep it over reset.
+ *
+ * @param hNurApi		Handle to valid NurApi, host port open at the module's current baudrate.
+ * @param maxBaudrate	Fastest baudrate in bps to try, e.g. what the host UART supports.
+ * @param burst			Number of ping and setup read pairs that must pass, e.g. 20.
+ * @param setHostFn		Sets host port to given baudrate.
+ * @param setting		Receives the setting in use, enum NUR_BAUDRATE. Can be NULL.
+ *
+ * @return	Zero when module and host are at the same, verified setting; otherwise the link may be lost.
+ */
+NUR_API int NURAPICONV NurApiNegotiateBaudrate(struct NUR_API_HANDLE *hNurApi, uint32_t maxBaudrate, int burst, pSetHostBaudrateFunction setHostFn, uint8_t *setting);
 NUR_API int NURAPICONV NurApiGetFWINFO(struct NUR_API_HANDLE *hNurApi, char *buf, uint16_t buflen);
 NUR_API int NURAPICONV NurApiSetModuleSetup(struct NUR_API_HANDLE *hNurApi, struct NUR_CMD_LOADSETUP_PARAMS *params);
 NUR_API int NURAPICONV NurApiGetModuleSetup(struct NUR_API_HANDLE *hNurApi, uint32_t setupFlags);
@@ -926,11 +1655,114 @@ NUR_API int NURAPICONV NurApiSetInventoryReadConfig(struct NUR_API_HANDLE *hNurA
 
 NUR_API int NURAPICONV NurApiFetchTags(struct NUR_API_HANDLE *hNurApi, int32_t includeMeta, int32_t clearModuleTags, int *tagsReceived, pFetchTagsFunction tagFunc);
 NUR_API int NURAPICONV NurApiFetchTagAt(struct NUR_API_HANDLE *hNurApi, int32_t includeMeta, int tagNum, pFetchTagsFunction tagFunc);
+
+/** @fn int NurApiFetchTagsChunked(struct NUR_API_HANDLE *hNurApi, int32_t includeMeta, int tagCount, int maxEpcLen, int maxDataLen, int *tagsReceived, pFetchTagsFunction tagFunc)
+ *
+ * Fetch tags from the module tag buffer in ranges that fit in RxBuffer, instead of all at once (NurApiFetchTags())
+ * or one per request (NurApiFetchTagAt()). The range size is calculated from RxBufferLen and the tag block size
+ * with maxEpcLen bytes of EPC and maxDataLen bytes of inventory read data; tags are passed to tagFunc straight from each response.
+ * Module support for ranges is probed once per connection by asking for the first two tags, with a short timeout;
+ * their tags are passed on as with any range. On any error or an unexpected answer tags are read one per request.
+ * The result is kept in hNurApi->FetchRange. Module tag buffer is not cleared.
+ *
+ * @param hNurApi		Handle to valid NurApi.
+ * @param includeMeta	Non-zero to fetch with metadata (NUR_CMD_GETMETABUF).
+ * @param tagCount		Tags in module tag buffer, e.g. numTagsMem of the inventory response.
+ * @param maxEpcLen		Longest EPC expected in bytes, 0 for NUR_MAX_EPC_LENGTH_EX. A response with longer EPCs may not fit in RxBuffer.
+ * @param maxDataLen	Inventory read data per tag in bytes (wLength * 2, see NurApiSetInventoryReadConfig()), 0 when inventory read is off.
+ * @param tagsReceived	Number of tags passed to tagFunc, may be NULL.
+ * @param tagFunc		Called for each tag; returning non-zero stops the fetch.
+ *
+ * @return	Zero when succeeded, error code otherwise.
+ */
+NUR_API int NURAPICONV NurApiFetchTagsChunked(struct NUR_API_HANDLE *hNurApi, int32_t includeMeta, int tagCount, int maxEpcLen, int maxDataLen, int *tagsReceived, pFetchTagsFunction tagFunc);
+/** @fn int NurApiParseIdBufferBatch(struct NUR_TAG_BATCH *batch, const uint8_t *buffer, uint32_t bufferLen, int32_t includeMeta, int32_t includeIrData)
+ *
+ * Decode tags of a NUR_CMD_GETMETABUF / NUR_CMD_GETIDBUF response into columns of batch, without a call per tag.
+ * Same input as pFetchTagsFunction parsing; metadata columns are left untouched without includeMeta.
+ * Decoding stops at a tag block that does not fit in bufferLen or whose lengths do not add up.
+ * Not faster than parsing with a pFetchTagsFunction; columns are for applications that go over the tags
+ * in several passes (filters, aggregation) or want them as arrays.
+ * Available with CONFIG_TAG_BATCH (NurApiConfig.h).
+ *
+ * @param batch			Batch with columns set; Count and Buffer are set.
+ * @param buffer		Tag blocks, e.g. hNurApi->resp->rawdata.
+ * @param bufferLen		Bytes in buffer.
+ * @param includeMeta	Non-zero for NUR_CMD_GETMETABUF.
+ * @param includeIrData	Non-zero when the response has PACKET_FLAG_IRDATA set.
+ *
+ * @return	Number of tags decoded; at most Capacity, rest are left out.
+ */
+NUR_API int NURAPICONV NurApiParseIdBufferBatch(struct NUR_TAG_BATCH *batch, const uint8_t *buffer, uint32_t bufferLen, int32_t includeMeta, int32_t includeIrData);
+
+/** @fn int NurApiFetchTagsBatch(struct NUR_API_HANDLE *hNurApi, int32_t includeMeta, int32_t clearModuleTags, struct NUR_TAG_BATCH *batch)
+ *
+ * As NurApiFetchTags(), but tags are decoded into batch with NurApiParseIdBufferBatch().
+ * EPCs stay in RxBuffer and are valid until the next command.
+ *
+ * @return	Zero when succeeded, error code otherwise.
+ */
+NUR_API int NURAPICONV NurApiFetchTagsBatch(struct NUR_API_HANDLE *hNurApi, int32_t includeMeta, int32_t clearModuleTags, struct NUR_TAG_BATCH *batch);
+
 NUR_API int NURAPICONV NurApiParseTagXPC(struct NUR_IDBUFFER_ENTRY* entry, uint16_t* xpc_w1, uint16_t* xpc_w2);
 
 NUR_API int NURAPICONV NurApiClearTags(struct NUR_API_HANDLE *hNurApi);
+
+/** @fn int NurApiStopContinuous(struct NUR_API_HANDLE *hNurApi)
+ *
+ * Stop all continuous operations (NUR_CMD_STOPALLCONT).
+ * With an inventory stream running, tags of notifications received before the module acknowledges
+ * the stop are still passed to TagFunction, and hNurApi->InvStream is cleared.
+ */
 NUR_API int NURAPICONV NurApiStopContinuous(struct NUR_API_HANDLE *hNurApi);
 
+/** @fn int NurApiStartInventoryStream(struct NUR_API_HANDLE *hNurApi, struct NUR_INVENTORY_STREAM *stream, struct NUR_CMD_INVENTORY_PARAMS *params)
+ *
+ * Start continuous inventory (NUR_CMD_INVENTORYSTREAM). The module sends NUR_NOTIFY_INVENTORY notifications with the
+ * tags found, without request / response turnarounds. Call NurApiInventoryStreamPoll() to receive them and
+ * NurApiStopContinuous() to stop. The module stops the stream by itself after a while; it is then restarted
+ * on the next poll. Available with CONFIG_INVENTORY_STREAM (NurApiConfig.h).
+ *
+ * @param hNurApi	Handle to valid NurApi.
+ * @param stream	Stream state with TagFunction set, kept in use until stopped.
+ * @param params	Q, session and rounds, NULL for module setup.
+ *
+ * @return	Zero when succeeded, error code otherwise.
+ */
+NUR_API int NURAPICONV NurApiStartInventoryStream(struct NUR_API_HANDLE *hNurApi, struct NUR_INVENTORY_STREAM *stream, struct NUR_CMD_INVENTORY_PARAMS *params);
+
+/** @fn int NurApiStartInventoryEx(struct NUR_API_HANDLE *hNurApi, struct NUR_INVENTORY_STREAM *stream, struct NUR_CMD_INVENTORYEX_PARAMS *params)
+ *
+ * Start continuous extended inventory (NUR_CMD_INVENTORYEX with NUR_INVEX_FLAGS_STREAM) with select filters.
+ * Tags come in NUR_NOTIFY_INVENTORYEX notifications and are handled as with NurApiStartInventoryStream():
+ * poll with NurApiInventoryStreamPoll(), stop with NurApiStopContinuous(). Available with CONFIG_INVENTORY_STREAM (NurApiConfig.h).
+ *
+ * @param hNurApi	Handle to valid NurApi.
+ * @param stream	Stream state with TagFunction set, kept in use until stopped.
+ * @param params	Inventory parameters and filters, kept in use until stopped; sent again on each restart.
+ *
+ * @return	Zero when succeeded, error code otherwise.
+ */
+NUR_API int NURAPICONV NurApiStartInventoryEx(struct NUR_API_HANDLE *hNurApi, struct NUR_INVENTORY_STREAM *stream, struct NUR_CMD_INVENTORYEX_PARAMS *params);
+
+/** @fn int NurApiInventoryStreamPoll(struct NUR_API_HANDLE *hNurApi, int timeout)
+ *
+ * Receive and handle inventory stream notifications, waiting up to timeout milliseconds for data.
+ * Restarts the stream when the module has stopped it, and stops it when TagFunction applies back-pressure.
+ * Call in a loop while the stream runs; other synchronous commands cannot be used until it is stopped.
+ *
+ * @return	Zero, an error of a restart or stop sent in the background, or a transport error.
+ */
+NUR_API int NURAPICONV NurApiInventoryStreamPoll(struct NUR_API_HANDLE *hNurApi, int timeout);
+
+/** @fn int NurApiInventoryStreamResume(struct NUR_API_HANDLE *hNurApi)
+ *
+ * Continue a stream paused by back-pressure, once the application can take tags again. Restarted on the next poll.
+ *
+ * @return	Zero, or NUR_ERROR_NOT_READY when the pause is still in progress; try again after polling.
+ */
+NUR_API int NURAPICONV NurApiInventoryStreamResume(struct NUR_API_HANDLE *hNurApi);
+
 /** @fn int NurApiSetCustomHoptableEx(struct NUR_API_HANDLE *hNurApi, struct NUR_CUSTOMHOP_PARAMS_EX *params)
  *
  * Set pre-built custom hop table.